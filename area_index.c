@@ -0,0 +1,570 @@
+
+/*********************************************************************************************
+
+    This is public domain software that was developed by or for the U.S. Naval Oceanographic
+    Office and/or the U.S. Army Corps of Engineers.
+
+    This is a work of the U.S. Government. In accordance with 17 USC 105, copyright protection
+    is not available for any work of the U.S. Government.
+
+    Neither the United States Government, nor any employees of the United States Government,
+    nor the author, makes any warranty, express or implied, without even the implied warranty
+    of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE, or assumes any liability or
+    responsibility for the accuracy, completeness, or usefulness of any information,
+    apparatus, product, or process disclosed, or represents that its use would not infringe
+    privately-owned rights. Reference herein to any specific commercial products, process,
+    or service by trade name, trademark, manufacturer, or otherwise, does not necessarily
+    constitute or imply its endorsement, recommendation, or favoring by the United States
+    Government. The views and opinions of authors expressed herein do not necessarily state
+    or reflect those of the United States Government, and shall not be used for advertising
+    or product endorsement purposes.
+*********************************************************************************************/
+
+
+/****************************************  IMPORTANT NOTE  **********************************
+
+    Comments in this file that start with / * ! are being used by Doxygen to document the
+    software.  Dashes in these comment blocks are used to create bullet lists.  The lack of
+    blank lines after a block of dash preceeded comments means that the next block of dash
+    preceeded comments is a new, indented bullet list.  I've tried to keep the Doxygen
+    formatting to a minimum but there are some other items (like <br> and <pre>) that need
+    to be left alone.  If you see a comment that starts with / * ! and there is something
+    that looks a bit weird it is probably due to some arcane Doxygen syntax.  Be very
+    careful modifying blocks of Doxygen comments.
+
+*****************************************  IMPORTANT NOTE  **********************************/
+
+
+
+#include <string.h>
+#include <math.h>
+
+#include "nvdef.h"
+#include "parallel_for.h"
+#include "polygon_intersection.h"
+#include "area_index.h"
+
+
+/*  Deepest tree we can walk with the fixed size query stack.  With 16 children per node this is far more than
+    we'll ever see.  */
+
+#define AREA_INDEX_STACK        (AREA_INDEX_NODE_SIZE * 32)
+
+
+typedef struct
+{
+  double           **poly_x;
+  double           **poly_y;
+  int32_t          *npol;
+  AREA_INDEX_ENTRY *entry;
+  int32_t          failed;
+} AREA_INDEX_BUILD;
+
+
+typedef struct
+{
+  AREA_INDEX       *ai;
+  const double     *x;
+  const double     *y;
+  int32_t          *start;
+  int32_t          *ids;
+} AREA_INDEX_BATCH;
+
+
+
+static uint8_t area_index_overlap (NV_F64_XYMBR *a, NV_F64_XYMBR *b)
+{
+  if (a->max_x < b->min_x || b->max_x < a->min_x || a->max_y < b->min_y || b->max_y < a->min_y) return (NVFalse);
+
+  return (NVTrue);
+}
+
+
+
+static uint8_t area_index_contains (NV_F64_XYMBR *a, double x, double y)
+{
+  if (x < a->min_x || x > a->max_x || y < a->min_y || y > a->max_y) return (NVFalse);
+
+  return (NVTrue);
+}
+
+
+
+/*  Sort-Tile-Recursive packing.  Sort on MBR center X, cut into vertical slices of about sqrt (number of parent
+    nodes) parents each, then sort each slice on center Y so that each run of AREA_INDEX_NODE_SIZE items is
+    spatially compact.  */
+
+static int32_t area_index_compare_x (const void *a, const void *b)
+{
+  const NV_F64_XYMBR *ma = (const NV_F64_XYMBR *) a, *mb = (const NV_F64_XYMBR *) b;
+  double             ca = ma->min_x + ma->max_x, cb = mb->min_x + mb->max_x;
+
+  if (ca < cb) return (-1);
+  if (ca > cb) return (1);
+  return (0);
+}
+
+
+
+static int32_t area_index_compare_y (const void *a, const void *b)
+{
+  const NV_F64_XYMBR *ma = (const NV_F64_XYMBR *) a, *mb = (const NV_F64_XYMBR *) b;
+  double             ca = ma->min_y + ma->max_y, cb = mb->min_y + mb->max_y;
+
+  if (ca < cb) return (-1);
+  if (ca > cb) return (1);
+  return (0);
+}
+
+
+
+static void area_index_str_sort (void *items, int32_t count, size_t size)
+{
+  int32_t          parents, slices, slice_size, i;
+
+
+  parents = (count + AREA_INDEX_NODE_SIZE - 1) / AREA_INDEX_NODE_SIZE;
+  slices = (int32_t) ceil (sqrt ((double) parents));
+  slice_size = slices * AREA_INDEX_NODE_SIZE;
+
+
+  /*  Both AREA_INDEX_ENTRY and AREA_INDEX_NODE start with their MBR so the comparisons work on either.  */
+
+  qsort (items, count, size, area_index_compare_x);
+
+  for (i = 0 ; i < count ; i += slice_size)
+    {
+      qsort ((char *) items + (size_t) i * size, MIN (slice_size, count - i), size, area_index_compare_y);
+    }
+}
+
+
+
+static void area_index_prepare_chunk (int64_t start, int64_t end, void *arg)
+{
+  AREA_INDEX_BUILD *build = (AREA_INDEX_BUILD *) arg;
+  int64_t          i;
+
+
+  for (i = start ; i < end ; i++)
+    {
+      build->entry[i].pp = NULL;
+
+      if (build->npol[i] < 1) continue;
+
+      build->entry[i].pp = prepare_polygon2 (build->poly_x[i], build->poly_y[i], build->npol[i]);
+
+      if (build->entry[i].pp == NULL)
+        {
+          build->failed = 1;
+        }
+      else
+        {
+          build->entry[i].mbr = build->entry[i].pp->mbr;
+        }
+    }
+}
+
+
+
+/***************************************************************************/
+/*!
+
+  - Module Name:        create_area_index
+
+  - Date Written:       October 2026
+
+  - Purpose:            Builds a spatial index over a set of polygons (for
+                        example, areas read with get_area_mbr) so that we
+                        can quickly find every polygon that contains a
+                        point or touches an MBR.  The polygon MBRs are bulk
+                        loaded into an R-tree using Sort-Tile-Recursive
+                        packing and each polygon is prepared (see
+                        prepare_polygon2) so that the final point in
+                        polygon tests are mostly table lookups.  The
+                        polygons are copied so the input arrays can be
+                        freed after this returns.
+
+  - Arguments:
+                        - poly_x   =   Array of pointers to the X coordinates of
+                                       the polygons
+                        - poly_y   =   Array of pointers to the Y coordinates of
+                                       the polygons
+                        - npol     =   Number of vertices in each polygon
+                        - count    =   Number of polygons
+
+  - Return Value:       Pointer to the AREA_INDEX or NULL on memory
+                        allocation failure.  Free it with free_area_index.
+                        Polygon IDs returned by the queries are the
+                        positions of the polygons in the input arrays.
+                        Polygons with fewer than one vertex never match.
+
+****************************************************************************/
+
+AREA_INDEX *create_area_index (double **poly_x, double **poly_y, int32_t *npol, int32_t count)
+{
+  AREA_INDEX       *ai;
+  AREA_INDEX_BUILD build;
+  AREA_INDEX_NODE  *level;
+  int32_t          i, j, k, n, level_start, level_count, max_nodes;
+
+
+  ai = (AREA_INDEX *) calloc (1, sizeof (AREA_INDEX));
+  if (ai == NULL)
+    {
+      perror ("Allocating AREA_INDEX in create_area_index");
+      return (NULL);
+    }
+
+  ai->count = MAX (count, 0);
+  if (!ai->count) return (ai);
+
+
+  /*  Every level has at most 1/16 of the nodes of the level below so this is plenty.  */
+
+  max_nodes = ai->count / (AREA_INDEX_NODE_SIZE - 1) + 32;
+
+  ai->entry = (AREA_INDEX_ENTRY *) calloc (ai->count, sizeof (AREA_INDEX_ENTRY));
+  ai->node = (AREA_INDEX_NODE *) calloc (max_nodes, sizeof (AREA_INDEX_NODE));
+  if (ai->entry == NULL || ai->node == NULL)
+    {
+      perror ("Allocating index memory in create_area_index");
+      free_area_index (ai);
+      return (NULL);
+    }
+
+  for (i = 0 ; i < ai->count ; i++)
+    {
+      ai->entry[i].id = i;
+
+
+      /*  Empty polygons get an inverted MBR so that they never match.  */
+
+      ai->entry[i].mbr.min_x = ai->entry[i].mbr.min_y = 1.0;
+      ai->entry[i].mbr.max_x = ai->entry[i].mbr.max_y = -1.0;
+    }
+
+  build.poly_x = poly_x;
+  build.poly_y = poly_y;
+  build.npol = npol;
+  build.entry = ai->entry;
+  build.failed = 0;
+
+  parallel_for (ai->count, 16, area_index_prepare_chunk, &build);
+
+  if (build.failed)
+    {
+      free_area_index (ai);
+      return (NULL);
+    }
+
+
+  /*  Pack the leaves.  */
+
+  area_index_str_sort (ai->entry, ai->count, sizeof (AREA_INDEX_ENTRY));
+
+  for (i = 0 ; i < ai->count ; i += AREA_INDEX_NODE_SIZE)
+    {
+      n = ai->num_nodes++;
+      ai->node[n].first = i;
+      ai->node[n].count = MIN (AREA_INDEX_NODE_SIZE, ai->count - i);
+      ai->node[n].leaf = NVTrue;
+      ai->node[n].mbr = ai->entry[i].mbr;
+
+      for (k = 1 ; k < ai->node[n].count ; k++)
+        {
+          ai->node[n].mbr.min_x = MIN (ai->node[n].mbr.min_x, ai->entry[i + k].mbr.min_x);
+          ai->node[n].mbr.max_x = MAX (ai->node[n].mbr.max_x, ai->entry[i + k].mbr.max_x);
+          ai->node[n].mbr.min_y = MIN (ai->node[n].mbr.min_y, ai->entry[i + k].mbr.min_y);
+          ai->node[n].mbr.max_y = MAX (ai->node[n].mbr.max_y, ai->entry[i + k].mbr.max_y);
+        }
+    }
+
+  ai->depth = 1;
+
+
+  /*  Pack each level of nodes into parents until there's only one node left (the root).  */
+
+  level_start = 0;
+  level_count = ai->num_nodes;
+
+  while (level_count > 1)
+    {
+      level = &ai->node[level_start];
+
+      area_index_str_sort (level, level_count, sizeof (AREA_INDEX_NODE));
+
+      for (i = 0 ; i < level_count ; i += AREA_INDEX_NODE_SIZE)
+        {
+          n = ai->num_nodes++;
+          ai->node[n].first = level_start + i;
+          ai->node[n].count = MIN (AREA_INDEX_NODE_SIZE, level_count - i);
+          ai->node[n].leaf = NVFalse;
+          ai->node[n].mbr = level[i].mbr;
+
+          for (k = 1 ; k < ai->node[n].count ; k++)
+            {
+              j = i + k;
+              ai->node[n].mbr.min_x = MIN (ai->node[n].mbr.min_x, level[j].mbr.min_x);
+              ai->node[n].mbr.max_x = MAX (ai->node[n].mbr.max_x, level[j].mbr.max_x);
+              ai->node[n].mbr.min_y = MIN (ai->node[n].mbr.min_y, level[j].mbr.min_y);
+              ai->node[n].mbr.max_y = MAX (ai->node[n].mbr.max_y, level[j].mbr.max_y);
+            }
+        }
+
+      level_start += level_count;
+      level_count = ai->num_nodes - level_start;
+      ai->depth++;
+    }
+
+  return (ai);
+}
+
+
+
+/*  Walks the tree looking for every polygon that contains the point.  If ids is NULL we just count.  */
+
+static int32_t area_index_point_query (AREA_INDEX *ai, double x, double y, int32_t *ids, int32_t max_ids)
+{
+  AREA_INDEX_NODE  *node;
+  AREA_INDEX_ENTRY *entry;
+  int32_t          stack[AREA_INDEX_STACK], sp = 0, found = 0, i;
+
+
+  if (!ai->num_nodes) return (0);
+
+  stack[sp++] = ai->num_nodes - 1;
+
+  while (sp)
+    {
+      node = &ai->node[stack[--sp]];
+
+      if (!area_index_contains (&node->mbr, x, y)) continue;
+
+      for (i = node->first ; i < node->first + node->count ; i++)
+        {
+          if (node->leaf)
+            {
+              entry = &ai->entry[i];
+
+              if (area_index_contains (&entry->mbr, x, y) && inside_prepared_polygon (entry->pp, x, y))
+                {
+                  if (ids != NULL && found < max_ids) ids[found] = entry->id;
+                  found++;
+                }
+            }
+          else
+            {
+              if (area_index_contains (&ai->node[i].mbr, x, y)) stack[sp++] = i;
+            }
+        }
+    }
+
+  return (found);
+}
+
+
+
+/***************************************************************************/
+/*!
+
+  - Module Name:        area_index_point
+
+  - Date Written:       October 2026
+
+  - Purpose:            Finds every polygon in the index that contains the
+                        point (using the inside_polygon2 rules).
+
+  - Arguments:
+                        - ai       =   AREA_INDEX from create_area_index
+                        - x        =   X value of the point
+                        - y        =   Y value of the point
+                        - ids      =   Returned polygon IDs (in no particular
+                                       order)
+                        - max_ids  =   Size of the ids array
+
+  - Return Value:       Number of polygons containing the point.  If this
+                        is larger than max_ids only the first max_ids were
+                        stored.
+
+****************************************************************************/
+
+int32_t area_index_point (AREA_INDEX *ai, double x, double y, int32_t *ids, int32_t max_ids)
+{
+  return (area_index_point_query (ai, x, y, ids, max_ids));
+}
+
+
+
+static void area_index_count_chunk (int64_t start, int64_t end, void *arg)
+{
+  AREA_INDEX_BATCH *batch = (AREA_INDEX_BATCH *) arg;
+  int64_t          i;
+
+
+  for (i = start ; i < end ; i++) batch->start[i + 1] = area_index_point_query (batch->ai, batch->x[i], batch->y[i], NULL, 0);
+}
+
+
+
+static void area_index_fill_chunk (int64_t start, int64_t end, void *arg)
+{
+  AREA_INDEX_BATCH *batch = (AREA_INDEX_BATCH *) arg;
+  int64_t          i;
+
+
+  for (i = start ; i < end ; i++)
+    {
+      area_index_point_query (batch->ai, batch->x[i], batch->y[i], &batch->ids[batch->start[i]],
+                              batch->start[i + 1] - batch->start[i]);
+    }
+}
+
+
+
+/***************************************************************************/
+/*!
+
+  - Module Name:        area_index_point_batch
+
+  - Date Written:       October 2026
+
+  - Purpose:            Runs area_index_point for an array of points, split
+                        across threads (see parallel_for).  The matches for
+                        point i are (*ids)[start[i]] through
+                        (*ids)[start[i + 1] - 1].
+
+  - Arguments:
+                        - ai       =   AREA_INDEX from create_area_index
+                        - x        =   X values of the points
+                        - y        =   Y values of the points
+                        - n        =   Number of points
+                        - start    =   n + 1 element array that will hold the
+                                       offset of each point's matches in ids
+                        - ids      =   Returned, allocated array of matching
+                                       polygon IDs.  The caller must free it.
+
+  - Return Value:       Total number of matches or -1 on memory allocation
+                        failure
+
+****************************************************************************/
+
+int32_t area_index_point_batch (AREA_INDEX *ai, const double *x, const double *y, int32_t n, int32_t *start, int32_t **ids)
+{
+  AREA_INDEX_BATCH batch;
+  int32_t          i;
+
+
+  *ids = NULL;
+  start[0] = 0;
+  if (n <= 0) return (0);
+
+  batch.ai = ai;
+  batch.x = x;
+  batch.y = y;
+  batch.start = start;
+
+
+  /*  Count the matches for each point first so we know where everything goes, then fill them in.  */
+
+  parallel_for (n, 4096, area_index_count_chunk, &batch);
+
+  for (i = 0 ; i < n ; i++) start[i + 1] += start[i];
+
+  batch.ids = (int32_t *) malloc (MAX (start[n], 1) * sizeof (int32_t));
+  if (batch.ids == NULL)
+    {
+      perror ("Allocating ids in area_index_point_batch");
+      return (-1);
+    }
+
+  parallel_for (n, 4096, area_index_fill_chunk, &batch);
+
+  *ids = batch.ids;
+
+  return (start[n]);
+}
+
+
+
+/***************************************************************************/
+/*!
+
+  - Module Name:        area_index_mbr
+
+  - Date Written:       October 2026
+
+  - Purpose:            Finds every polygon in the index that touches the
+                        MBR (the same test as polygon_intersection4).
+
+  - Arguments:
+                        - ai       =   AREA_INDEX from create_area_index
+                        - mbr      =   MBR to check
+                        - ids      =   Returned polygon IDs (in no particular
+                                       order)
+                        - max_ids  =   Size of the ids array
+
+  - Return Value:       Number of polygons touching the MBR.  If this is
+                        larger than max_ids only the first max_ids were
+                        stored.
+
+****************************************************************************/
+
+int32_t area_index_mbr (AREA_INDEX *ai, NV_F64_XYMBR mbr, int32_t *ids, int32_t max_ids)
+{
+  AREA_INDEX_NODE  *node;
+  AREA_INDEX_ENTRY *entry;
+  int32_t          stack[AREA_INDEX_STACK], sp = 0, found = 0, i;
+
+
+  if (!ai->num_nodes) return (0);
+
+  stack[sp++] = ai->num_nodes - 1;
+
+  while (sp)
+    {
+      node = &ai->node[stack[--sp]];
+
+      if (!area_index_overlap (&node->mbr, &mbr)) continue;
+
+      for (i = node->first ; i < node->first + node->count ; i++)
+        {
+          if (node->leaf)
+            {
+              entry = &ai->entry[i];
+
+              if (entry->pp != NULL && area_index_overlap (&entry->mbr, &mbr) &&
+                  polygon_intersection4 (mbr, entry->pp->x, entry->pp->y, entry->pp->npol))
+                {
+                  if (found < max_ids) ids[found] = entry->id;
+                  found++;
+                }
+            }
+          else
+            {
+              if (area_index_overlap (&ai->node[i].mbr, &mbr)) stack[sp++] = i;
+            }
+        }
+    }
+
+  return (found);
+}
+
+
+
+void free_area_index (AREA_INDEX *ai)
+{
+  int32_t          i;
+
+
+  if (ai == NULL) return;
+
+  if (ai->entry != NULL)
+    {
+      for (i = 0 ; i < ai->count ; i++) free_prepared_polygon (ai->entry[i].pp);
+      free (ai->entry);
+    }
+
+  free (ai->node);
+  free (ai);
+}
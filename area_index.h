@@ -0,0 +1,100 @@
+
+/*********************************************************************************************
+
+    This is public domain software that was developed by or for the U.S. Naval Oceanographic
+    Office and/or the U.S. Army Corps of Engineers.
+
+    This is a work of the U.S. Government. In accordance with 17 USC 105, copyright protection
+    is not available for any work of the U.S. Government.
+
+    Neither the United States Government, nor any employees of the United States Government,
+    nor the author, makes any warranty, express or implied, without even the implied warranty
+    of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE, or assumes any liability or
+    responsibility for the accuracy, completeness, or usefulness of any information,
+    apparatus, product, or process disclosed, or represents that its use would not infringe
+    privately-owned rights. Reference herein to any specific commercial products, process,
+    or service by trade name, trademark, manufacturer, or otherwise, does not necessarily
+    constitute or imply its endorsement, recommendation, or favoring by the United States
+    Government. The views and opinions of authors expressed herein do not necessarily state
+    or reflect those of the United States Government, and shall not be used for advertising
+    or product endorsement purposes.
+*********************************************************************************************/
+
+
+/****************************************  IMPORTANT NOTE  **********************************
+
+    Comments in this file that start with / * ! are being used by Doxygen to document the
+    software.  Dashes in these comment blocks are used to create bullet lists.  The lack of
+    blank lines after a block of dash preceeded comments means that the next block of dash
+    preceeded comments is a new, indented bullet list.  I've tried to keep the Doxygen
+    formatting to a minimum but there are some other items (like <br> and <pre>) that need
+    to be left alone.  If you see a comment that starts with / * ! and there is something
+    that looks a bit weird it is probably due to some arcane Doxygen syntax.  Be very
+    careful modifying blocks of Doxygen comments.
+
+*****************************************  IMPORTANT NOTE  **********************************/
+
+
+
+#ifndef _AREA_INDEX_H_
+#define _AREA_INDEX_H_
+
+#ifdef  __cplusplus
+extern "C" {
+#endif
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "pfm_nvtypes.h"
+#include "inside_polygon.h"
+
+
+#define AREA_INDEX_NODE_SIZE    16             /*!<  Maximum number of children of an R-tree node  */
+
+
+  /*!  R-tree node.  Leaf nodes point into AREA_INDEX.entry, other nodes point into AREA_INDEX.node.  */
+
+  typedef struct
+  {
+    NV_F64_XYMBR  mbr;          /*!<  MBR of all of the node's children  */
+    int32_t       first;        /*!<  Index of the first child  */
+    int32_t       count;        /*!<  Number of children  */
+    uint8_t       leaf;         /*!<  NVTrue if the children are polygon entries  */
+  } AREA_INDEX_NODE;
+
+
+  /*!  Polygon stored in the index.  */
+
+  typedef struct
+  {
+    NV_F64_XYMBR     mbr;       /*!<  Polygon MBR  */
+    int32_t          id;        /*!<  Polygon ID (position in the arrays passed to create_area_index)  */
+    PREPARED_POLYGON *pp;       /*!<  Prepared polygon (holds a copy of the vertices)  */
+  } AREA_INDEX_ENTRY;
+
+
+  /*!  Spatial index over a set of polygons.  See create_area_index in area_index.c.  */
+
+  typedef struct
+  {
+    int32_t          count;     /*!<  Number of polygons  */
+    AREA_INDEX_ENTRY *entry;    /*!<  Polygons in R-tree leaf order  */
+    int32_t          num_nodes; /*!<  Number of R-tree nodes  */
+    AREA_INDEX_NODE  *node;     /*!<  R-tree nodes (the root is the last one)  */
+    int32_t          depth;     /*!<  Number of levels in the tree  */
+  } AREA_INDEX;
+
+
+  AREA_INDEX *create_area_index (double **poly_x, double **poly_y, int32_t *npol, int32_t count);
+  int32_t area_index_point (AREA_INDEX *ai, double x, double y, int32_t *ids, int32_t max_ids);
+  int32_t area_index_point_batch (AREA_INDEX *ai, const double *x, const double *y, int32_t n, int32_t *start, int32_t **ids);
+  int32_t area_index_mbr (AREA_INDEX *ai, NV_F64_XYMBR mbr, int32_t *ids, int32_t max_ids);
+  void free_area_index (AREA_INDEX *ai);
+
+
+#ifdef  __cplusplus
+}
+#endif
+
+#endif
@@ -38,10 +38,22 @@
 
 #include <math.h>
 #include <stdio.h>
+#include <string.h>
 
 #include "pfm_nvtypes.h"
 #include "nvdef.h"
 
+#include "bit_pack.h"
+
+
+/*  Runtime selected AVX2 and SSE4.1 kernels for bit_unpack_array.  These are only built with GCC compatible
+    compilers on x86 since they rely on the target attribute and __builtin_cpu_supports.  */
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+  #define BIT_PACK_SIMD
+  #include <immintrin.h>
+#endif
+
 
 static const uint8_t    mask[8] = {0x00, 0x80, 0xc0, 0xe0, 0xf0, 0xf8, 0xfc, 
                         0xfe}, notmask[8] = {0xff, 0x7f, 0x3f, 0x1f, 0x0f, 
@@ -458,3 +470,594 @@ uint64_t double_bit_unpack (uint8_t buffer[], uint32_t start, uint32_t numbits)
 
   return (result);
 }
+
+
+
+/***************************************************************************/
+/*!
+
+  - Function        bit_reader_init - Sets up a BIT_READER for sequential
+                    reads from a packed buffer.
+
+  - Synopsis        bit_reader_init (br, buffer, size, start);
+                        - BIT_READER *br        reader to initialize
+                        - const uint8_t *buffer address of buffer to use
+                        - uint32_t size         size of buffer in bytes
+                        - uint32_t start        start bit position in buffer
+
+  - Description     The reader keeps a 64 bit accumulator that is refilled
+                    a byte at a time so that each field costs a shift and a
+                    mask instead of recomputing the start and end bytes.
+                    The reader never touches bytes at or past 'size'.  If
+                    a field runs past the end of the buffer the missing bits
+                    are returned as zero.
+
+  - Returns         void
+
+****************************************************************************/ 
+
+void bit_reader_init (BIT_READER *br, const uint8_t *buffer, uint32_t size, uint32_t start)
+{
+  br->buffer = buffer;
+  br->size = size;
+  br->byte = start >> 3;
+  br->acc = 0;
+  br->bits = 0;
+
+
+  /*  Preload the partial first byte with the bits prior to the start bit removed.  */
+
+  if (start & 7)
+    {
+      if (br->byte < size) br->acc = buffer[br->byte] & notmask[start & 7];
+      br->byte++;
+      br->bits = 8 - (start & 7);
+    }
+}
+
+
+
+/*  Top up the accumulator so that it holds at least 57 valid bits.  Past the end of the buffer we shift
+    in zeros.  */
+
+static inline void bit_reader_fill (BIT_READER *br)
+{
+  while (br->bits <= 56)
+    {
+      br->acc <<= 8;
+      if (br->byte < br->size) br->acc |= br->buffer[br->byte];
+      br->byte++;
+      br->bits += 8;
+    }
+}
+
+
+
+/***************************************************************************/
+/*!
+
+  - Function        bit_reader_get - Unpacks the next field from a
+                    BIT_READER.
+
+  - Synopsis        bit_reader_get (br, numbits);
+                        - BIT_READER *br        reader
+                        - uint32_t numbits      number of bits to retrieve
+                                                (1 to 32)
+
+  - Description     Returns the same value bit_unpack would return for the
+                    current bit position and then advances past the field.
+
+  - Returns         uint32_t                value retrieved from buffer
+
+****************************************************************************/ 
+
+uint32_t bit_reader_get (BIT_READER *br, uint32_t numbits)
+{
+  uint32_t            value;
+
+
+  /*  A zero bit field is always zero (and would make the mask below a shift by 64).  */
+
+  if (!numbits) return (0);
+
+  if (br->bits < (int32_t) numbits) bit_reader_fill (br);
+
+  br->bits -= numbits;
+  value = (uint32_t) ((br->acc >> br->bits) & (UINT64_MAX >> (64 - numbits)));
+
+  return (value);
+}
+
+
+
+/***************************************************************************/
+/*!
+
+  - Function        bit_reader_get64 - Unpacks the next long long integer
+                    field from a BIT_READER.
+
+  - Synopsis        bit_reader_get64 (br, numbits);
+                        - BIT_READER *br        reader
+                        - uint32_t numbits      number of bits to retrieve
+                                                (33 to 64)
+
+  - Description     Matches double_bit_unpack.  The field is read as the
+                    upper numbits - 32 bits followed by the lower 32 bits.
+
+  - Returns         uint64_t                value retrieved from buffer
+
+****************************************************************************/ 
+
+uint64_t bit_reader_get64 (BIT_READER *br, uint32_t numbits)
+{
+  uint64_t            result;
+
+
+  result = ((uint64_t) bit_reader_get (br, numbits - 32)) << 32;
+  result |= (uint64_t) bit_reader_get (br, 32);
+
+  return (result);
+}
+
+
+
+/***************************************************************************/
+/*!
+
+  - Function        bit_reader_get_array - Unpacks a run of equal width
+                    fields from a BIT_READER.
+
+  - Synopsis        bit_reader_get_array (br, numbits, count, out);
+                        - BIT_READER *br        reader
+                        - uint32_t numbits      width of each field (0 to 32)
+                        - int32_t count         number of fields
+                        - uint32_t *out         output values
+
+  - Description     Equivalent to calling bit_reader_get count times but
+                    only refills the accumulator when it runs low.  When
+                    the fields are narrow a single refill covers several of
+                    them.
+
+  - Returns         void
+
+****************************************************************************/ 
+
+void bit_reader_get_array (BIT_READER *br, uint32_t numbits, int32_t count, uint32_t *out)
+{
+  uint64_t            field_mask;
+  int32_t             i;
+
+
+  if (!numbits)
+    {
+      if (count > 0) memset (out, 0, count * sizeof (uint32_t));
+      return;
+    }
+
+  field_mask = UINT64_MAX >> (64 - numbits);
+
+  for (i = 0 ; i < count ; i++)
+    {
+      if (br->bits < (int32_t) numbits) bit_reader_fill (br);
+
+      br->bits -= numbits;
+      out[i] = (uint32_t) ((br->acc >> br->bits) & field_mask);
+    }
+}
+
+
+
+/***************************************************************************/
+/*!
+
+  - Function        bit_reader_position - Returns the current bit position
+                    of a BIT_READER.
+
+  - Synopsis        bit_reader_position (br);
+                        - BIT_READER *br        reader
+
+  - Returns         uint32_t                bit position of the next field
+                                            (the same 'start' value you
+                                            would pass to bit_unpack)
+
+****************************************************************************/ 
+
+uint32_t bit_reader_position (BIT_READER *br)
+{
+  return ((br->byte << 3) - br->bits);
+}
+
+
+
+/***************************************************************************/
+/*!
+
+  - Function        bit_writer_init - Sets up a BIT_WRITER for sequential
+                    writes to a packed buffer.
+
+  - Synopsis        bit_writer_init (bw, buffer, size, start);
+                        - BIT_WRITER *bw        writer to initialize
+                        - uint8_t *buffer       address of buffer to use
+                        - uint32_t size         size of buffer in bytes
+                        - uint32_t start        start bit position in buffer
+
+  - Description     Like bit_pack, the writer leaves the bits prior to
+                    'start' and after the last field untouched.  Whole
+                    bytes are written as soon as they are complete and the
+                    final partial byte is merged in by bit_writer_flush.
+                    Bytes at or past 'size' are never written.
+
+  - Returns         void
+
+****************************************************************************/ 
+
+void bit_writer_init (BIT_WRITER *bw, uint8_t *buffer, uint32_t size, uint32_t start)
+{
+  bw->buffer = buffer;
+  bw->size = size;
+  bw->byte = start >> 3;
+  bw->bits = start & 7;
+  bw->acc = 0;
+
+
+  /*  Carry the bits that are already in the first byte (prior to the start bit).  */
+
+  if (bw->bits && bw->byte < size) bw->acc = buffer[bw->byte] >> (8 - bw->bits);
+}
+
+
+
+/***************************************************************************/
+/*!
+
+  - Function        bit_writer_put - Packs the next field into a BIT_WRITER.
+
+  - Synopsis        bit_writer_put (bw, numbits, value);
+                        - BIT_WRITER *bw        writer
+                        - uint32_t numbits      number of bits to store
+                                                (1 to 32)
+                        - int32_t value         value to store
+
+  - Description     Stores the low 'numbits' bits of 'value' exactly as
+                    bit_pack would at the current bit position.
+
+  - Returns         void
+
+****************************************************************************/ 
+
+void bit_writer_put (BIT_WRITER *bw, uint32_t numbits, int32_t value)
+{
+  if (!numbits) return;
+
+  bw->acc = (bw->acc << numbits) | ((uint64_t) (uint32_t) value & (UINT64_MAX >> (64 - numbits)));
+  bw->bits += numbits;
+
+  while (bw->bits >= 8)
+    {
+      bw->bits -= 8;
+      if (bw->byte < bw->size) bw->buffer[bw->byte] = (uint8_t) (bw->acc >> bw->bits);
+      bw->byte++;
+    }
+}
+
+
+
+/***************************************************************************/
+/*!
+
+  - Function        bit_writer_put64 - Packs the next long long integer
+                    field into a BIT_WRITER.
+
+  - Synopsis        bit_writer_put64 (bw, numbits, value);
+                        - BIT_WRITER *bw        writer
+                        - uint32_t numbits      number of bits to store
+                                                (33 to 64)
+                        - int64_t value         value to store
+
+  - Description     Matches double_bit_pack.
+
+  - Returns         void
+
+****************************************************************************/ 
+
+void bit_writer_put64 (BIT_WRITER *bw, uint32_t numbits, int64_t value)
+{
+  bit_writer_put (bw, numbits - 32, (int32_t) (((uint64_t) value) >> 32));
+  bit_writer_put (bw, 32, (int32_t) (value & UINT32_MAX));
+}
+
+
+
+/***************************************************************************/
+/*!
+
+  - Function        bit_writer_put_array - Packs a run of equal width
+                    fields into a BIT_WRITER.
+
+  - Synopsis        bit_writer_put_array (bw, numbits, count, values);
+                        - BIT_WRITER *bw        writer
+                        - uint32_t numbits      width of each field (0 to 32)
+                        - int32_t count         number of fields
+                        - const uint32_t *values    values to store
+
+  - Returns         void
+
+****************************************************************************/ 
+
+void bit_writer_put_array (BIT_WRITER *bw, uint32_t numbits, int32_t count, const uint32_t *values)
+{
+  int32_t             i;
+
+
+  for (i = 0 ; i < count ; i++) bit_writer_put (bw, numbits, (int32_t) values[i]);
+}
+
+
+
+/***************************************************************************/
+/*!
+
+  - Function        bit_writer_flush - Writes the trailing partial byte of
+                    a BIT_WRITER.
+
+  - Synopsis        bit_writer_flush (bw);
+                        - BIT_WRITER *bw        writer
+
+  - Description     Merges any pending bits into the buffer, preserving the
+                    bits after the end of the last field the same way
+                    bit_pack does.  You must call this after the last put.
+                    It is safe to keep writing after a flush.
+
+  - Returns         uint32_t                bit position after the last
+                                            field
+
+****************************************************************************/ 
+
+uint32_t bit_writer_flush (BIT_WRITER *bw)
+{
+  if (bw->bits && bw->byte < bw->size)
+    {
+      bw->buffer[bw->byte] &= notmask[bw->bits];
+      bw->buffer[bw->byte] |= (uint8_t) (bw->acc << (8 - bw->bits)) & mask[bw->bits];
+    }
+
+  return ((bw->byte << 3) + bw->bits);
+}
+
+
+
+#ifdef BIT_PACK_SIMD
+
+/*  Eight consecutive fields of numbits bits cover exactly numbits bytes, so every group of eight starts at the
+    same bit phase.  That lets us build one byte shuffle that pulls a big-endian 32 bit window for each lane, a
+    per lane left shift to drop the leading bits, and a common right shift to drop the trailing bits.  Lanes 4
+    through 7 are loaded from a second 16 byte window starting "off4" bytes into the group.  Fields have to fit
+    in a 32 bit window after the phase shift so this only handles 1 to 25 bits.  */
+
+static void bit_unpack_setup (uint32_t phase, uint32_t numbits, uint32_t *off4, int8_t shuffle[32], int32_t shift[8])
+{
+  uint32_t            i, k, b, o;
+
+
+  *off4 = (phase + 4 * numbits) >> 3;
+
+  for (i = 0 ; i < 8 ; i++)
+    {
+      b = phase + i * numbits;
+      o = b >> 3;
+      if (i >= 4) o -= *off4;
+
+      for (k = 0 ; k < 4 ; k++) shuffle[i * 4 + k] = (int8_t) (o + 3 - k);
+
+      shift[i] = b & 7;
+    }
+}
+
+
+
+__attribute__ ((target ("avx2")))
+static void bit_unpack_avx2 (const uint8_t *group, uint32_t phase, uint32_t numbits, int32_t groups, uint32_t *out)
+{
+  int8_t              shuffle[32];
+  int32_t             shift[8], g;
+  uint32_t            off4;
+  __m256i             shuf, lshift, v;
+  __m128i             rshift;
+
+
+  bit_unpack_setup (phase, numbits, &off4, shuffle, shift);
+  shuf = _mm256_loadu_si256 ((const __m256i *) shuffle);
+  lshift = _mm256_loadu_si256 ((const __m256i *) shift);
+  rshift = _mm_cvtsi32_si128 (32 - numbits);
+
+  for (g = 0 ; g < groups ; g++)
+    {
+      v = _mm256_inserti128_si256 (_mm256_castsi128_si256 (_mm_loadu_si128 ((const __m128i *) group)),
+                                   _mm_loadu_si128 ((const __m128i *) (group + off4)), 1);
+      v = _mm256_shuffle_epi8 (v, shuf);
+      v = _mm256_srl_epi32 (_mm256_sllv_epi32 (v, lshift), rshift);
+      _mm256_storeu_si256 ((__m256i *) out, v);
+
+      group += numbits;
+      out += 8;
+    }
+}
+
+
+
+__attribute__ ((target ("sse4.1")))
+static void bit_unpack_sse4 (const uint8_t *group, uint32_t phase, uint32_t numbits, int32_t groups, uint32_t *out)
+{
+  int8_t              shuffle[32];
+  int32_t             shift[8], g, i;
+  uint32_t            off4;
+  __m128i             shuf_lo, shuf_hi, mul_lo, mul_hi, rshift, v;
+
+
+  bit_unpack_setup (phase, numbits, &off4, shuffle, shift);
+
+
+  /*  No variable shifts before AVX2 so the left shift is a multiply by 2^shift.  */
+
+  for (i = 0 ; i < 8 ; i++) shift[i] = 1 << shift[i];
+
+  shuf_lo = _mm_loadu_si128 ((const __m128i *) shuffle);
+  shuf_hi = _mm_loadu_si128 ((const __m128i *) (shuffle + 16));
+  mul_lo = _mm_loadu_si128 ((const __m128i *) shift);
+  mul_hi = _mm_loadu_si128 ((const __m128i *) (shift + 4));
+  rshift = _mm_cvtsi32_si128 (32 - numbits);
+
+  for (g = 0 ; g < groups ; g++)
+    {
+      v = _mm_shuffle_epi8 (_mm_loadu_si128 ((const __m128i *) group), shuf_lo);
+      _mm_storeu_si128 ((__m128i *) out, _mm_srl_epi32 (_mm_mullo_epi32 (v, mul_lo), rshift));
+
+      v = _mm_shuffle_epi8 (_mm_loadu_si128 ((const __m128i *) (group + off4)), shuf_hi);
+      _mm_storeu_si128 ((__m128i *) (out + 4), _mm_srl_epi32 (_mm_mullo_epi32 (v, mul_hi), rshift));
+
+      group += numbits;
+      out += 8;
+    }
+}
+
+#endif
+
+
+
+/***************************************************************************/
+/*!
+
+  - Function        bit_unpack_array - Unpacks a run of equal width fields
+                    from a buffer.
+
+  - Synopsis        bit_unpack_array (buffer, start, numbits, count, out);
+                        - uint8_t buffer[]      address of buffer to use
+                        - uint32_t start        start bit position in buffer
+                        - uint32_t numbits      width of each field (0 to 32)
+                        - int32_t count         number of fields
+                        - uint32_t *out         output values
+
+  - Description     Gives the same results as calling bit_unpack count
+                    times, advancing start by numbits each time.  On x86
+                    processors with AVX2 or SSE4.1 (checked at run time),
+                    fields of 25 bits or less are unpacked eight at a
+                    time.  Wider fields, the tail of the run, and other
+                    processors go through a BIT_READER.  No byte past the
+                    last bit of the last field is read.
+
+  - Returns         void
+
+****************************************************************************/ 
+
+void bit_unpack_array (uint8_t buffer[], uint32_t start, uint32_t numbits, int32_t count, uint32_t *out)
+{
+  BIT_READER          br;
+  uint32_t            last_byte;
+  int32_t             done = 0;
+
+
+  if (count <= 0) return;
+
+
+  /*  Zero bit fields (e.g. an SRTM block where every post has the same value) are all zero, same as bit_unpack.  */
+
+  if (!numbits)
+    {
+      memset (out, 0, count * sizeof (uint32_t));
+      return;
+    }
+
+  last_byte = (uint32_t) (((uint64_t) start + (uint64_t) count * numbits - 1) >> 3);
+
+
+#ifdef BIT_PACK_SIMD
+
+  if (numbits <= 25)
+    {
+      int32_t             groups = 0, avx2, sse4;
+      uint32_t            phase, base, off4;
+
+
+      avx2 = __builtin_cpu_supports ("avx2");
+      sse4 = __builtin_cpu_supports ("sse4.1");
+
+      if (avx2 || sse4)
+        {
+          phase = start & 7;
+          base = start >> 3;
+          off4 = (phase + 4 * numbits) >> 3;
+
+
+          /*  Each group reads 16 bytes starting off4 bytes in so stop before that runs past the end.  */
+
+          if (count >= 8 && base + off4 + 15 <= last_byte)
+            {
+              groups = (last_byte - (base + off4 + 15)) / numbits + 1;
+              groups = MIN (groups, count / 8);
+            }
+
+          if (groups)
+            {
+              if (avx2)
+                {
+                  bit_unpack_avx2 (buffer + base, phase, numbits, groups, out);
+                }
+              else
+                {
+                  bit_unpack_sse4 (buffer + base, phase, numbits, groups, out);
+                }
+
+              done += groups * 8;
+            }
+        }
+    }
+
+#endif
+
+
+  if (done < count)
+    {
+      bit_reader_init (&br, buffer, last_byte + 1, start + done * numbits);
+      bit_reader_get_array (&br, numbits, count - done, out + done);
+    }
+}
+
+
+
+/***************************************************************************/
+/*!
+
+  - Function        bit_pack_array - Packs a run of equal width fields into
+                    a buffer.
+
+  - Synopsis        bit_pack_array (buffer, start, numbits, count, values);
+                        - uint8_t buffer[]      address of buffer to use
+                        - uint32_t start        start bit position in buffer
+                        - uint32_t numbits      width of each field (0 to 32)
+                        - int32_t count         number of fields
+                        - const uint32_t *values    values to store
+
+  - Description     Gives the same buffer as calling bit_pack count times,
+                    advancing start by numbits each time, including leaving
+                    the bits before start and after the last field alone.
+                    Packing is a serial chain of shifts and ORs so this goes
+                    through a BIT_WRITER rather than a vector kernel.
+
+  - Returns         void
+
+****************************************************************************/ 
+
+void bit_pack_array (uint8_t buffer[], uint32_t start, uint32_t numbits, int32_t count, const uint32_t *values)
+{
+  BIT_WRITER          bw;
+  uint32_t            last_byte;
+
+
+  if (count <= 0 || !numbits) return;
+
+  last_byte = (uint32_t) (((uint64_t) start + (uint64_t) count * numbits - 1) >> 3);
+
+  bit_writer_init (&bw, buffer, last_byte + 1, start);
+  bit_writer_put_array (&bw, numbits, count, values);
+  bit_writer_flush (&bw);
+}
@@ -47,12 +47,49 @@ extern "C" {
 #include "pfm_nvtypes.h"
 
 
+  /*!  Sequential reader for bit packed buffers.  See bit_reader_init in bit_pack.c.  */
+
+  typedef struct
+  {
+    const uint8_t *buffer;      /*!<  Packed buffer  */
+    uint32_t      size;         /*!<  Size of buffer in bytes  */
+    uint32_t      byte;         /*!<  Next byte to load into the accumulator  */
+    uint64_t      acc;          /*!<  Bit accumulator (the low "bits" bits are valid)  */
+    int32_t       bits;         /*!<  Number of unread bits in the accumulator  */
+  } BIT_READER;
+
+
+  /*!  Sequential writer for bit packed buffers.  See bit_writer_init in bit_pack.c.  */
+
+  typedef struct
+  {
+    uint8_t       *buffer;      /*!<  Packed buffer  */
+    uint32_t      size;         /*!<  Size of buffer in bytes  */
+    uint32_t      byte;         /*!<  Next byte to be written  */
+    uint64_t      acc;          /*!<  Bit accumulator (the low "bits" bits are pending)  */
+    int32_t       bits;         /*!<  Number of pending bits in the accumulator (0 to 7 between puts)  */
+  } BIT_WRITER;
+
+
   int32_t int_log2 (uint32_t v);
   int32_t short_log2 (uint16_t v);
   void bit_pack (uint8_t buffer[], uint32_t start, uint32_t numbits, int32_t value) ;
   uint32_t bit_unpack (uint8_t buffer[], uint32_t start, uint32_t numbits);
   void double_bit_pack (uint8_t buffer[], uint32_t start, uint32_t numbits, int64_t value);
-  int64_t double_bit_unpack (uint8_t buffer[], uint32_t start, uint32_t numbits);
+  uint64_t double_bit_unpack (uint8_t buffer[], uint32_t start, uint32_t numbits);
+  void bit_unpack_array (uint8_t buffer[], uint32_t start, uint32_t numbits, int32_t count, uint32_t *out);
+  void bit_pack_array (uint8_t buffer[], uint32_t start, uint32_t numbits, int32_t count, const uint32_t *values);
+
+  void bit_reader_init (BIT_READER *br, const uint8_t *buffer, uint32_t size, uint32_t start);
+  uint32_t bit_reader_get (BIT_READER *br, uint32_t numbits);
+  uint64_t bit_reader_get64 (BIT_READER *br, uint32_t numbits);
+  void bit_reader_get_array (BIT_READER *br, uint32_t numbits, int32_t count, uint32_t *out);
+  uint32_t bit_reader_position (BIT_READER *br);
+  void bit_writer_init (BIT_WRITER *bw, uint8_t *buffer, uint32_t size, uint32_t start);
+  void bit_writer_put (BIT_WRITER *bw, uint32_t numbits, int32_t value);
+  void bit_writer_put64 (BIT_WRITER *bw, uint32_t numbits, int64_t value);
+  void bit_writer_put_array (BIT_WRITER *bw, uint32_t numbits, int32_t count, const uint32_t *values);
+  uint32_t bit_writer_flush (BIT_WRITER *bw);
 
 
 #ifdef  __cplusplus
@@ -36,8 +36,47 @@
 
 
 
+/*  pread and pwrite are UNIX98 functions and mk only defines a bare _XOPEN_SOURCE on Linux.  */
+
+#ifdef NVLinux
+  #undef _XOPEN_SOURCE
+  #define _XOPEN_SOURCE 500
+#endif
+
 #include "chrtr.h"
 
+#include <math.h>
+#include <pthread.h>
+
+#ifdef NVWIN3X
+  #include <windows.h>
+  #include <io.h>
+#else
+  #include <sys/mman.h>
+  #include <sys/stat.h>
+#endif
+
+
+/*  Number of blocks of MAX_CHRTR_FILES handles that may be allocated.  */
+
+#define MAX_CHRTR_BLOCKS        1024
+
+
+/*  Size of the header record of a tiled CHRTR file and the number of decoded tiles we keep per file.  */
+
+#define CHRTR_TILED_HEADER_SIZE 48
+#define CHRTR_TILE_CACHE        64
+
+
+/*  A decoded (native byte order) tile in the tile cache.  */
+
+typedef struct
+{
+  int32_t       tile;                                /*  Tile number or -1 if this cache slot is empty  */
+  int64_t       stamp;                               /*  Last time the tile was used  */
+  float         *data;                               /*  tile_size * tile_size floats  */
+} CHRTR_TILE;
+
 
 typedef struct
 {
@@ -45,10 +84,371 @@ typedef struct
   uint8_t       swap;
   CHRTR_HEADER  header;
   float         grid_degrees;
+  uint8_t       *map;                                /*  Memory mapped file (NULL if not mapped)  */
+  int64_t       map_size;                            /*  Size of the mapped file in bytes  */
+  uint8_t       map_native;                          /*  NVTrue if the mapped data is in native byte order  */
+#ifdef NVWIN3X
+  HANDLE        map_handle;
+#endif
+  uint8_t       tiled;                               /*  NVTrue if this is a tiled CHRTR file  */
+  int32_t       tile_size;                           /*  Tile width and height in cells  */
+  int32_t       tiles_x;                             /*  Number of tile columns  */
+  int32_t       tiles_y;                             /*  Number of tile rows  */
+  int64_t       *tile_offset;                        /*  File offset of each tile (from the tile index)  */
+  CHRTR_TILE    *cache;                              /*  LRU cache of decoded tiles  */
+  int64_t       cache_stamp;                         /*  Incremented on every cache access  */
+  pthread_mutex_t cache_mutex;                       /*  Protects the tile cache  */
 } INTERNAL_CHRTR_HEADER;
 
-static INTERNAL_CHRTR_HEADER chrtrh[MAX_CHRTR_FILES];
-static uint8_t first = NVTrue;
+
+/*  The handle table is allocated MAX_CHRTR_FILES entries at a time as needed.  Blocks are never moved or freed so
+    a thread can use its handle without locking while another thread opens or closes a different file.  Only
+    opening and closing need chrtr_mutex.  */
+
+static INTERNAL_CHRTR_HEADER *chrtrh[MAX_CHRTR_BLOCKS];
+static int32_t num_chrtr_blocks = 0;
+static pthread_mutex_t chrtr_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+
+
+/*  Return the internal header for a handle.  */
+
+static INTERNAL_CHRTR_HEADER *chrtr_handle (int32_t hnd)
+{
+  return (&chrtrh[hnd / MAX_CHRTR_FILES][hnd % MAX_CHRTR_FILES]);
+}
+
+
+
+/*  Find an unused handle, adding a new block of handles if all of the current ones are in use.  This must be
+    called with chrtr_mutex locked.  Returns -1 if we can't allocate any more handles.  */
+
+static int32_t chrtr_new_handle ()
+{
+  int32_t          i, j;
+
+
+  for (i = 0 ; i < num_chrtr_blocks ; i++)
+    {
+      for (j = 0 ; j < MAX_CHRTR_FILES ; j++)
+        {
+          if (chrtrh[i][j].fp == NULL) return (i * MAX_CHRTR_FILES + j);
+        }
+    }
+
+
+  if (num_chrtr_blocks == MAX_CHRTR_BLOCKS) return (-1);
+
+
+  chrtrh[num_chrtr_blocks] = (INTERNAL_CHRTR_HEADER *) calloc (MAX_CHRTR_FILES, sizeof (INTERNAL_CHRTR_HEADER));
+  if (chrtrh[num_chrtr_blocks] == NULL)
+    {
+      perror ("Allocating chrtr handle memory");
+      return (-1);
+    }
+
+  num_chrtr_blocks++;
+
+  return ((num_chrtr_blocks - 1) * MAX_CHRTR_FILES);
+}
+
+
+
+/*  Positional read and write.  These don't use or move the FILE position so any number of threads may read
+    (or write disjoint parts of) the same handle at once.  They return the number of bytes transferred or -1
+    on error.  */
+
+static int64_t chrtr_pread (INTERNAL_CHRTR_HEADER *chrtr, void *data, int64_t size, int64_t pos)
+{
+  int64_t          total = 0, got;
+
+
+  while (total < size)
+    {
+#ifdef NVWIN3X
+      OVERLAPPED ov;
+      DWORD bytes;
+
+      memset (&ov, 0, sizeof (OVERLAPPED));
+      ov.Offset = (DWORD) ((pos + total) & 0xffffffff);
+      ov.OffsetHigh = (DWORD) ((pos + total) >> 32);
+
+      got = -1;
+      if (ReadFile ((HANDLE) _get_osfhandle (fileno (chrtr->fp)), (uint8_t *) data + total, (DWORD) (size - total), &bytes, &ov))
+        got = bytes;
+#else
+      got = pread64 (fileno (chrtr->fp), (uint8_t *) data + total, size - total, pos + total);
+#endif
+
+      if (got < 0) return (-1);
+      if (!got) break;
+
+      total += got;
+    }
+
+  return (total);
+}
+
+
+
+static int64_t chrtr_pwrite (INTERNAL_CHRTR_HEADER *chrtr, const void *data, int64_t size, int64_t pos)
+{
+  int64_t          total = 0, put;
+
+
+  while (total < size)
+    {
+#ifdef NVWIN3X
+      OVERLAPPED ov;
+      DWORD bytes;
+
+      memset (&ov, 0, sizeof (OVERLAPPED));
+      ov.Offset = (DWORD) ((pos + total) & 0xffffffff);
+      ov.OffsetHigh = (DWORD) ((pos + total) >> 32);
+
+      put = -1;
+      if (WriteFile ((HANDLE) _get_osfhandle (fileno (chrtr->fp)), (const uint8_t *) data + total, (DWORD) (size - total), &bytes, &ov))
+        put = bytes;
+#else
+      put = pwrite64 (fileno (chrtr->fp), (const uint8_t *) data + total, size - total, pos + total);
+#endif
+
+      if (put <= 0) return (-1);
+
+      total += put;
+    }
+
+  return (total);
+}
+
+
+
+/*  Compute the byte position of a cell within the CHRTR file (row + 1 gets us past the header).  This is done in
+    64 bits so that we can handle files larger than 2GB.  */
+
+static int64_t chrtr_pos (INTERNAL_CHRTR_HEADER *chrtr, int32_t row, int32_t col)
+{
+  return (((int64_t) row + 1) * (int64_t) chrtr->header.width * (int64_t) sizeof (float) + (int64_t) col * (int64_t) sizeof (float));
+}
+
+
+
+/*  Swap the bytes of a 64 bit tile index entry.  */
+
+static void chrtr_swap_int64 (int64_t *word)
+{
+  double           d;
+
+  memcpy (&d, word, 8);
+  swap_double (&d);
+  memcpy (word, &d, 8);
+}
+
+
+
+/*  Set up a tiled CHRTR file.  The tile size has already been read.  We read the tile index and allocate the
+    tile cache.  */
+
+static uint8_t chrtr_tiled_init (INTERNAL_CHRTR_HEADER *chrtr)
+{
+  int32_t          i, num_tiles;
+
+
+  if (chrtr->tile_size <= 0) return (NVFalse);
+
+  chrtr->tiles_x = (chrtr->header.width + chrtr->tile_size - 1) / chrtr->tile_size;
+  chrtr->tiles_y = (chrtr->header.height + chrtr->tile_size - 1) / chrtr->tile_size;
+  num_tiles = chrtr->tiles_x * chrtr->tiles_y;
+
+
+  chrtr->tile_offset = (int64_t *) malloc (num_tiles * sizeof (int64_t));
+  chrtr->cache = (CHRTR_TILE *) calloc (CHRTR_TILE_CACHE, sizeof (CHRTR_TILE));
+  if (chrtr->tile_offset == NULL || chrtr->cache == NULL)
+    {
+      perror ("Allocating chrtr tile memory");
+      free (chrtr->tile_offset);
+      free (chrtr->cache);
+      return (NVFalse);
+    }
+
+  if (chrtr_pread (chrtr, chrtr->tile_offset, (int64_t) num_tiles * sizeof (int64_t), CHRTR_TILED_HEADER_SIZE) !=
+      (int64_t) num_tiles * (int64_t) sizeof (int64_t))
+    {
+      free (chrtr->tile_offset);
+      free (chrtr->cache);
+      return (NVFalse);
+    }
+
+  if (chrtr->swap) for (i = 0 ; i < num_tiles ; i++) chrtr_swap_int64 (&chrtr->tile_offset[i]);
+
+
+  for (i = 0 ; i < CHRTR_TILE_CACHE ; i++) chrtr->cache[i].tile = -1;
+
+  pthread_mutex_init (&chrtr->cache_mutex, NULL);
+
+  chrtr->tiled = NVTrue;
+
+  return (NVTrue);
+}
+
+
+
+static void chrtr_tiled_free (INTERNAL_CHRTR_HEADER *chrtr)
+{
+  int32_t          i;
+
+
+  for (i = 0 ; i < CHRTR_TILE_CACHE ; i++) free (chrtr->cache[i].data);
+
+  free (chrtr->cache);
+  free (chrtr->tile_offset);
+  pthread_mutex_destroy (&chrtr->cache_mutex);
+}
+
+
+
+/*  Return a decoded tile from the cache, reading it from the file (and throwing out the least recently used
+    tile) if it isn't there.  This must be called with cache_mutex locked.  Returns NULL on read error.  */
+
+static float *chrtr_get_tile (INTERNAL_CHRTR_HEADER *chrtr, int32_t tile)
+{
+  int32_t          i, lru = 0, count;
+  CHRTR_TILE       *slot;
+
+
+  chrtr->cache_stamp++;
+
+  for (i = 0 ; i < CHRTR_TILE_CACHE ; i++)
+    {
+      if (chrtr->cache[i].tile == tile)
+        {
+          chrtr->cache[i].stamp = chrtr->cache_stamp;
+          return (chrtr->cache[i].data);
+        }
+
+      if (chrtr->cache[i].stamp < chrtr->cache[lru].stamp) lru = i;
+    }
+
+
+  slot = &chrtr->cache[lru];
+  count = chrtr->tile_size * chrtr->tile_size;
+
+  if (slot->data == NULL)
+    {
+      slot->data = (float *) malloc (count * sizeof (float));
+      if (slot->data == NULL)
+        {
+          perror ("Allocating chrtr tile memory");
+          return (NULL);
+        }
+    }
+
+  slot->tile = -1;
+
+  if (chrtr_pread (chrtr, slot->data, (int64_t) count * sizeof (float), chrtr->tile_offset[tile]) <= 0) return (NULL);
+
+  if (chrtr->swap) swap_float_array (slot->data, count);
+
+  slot->tile = tile;
+  slot->stamp = chrtr->cache_stamp;
+
+  return (slot->data);
+}
+
+
+
+/*  Read part of a row from a tiled CHRTR file through the tile cache.  */
+
+static uint8_t chrtr_tiled_read (INTERNAL_CHRTR_HEADER *chrtr, int32_t row, int32_t start_col, int32_t num_cols, float *data)
+{
+  int32_t          col, end_col, count, ts = chrtr->tile_size;
+  float            *tile;
+
+
+  if (row < 0 || row >= chrtr->header.height || start_col < 0 || start_col + num_cols > chrtr->header.width) return (NVFalse);
+
+  end_col = start_col + num_cols;
+
+  pthread_mutex_lock (&chrtr->cache_mutex);
+
+  for (col = start_col ; col < end_col ; col += count)
+    {
+      if ((tile = chrtr_get_tile (chrtr, (row / ts) * chrtr->tiles_x + col / ts)) == NULL)
+        {
+          pthread_mutex_unlock (&chrtr->cache_mutex);
+          return (NVFalse);
+        }
+
+      count = MIN (end_col, (col / ts + 1) * ts) - col;
+
+      memcpy (data + (col - start_col), tile + (row % ts) * ts + col % ts, count * sizeof (float));
+    }
+
+  pthread_mutex_unlock (&chrtr->cache_mutex);
+
+  return (NVTrue);
+}
+
+
+
+/*  Write part of a row to a tiled CHRTR file.  The data is written straight to the file (one write per tile
+    crossed) and any cached copies of the tiles are updated.  */
+
+static uint8_t chrtr_tiled_write (INTERNAL_CHRTR_HEADER *chrtr, int32_t row, int32_t start_col, int32_t num_cols, const float *data)
+{
+  int32_t          i, col, end_col, count, tile, ts = chrtr->tile_size;
+  float            *buf;
+  uint8_t          ret = NVTrue;
+
+
+  if (row < 0 || row >= chrtr->header.height || start_col < 0 || start_col + num_cols > chrtr->header.width) return (NVFalse);
+
+  buf = (float *) malloc (MIN (num_cols, ts) * sizeof (float));
+  if (buf == NULL)
+    {
+      perror ("Allocating chrtr tile memory");
+      return (NVFalse);
+    }
+
+  end_col = start_col + num_cols;
+
+  pthread_mutex_lock (&chrtr->cache_mutex);
+
+  for (col = start_col ; col < end_col ; col += count)
+    {
+      tile = (row / ts) * chrtr->tiles_x + col / ts;
+      count = MIN (end_col, (col / ts + 1) * ts) - col;
+
+
+      /*  Update the cached tile if we have it.  */
+
+      for (i = 0 ; i < CHRTR_TILE_CACHE ; i++)
+        {
+          if (chrtr->cache[i].tile == tile)
+            {
+              memcpy (chrtr->cache[i].data + (row % ts) * ts + col % ts, data + (col - start_col), count * sizeof (float));
+              break;
+            }
+        }
+
+
+      memcpy (buf, data + (col - start_col), count * sizeof (float));
+      if (chrtr->swap) swap_float_array (buf, count);
+
+      if (chrtr_pwrite (chrtr, buf, (int64_t) count * sizeof (float),
+                        chrtr->tile_offset[tile] + ((int64_t) (row % ts) * ts + col % ts) * (int64_t) sizeof (float)) < 0)
+        {
+          ret = NVFalse;
+          break;
+        }
+    }
+
+  pthread_mutex_unlock (&chrtr->cache_mutex);
+
+  free (buf);
+
+  return (ret);
+}
 
 
 /***************************************************************************/
@@ -176,6 +576,18 @@ int32_t bit_test (float value, int32_t bit)
                            contained at least one input value when gridded.  The ordering
                            of these values is West to East starting with the southernmost
                            grid row and continuing to the northernmost grid row.
+                 - Tiled CHRTR files (see create_chrtr_tiled) have the same first ten header
+                   values except that the endian indicator is CHRTR_TILED_ENDIAN (or
+                   CHRTR_TILED_SWAPPED if the file must be byte swapped).  These are followed by :
+                     - int   = Tile size (the tiles are square)
+                     - int   = Pad (the header record is 48 bytes)
+                     - int64 = Tile index.  File offset of each tile, West to East and South to
+                               North, one per tile.
+                     - Tiles of tile size by tile size 4 byte floats, West to East and South to
+                       North within each tile.  Tiles on the East and North edges are padded to
+                       the full tile size.
+                 - Tiled files are detected here and read_chrtr, write_chrtr, and get_chrtr_value
+                   handle them transparently using a cache of the most recently used tiles.
 
 
   - Author:      Jan C. Depner (area.based.editor@gmail.com)
@@ -193,146 +605,189 @@ int32_t bit_test (float value, int32_t bit)
 int32_t open_chrtr (const char *path, CHRTR_HEADER *header)
 {
   int32_t          i, hnd;
+  INTERNAL_CHRTR_HEADER *chrtr;
 
 
-  /*  The first time through we want to initialize the chrtr header array.  */
+  /*  Find the next available handle (the handle table grows as needed).  */
 
-  if (first)
-    {
-      for (i = 0 ; i < MAX_CHRTR_FILES ; i++) 
-        {
-          memset (&chrtrh[i], 0, sizeof (INTERNAL_CHRTR_HEADER));
-          chrtrh[i].fp = NULL;
-        }
-      first = NVFalse;
-    }
+  pthread_mutex_lock (&chrtr_mutex);
 
-
-  /*  Find the next available handle and make sure we haven't opened too many.  */
-
-  hnd = MAX_CHRTR_FILES;
-  for (i = 0 ; i < MAX_CHRTR_FILES ; i++)
+  if ((hnd = chrtr_new_handle ()) < 0)
     {
-      if (chrtrh[i].fp == NULL)
-        {
-          hnd = i;
-          break;
-        }
+      fprintf (stderr, "\n\nUnable to allocate a chrtr handle for %s\n\n", path);
+      fflush (stderr);
+      pthread_mutex_unlock (&chrtr_mutex);
+      return (-1);
     }
 
-
-  if (hnd == MAX_CHRTR_FILES)
-    {
-      fprintf (stderr, "\n\nToo many open chrtr files!\nTerminating!\n\n");
-      exit (-1);
-    }
+  chrtr = chrtr_handle (hnd);
 
 
   /*  Open the file and read the header.  */
 
-  if ((chrtrh[hnd].fp = fopen (path, "rb+")) != NULL)
+  if ((chrtr->fp = fopen64 (path, "rb+")) != NULL)
     {
 
       /*  Read the ENDIAN indicator and set the swap flag accordingly.    */
 
-      fseek (chrtrh[hnd].fp, 28, SEEK_SET);
-      if (!fread (&i, sizeof (int32_t), 1, chrtrh[hnd].fp))
+      fseek (chrtr->fp, 28, SEEK_SET);
+      if (!fread (&i, sizeof (int32_t), 1, chrtr->fp))
 	{
 	  fprintf (stderr, "Read error in file %s, function %s at line %d.", __FILE__, __FUNCTION__, __LINE__ - 2);
           fflush (stderr);
+          fclose (chrtr->fp);
+          chrtr->fp = NULL;
+          pthread_mutex_unlock (&chrtr_mutex);
 	  return (-1);
 	}
 
-      if (i == 0x03020100)
+      if (i == 0x03020100 || i == CHRTR_TILED_SWAPPED)
         {
-	  chrtrh[hnd].swap = NVTrue;
+	  chrtr->swap = NVTrue;
         }
       else
         {
-	  chrtrh[hnd].swap = NVFalse;
+	  chrtr->swap = NVFalse;
         }
-      if (!fread (&chrtrh[hnd].header.min_z, sizeof (float), 1, chrtrh[hnd].fp))
+
+      chrtr->tiled = (i == CHRTR_TILED_ENDIAN || i == CHRTR_TILED_SWAPPED);
+      if (!fread (&chrtr->header.min_z, sizeof (float), 1, chrtr->fp))
 	{
 	  fprintf (stderr, "Read error in file %s, function %s at line %d.", __FILE__, __FUNCTION__, __LINE__ - 2);
           fflush (stderr);
+          fclose (chrtr->fp);
+          chrtr->fp = NULL;
+          pthread_mutex_unlock (&chrtr_mutex);
 	  return (-1);
 	}
-      if (!fread (&chrtrh[hnd].header.max_z, sizeof (float), 1, chrtrh[hnd].fp))
+      if (!fread (&chrtr->header.max_z, sizeof (float), 1, chrtr->fp))
 	{
 	  fprintf (stderr, "Read error in file %s, function %s at line %d.", __FILE__, __FUNCTION__, __LINE__ - 2);
           fflush (stderr);
+          fclose (chrtr->fp);
+          chrtr->fp = NULL;
+          pthread_mutex_unlock (&chrtr_mutex);
 	  return (-1);
 	}
 
 
-      fseek (chrtrh[hnd].fp, 0, SEEK_SET);
-      if (!fread (&chrtrh[hnd].header.wlon, sizeof (float), 1, chrtrh[hnd].fp))
+      fseek (chrtr->fp, 0, SEEK_SET);
+      if (!fread (&chrtr->header.wlon, sizeof (float), 1, chrtr->fp))
 	{
 	  fprintf (stderr, "Read error in file %s, function %s at line %d.", __FILE__, __FUNCTION__, __LINE__ - 2);
           fflush (stderr);
+          fclose (chrtr->fp);
+          chrtr->fp = NULL;
+          pthread_mutex_unlock (&chrtr_mutex);
 	  return (-1);
 	}
-      if (!fread (&chrtrh[hnd].header.elon, sizeof (float), 1, chrtrh[hnd].fp))
+      if (!fread (&chrtr->header.elon, sizeof (float), 1, chrtr->fp))
 	{
 	  fprintf (stderr, "Read error in file %s, function %s at line %d.", __FILE__, __FUNCTION__, __LINE__ - 2);
           fflush (stderr);
+          fclose (chrtr->fp);
+          chrtr->fp = NULL;
+          pthread_mutex_unlock (&chrtr_mutex);
 	  return (-1);
 	}
-      if (!fread (&chrtrh[hnd].header.slat, sizeof (float), 1, chrtrh[hnd].fp))
+      if (!fread (&chrtr->header.slat, sizeof (float), 1, chrtr->fp))
 	{
 	  fprintf (stderr, "Read error in file %s, function %s at line %d.", __FILE__, __FUNCTION__, __LINE__ - 2);
           fflush (stderr);
+          fclose (chrtr->fp);
+          chrtr->fp = NULL;
+          pthread_mutex_unlock (&chrtr_mutex);
 	  return (-1);
 	}
-      if (!fread (&chrtrh[hnd].header.nlat, sizeof (float), 1, chrtrh[hnd].fp))
+      if (!fread (&chrtr->header.nlat, sizeof (float), 1, chrtr->fp))
 	{
 	  fprintf (stderr, "Read error in file %s, function %s at line %d.", __FILE__, __FUNCTION__, __LINE__ - 2);
           fflush (stderr);
+          fclose (chrtr->fp);
+          chrtr->fp = NULL;
+          pthread_mutex_unlock (&chrtr_mutex);
 	  return (-1);
 	}
-      if (!fread (&chrtrh[hnd].header.grid_minutes, sizeof (float), 1, chrtrh[hnd].fp))
+      if (!fread (&chrtr->header.grid_minutes, sizeof (float), 1, chrtr->fp))
 	{
 	  fprintf (stderr, "Read error in file %s, function %s at line %d.", __FILE__, __FUNCTION__, __LINE__ - 2);
           fflush (stderr);
+          fclose (chrtr->fp);
+          chrtr->fp = NULL;
+          pthread_mutex_unlock (&chrtr_mutex);
 	  return (-1);
 	}
-      if (!fread (&chrtrh[hnd].header.width, sizeof (int32_t), 1, chrtrh[hnd].fp))
+      if (!fread (&chrtr->header.width, sizeof (int32_t), 1, chrtr->fp))
 	{
 	  fprintf (stderr, "Read error in file %s, function %s at line %d.", __FILE__, __FUNCTION__, __LINE__ - 2);
           fflush (stderr);
+          fclose (chrtr->fp);
+          chrtr->fp = NULL;
+          pthread_mutex_unlock (&chrtr_mutex);
 	  return (-1);
 	}
-      if (!fread (&chrtrh[hnd].header.height, sizeof (int32_t), 1, chrtrh[hnd].fp))
+      if (!fread (&chrtr->header.height, sizeof (int32_t), 1, chrtr->fp))
 	{
 	  fprintf (stderr, "Read error in file %s, function %s at line %d.", __FILE__, __FUNCTION__, __LINE__ - 2);
           fflush (stderr);
+          fclose (chrtr->fp);
+          chrtr->fp = NULL;
+          pthread_mutex_unlock (&chrtr_mutex);
 	  return (-1);
 	}
 
-      if (chrtrh[hnd].swap)
+      if (chrtr->swap)
         {
-	  swap_float (&chrtrh[hnd].header.wlon);
-	  swap_float (&chrtrh[hnd].header.elon);
-	  swap_float (&chrtrh[hnd].header.slat);
-	  swap_float (&chrtrh[hnd].header.nlat);
-	  swap_float (&chrtrh[hnd].header.grid_minutes);
-	  swap_int (&chrtrh[hnd].header.width);
-	  swap_int (&chrtrh[hnd].header.height);
-	  swap_float (&chrtrh[hnd].header.min_z);
-	  swap_float (&chrtrh[hnd].header.max_z);
+	  swap_float (&chrtr->header.wlon);
+	  swap_float (&chrtr->header.elon);
+	  swap_float (&chrtr->header.slat);
+	  swap_float (&chrtr->header.nlat);
+	  swap_float (&chrtr->header.grid_minutes);
+	  swap_int (&chrtr->header.width);
+	  swap_int (&chrtr->header.height);
+	  swap_float (&chrtr->header.min_z);
+	  swap_float (&chrtr->header.max_z);
 	}
 
 
-      *header = chrtrh[hnd].header;
+      /*  Tiled files have the tile size right after the normal header fields followed by the tile index.  */
+
+      if (chrtr->tiled)
+        {
+          if (chrtr_pread (chrtr, &chrtr->tile_size, sizeof (int32_t), 40) != sizeof (int32_t))
+            {
+              chrtr->tile_size = 0;
+            }
+          else if (chrtr->swap)
+            {
+              swap_int (&chrtr->tile_size);
+            }
+
+          if (!chrtr_tiled_init (chrtr))
+            {
+              fprintf (stderr, "Unable to read the tile index of chrtr file %s\n", path);
+              fflush (stderr);
+              fclose (chrtr->fp);
+              memset (chrtr, 0, sizeof (INTERNAL_CHRTR_HEADER));
+              chrtr->fp = NULL;
+              pthread_mutex_unlock (&chrtr_mutex);
+              return (-1);
+            }
+        }
+
+
+      *header = chrtr->header;
 
 
-      chrtrh[hnd].grid_degrees = chrtrh[hnd].header.grid_minutes / 60.0;
+      chrtr->grid_degrees = chrtr->header.grid_minutes / 60.0;
     }
   else
     {
       hnd = -1;
     }
 
+  pthread_mutex_unlock (&chrtr_mutex);
+
   return (hnd);
 }
 
@@ -361,59 +816,62 @@ int32_t create_chrtr (const char *path, CHRTR_HEADER *header)
 {
   int32_t          i, j, hnd;
   uint8_t          zero = 0;
+  INTERNAL_CHRTR_HEADER *chrtr;
 
 
-  /*  Find the next available handle and make sure we haven't opened too many.  */
-
-  hnd = MAX_CHRTR_FILES;
-  for (i = 0 ; i < MAX_CHRTR_FILES ; i++)
-    {
-      if (chrtrh[i].fp == NULL)
-        {
-          hnd = i;
-          break;
-        }
-    }
+  /*  Find the next available handle (the handle table grows as needed).  */
 
+  pthread_mutex_lock (&chrtr_mutex);
 
-  if (hnd == MAX_CHRTR_FILES)
+  if ((hnd = chrtr_new_handle ()) < 0)
     {
-      fprintf (stderr, "\n\nToo many open chrtr files!\nTerminating!\n\n");
-      exit (-1);
+      fprintf (stderr, "\n\nUnable to allocate a chrtr handle for %s\n\n", path);
+      fflush (stderr);
+      pthread_mutex_unlock (&chrtr_mutex);
+      return (-1);
     }
 
+  chrtr = chrtr_handle (hnd);
+
 
   /*  Open the file and write the header.  */
 
-  if ((chrtrh[hnd].fp = fopen (path, "wb+")) != NULL)
+  if ((chrtr->fp = fopen64 (path, "wb+")) != NULL)
     {
-      fwrite (&header->wlon, sizeof (float), 1, chrtrh[hnd].fp);
-      fwrite (&header->elon, sizeof (float), 1, chrtrh[hnd].fp);
-      fwrite (&header->slat, sizeof (float), 1, chrtrh[hnd].fp);
-      fwrite (&header->nlat, sizeof (float), 1, chrtrh[hnd].fp);
-      fwrite (&header->grid_minutes, sizeof (float), 1, chrtrh[hnd].fp);
-      fwrite (&header->width, sizeof (int32_t), 1, chrtrh[hnd].fp);
-      fwrite (&header->height, sizeof (int32_t), 1, chrtrh[hnd].fp);
+      fwrite (&header->wlon, sizeof (float), 1, chrtr->fp);
+      fwrite (&header->elon, sizeof (float), 1, chrtr->fp);
+      fwrite (&header->slat, sizeof (float), 1, chrtr->fp);
+      fwrite (&header->nlat, sizeof (float), 1, chrtr->fp);
+      fwrite (&header->grid_minutes, sizeof (float), 1, chrtr->fp);
+      fwrite (&header->width, sizeof (int32_t), 1, chrtr->fp);
+      fwrite (&header->height, sizeof (int32_t), 1, chrtr->fp);
       i = 0x00010203;
-      fwrite (&i, sizeof (int32_t), 1, chrtrh[hnd].fp);
-      fwrite (&header->min_z, sizeof (float), 1, chrtrh[hnd].fp);
-      fwrite (&header->max_z, sizeof (float), 1, chrtrh[hnd].fp);
+      fwrite (&i, sizeof (int32_t), 1, chrtr->fp);
+      fwrite (&header->min_z, sizeof (float), 1, chrtr->fp);
+      fwrite (&header->max_z, sizeof (float), 1, chrtr->fp);
 
-      j = ftell (chrtrh[hnd].fp);
+      j = ftell (chrtr->fp);
 
       for (i = j ; i < (int32_t) header->width * (int32_t) sizeof (float) ; i++)
 	{
-	  fwrite (&zero, 1, 1, chrtrh[hnd].fp);
+	  fwrite (&zero, 1, 1, chrtr->fp);
 	}
 
-      chrtrh[hnd].header = *header;
-      chrtrh[hnd].grid_degrees = header->grid_minutes / 60.0;
+
+      /*  The data records are written with positional I/O so we have to get the header out of the stdio buffer.  */
+
+      fflush (chrtr->fp);
+
+      chrtr->header = *header;
+      chrtr->grid_degrees = header->grid_minutes / 60.0;
     }
   else
     {
       hnd = -1;
     }
 
+  pthread_mutex_unlock (&chrtr_mutex);
+
   return (hnd);
 }
 
@@ -422,67 +880,222 @@ int32_t create_chrtr (const char *path, CHRTR_HEADER *header)
 /********************************************************************/
 /*!
 
-  - Function:    close_chrtr
-
-  - Purpose:     Close a chrtr file.
+  - Function:    create_chrtr_tiled
 
-  - Author:      Jan C. Depner (area.based.editor@gmail.com)
+  - Purpose:     Create a tiled chrtr file.  The grid is stored as square
+                 tiles instead of rows so that reading a small window
+                 (or scattered points) touches far fewer disk pages.  The
+                 data is read and written with the normal functions.
+                 See open_chrtr for the format.  Tiled files can't be
+                 memory mapped with chrtr_map and can't be read by
+                 versions of this library prior to 2.2.49.
 
-  - Date:        03/21/08
+  - Date:        10/18/26
 
-  - Arguments:   hnd            -    The file handle
+  - Arguments:
+                 - path           =    The chrtr file path
+                 - header         =    CHRTR_HEADER structure to be written
+                 - tile_size      =    Tile width/height in cells (0 for
+                                       CHRTR_TILE_SIZE)
 
-  - Returns:     N/A
+  - Returns:     int32_t          =    The file handle or -1 on error
 
 ********************************************************************/
 
-void close_chrtr (int32_t hnd)
+int32_t create_chrtr_tiled (const char *path, CHRTR_HEADER *header, int32_t tile_size)
 {
-  fclose (chrtrh[hnd].fp);
-  chrtrh[hnd].fp = NULL;
-  memset (&chrtrh[hnd], 0, sizeof (INTERNAL_CHRTR_HEADER));
-  chrtrh[hnd].fp = NULL;
-}
+  int32_t          i, hnd, num_tiles, tiles_x, tiles_y, rec[2];
+  int64_t          *offset, tile_bytes, data_start;
+  uint8_t          zero = 0;
+  CHRTR_HEADER     hdr;
+  INTERNAL_CHRTR_HEADER *chrtr;
 
 
+  if (tile_size <= 0) tile_size = CHRTR_TILE_SIZE;
 
-/********************************************************************/
-/*!
+  tiles_x = (header->width + tile_size - 1) / tile_size;
+  tiles_y = (header->height + tile_size - 1) / tile_size;
+  num_tiles = tiles_x * tiles_y;
 
-  - Function:    read_chrtr
 
-  - Purpose:     Retrieve a portion of a chrtr row from a chrtr file.
+  /*  Tiles start on a 4096 byte boundary after the tile index.  */
 
-  - Author:      Jan C. Depner (area.based.editor@gmail.com)
+  tile_bytes = (int64_t) tile_size * (int64_t) tile_size * (int64_t) sizeof (float);
+  data_start = ((CHRTR_TILED_HEADER_SIZE + (int64_t) num_tiles * (int64_t) sizeof (int64_t)) + 4095) / 4096 * 4096;
 
-  - Date:        03/21/08
+  offset = (int64_t *) malloc (num_tiles * sizeof (int64_t));
+  if (offset == NULL)
+    {
+      perror ("Allocating chrtr tile index memory");
+      return (-1);
+    }
 
-  - Arguments:
-                 - hnd            =    The file handle
-                 - row            =    The row number of the chrtr
-                                       row to be retrieved
-                 - start_col      =    starting column number to read
-                 - num_cols       =    number of columns to read
-                 - data           =    The returned array of floats
+  for (i = 0 ; i < num_tiles ; i++) offset[i] = data_start + (int64_t) i * tile_bytes;
 
-  Returns:       uint8_t          =    NVFalse on error
 
-********************************************************************/
+  pthread_mutex_lock (&chrtr_mutex);
 
-uint8_t read_chrtr (int32_t hnd, int32_t row, int32_t start_col, int32_t num_cols, float *data)
-{
-  int32_t i, pos;
+  if ((hnd = chrtr_new_handle ()) < 0)
+    {
+      fprintf (stderr, "\n\nUnable to allocate a chrtr handle for %s\n\n", path);
+      fflush (stderr);
+      pthread_mutex_unlock (&chrtr_mutex);
+      free (offset);
+      return (-1);
+    }
 
+  chrtr = chrtr_handle (hnd);
 
-  /*  Compute the record position within the CHRTR file (row + 1 gets us past the header).  */
-    
-  pos = (row + 1) * chrtrh[hnd].header.width * sizeof (float) + start_col * sizeof (float);
 
-  if (fseek (chrtrh[hnd].fp, pos, SEEK_SET)) return (NVFalse);
+  if ((chrtr->fp = fopen64 (path, "wb+")) == NULL)
+    {
+      pthread_mutex_unlock (&chrtr_mutex);
+      free (offset);
+      return (-1);
+    }
+
+
+  hdr = *header;
+  hdr.endian = CHRTR_TILED_ENDIAN;
+  rec[0] = tile_size;
+  rec[1] = 0;
+
+  fwrite (&hdr.wlon, sizeof (float), 1, chrtr->fp);
+  fwrite (&hdr.elon, sizeof (float), 1, chrtr->fp);
+  fwrite (&hdr.slat, sizeof (float), 1, chrtr->fp);
+  fwrite (&hdr.nlat, sizeof (float), 1, chrtr->fp);
+  fwrite (&hdr.grid_minutes, sizeof (float), 1, chrtr->fp);
+  fwrite (&hdr.width, sizeof (int32_t), 1, chrtr->fp);
+  fwrite (&hdr.height, sizeof (int32_t), 1, chrtr->fp);
+  fwrite (&hdr.endian, sizeof (int32_t), 1, chrtr->fp);
+  fwrite (&hdr.min_z, sizeof (float), 1, chrtr->fp);
+  fwrite (&hdr.max_z, sizeof (float), 1, chrtr->fp);
+  fwrite (rec, sizeof (int32_t), 2, chrtr->fp);
+  fwrite (offset, sizeof (int64_t), num_tiles, chrtr->fp);
+
+
+  /*  Extend the file to its full size so that all of the tiles can be read.  */
+
+  fseeko64 (chrtr->fp, data_start + (int64_t) num_tiles * tile_bytes - 1, SEEK_SET);
+  fwrite (&zero, 1, 1, chrtr->fp);
+
+  free (offset);
+
+  if (fflush (chrtr->fp))
+    {
+      fclose (chrtr->fp);
+      chrtr->fp = NULL;
+      pthread_mutex_unlock (&chrtr_mutex);
+      return (-1);
+    }
+
+
+  chrtr->header = *header;
+  chrtr->grid_degrees = header->grid_minutes / 60.0;
+  chrtr->swap = NVFalse;
+  chrtr->tile_size = tile_size;
+
+  if (!chrtr_tiled_init (chrtr))
+    {
+      fclose (chrtr->fp);
+      memset (chrtr, 0, sizeof (INTERNAL_CHRTR_HEADER));
+      chrtr->fp = NULL;
+      hnd = -1;
+    }
+
+  pthread_mutex_unlock (&chrtr_mutex);
+
+  return (hnd);
+}
+
+
+
+/********************************************************************/
+/*!
+
+  - Function:    close_chrtr
+
+  - Purpose:     Close a chrtr file.
+
+  - Author:      Jan C. Depner (area.based.editor@gmail.com)
+
+  - Date:        03/21/08
+
+  - Arguments:   hnd            -    The file handle
+
+  - Returns:     N/A
+
+********************************************************************/
+
+void close_chrtr (int32_t hnd)
+{
+  INTERNAL_CHRTR_HEADER *chrtr = chrtr_handle (hnd);
+
+
+  pthread_mutex_lock (&chrtr_mutex);
+
+  if (chrtr->map != NULL) chrtr_unmap (hnd);
+
+  if (chrtr->tiled) chrtr_tiled_free (chrtr);
+
+  fclose (chrtr->fp);
+  memset (chrtr, 0, sizeof (INTERNAL_CHRTR_HEADER));
+  chrtr->fp = NULL;
+
+  pthread_mutex_unlock (&chrtr_mutex);
+}
+
+
+
+/********************************************************************/
+/*!
+
+  - Function:    read_chrtr
+
+  - Purpose:     Retrieve a portion of a chrtr row from a chrtr file.
+                 This uses positional reads so multiple threads may
+                 read from the same handle at the same time.
+
+  - Author:      Jan C. Depner (area.based.editor@gmail.com)
+
+  - Date:        03/21/08
+
+  - Arguments:
+                 - hnd            =    The file handle
+                 - row            =    The row number of the chrtr
+                                       row to be retrieved
+                 - start_col      =    starting column number to read
+                 - num_cols       =    number of columns to read
+                 - data           =    The returned array of floats
+
+  Returns:       uint8_t          =    NVFalse on error
 
-  if (!fread (data, sizeof (float), num_cols, chrtrh[hnd].fp)) return (NVFalse);
+********************************************************************/
 
-  if (chrtrh[hnd].swap) for (i = 0 ; i < num_cols ; i++) swap_float (&data[i]);
+uint8_t read_chrtr (int32_t hnd, int32_t row, int32_t start_col, int32_t num_cols, float *data)
+{
+  INTERNAL_CHRTR_HEADER *chrtr = chrtr_handle (hnd);
+
+
+  if (chrtr->tiled) return (chrtr_tiled_read (chrtr, row, start_col, num_cols, data));
+
+
+  /*  If the file has been mapped (see chrtr_map) we just copy from memory.  */
+
+  if (chrtr->map != NULL)
+    {
+      if (row < 0 || row >= chrtr->header.height || start_col < 0 || start_col + num_cols > chrtr->header.width) return (NVFalse);
+
+      memcpy (data, chrtr->map + chrtr_pos (chrtr, row, start_col), num_cols * sizeof (float));
+
+      if (chrtr->map_native) return (NVTrue);
+    }
+  else
+    {
+      if (chrtr_pread (chrtr, data, (int64_t) num_cols * sizeof (float), chrtr_pos (chrtr, row, start_col)) <= 0) return (NVFalse);
+    }
+
+  if (chrtr->swap) swap_float_array (data, num_cols);
 
   return (NVTrue);
 }
@@ -494,7 +1107,8 @@ uint8_t read_chrtr (int32_t hnd, int32_t row, int32_t start_col, int32_t num_col
 
   - Function:    write_chrtr
 
-  - Purpose:     write a portion of a chrtr row to a chrtr file.
+  - Purpose:     write a portion of a chrtr row to a chrtr file.  The
+                 data is byte swapped to the file's byte order if needed.
 
   - Author:      Jan C. Depner (area.based.editor@gmail.com)
 
@@ -514,16 +1128,39 @@ uint8_t read_chrtr (int32_t hnd, int32_t row, int32_t start_col, int32_t num_col
 
 uint8_t write_chrtr (int32_t hnd, int32_t row, int32_t start_col, int32_t num_cols, float *data)
 {
-  int32_t pos;
+  int64_t ret;
+  float *swapped;
+  INTERNAL_CHRTR_HEADER *chrtr = chrtr_handle (hnd);
 
 
-  /*  Compute the record position within the CHRTR file (row + 1 gets us past the header).  */
-    
-  pos = (row + 1) * chrtrh[hnd].header.width * sizeof (float) + start_col * sizeof (float);
+  if (chrtr->tiled) return (chrtr_tiled_write (chrtr, row, start_col, num_cols, data));
 
-  if (fseek (chrtrh[hnd].fp, pos, SEEK_SET)) return (NVFalse);
 
-  if (!fwrite (data, sizeof (float), num_cols, chrtrh[hnd].fp)) return (NVFalse);
+  /*  If the file is in the other byte order we have to swap a copy of the data (we don't want to change the
+      caller's data).  */
+
+  if (chrtr->swap)
+    {
+      swapped = (float *) malloc (num_cols * sizeof (float));
+      if (swapped == NULL)
+        {
+          perror ("Allocating chrtr swap memory");
+          return (NVFalse);
+        }
+
+      memcpy (swapped, data, num_cols * sizeof (float));
+      swap_float_array (swapped, num_cols);
+
+      ret = chrtr_pwrite (chrtr, swapped, (int64_t) num_cols * sizeof (float), chrtr_pos (chrtr, row, start_col));
+
+      free (swapped);
+    }
+  else
+    {
+      ret = chrtr_pwrite (chrtr, data, (int64_t) num_cols * sizeof (float), chrtr_pos (chrtr, row, start_col));
+    }
+
+  if (ret < 0) return (NVFalse);
 
   return (NVTrue);
 }
@@ -556,27 +1193,252 @@ uint8_t write_chrtr (int32_t hnd, int32_t row, int32_t start_col, int32_t num_co
 
 uint8_t get_chrtr_value (int32_t hnd, double lat, double lon, float *value)
 {
-  int32_t pos, row, col;
+  int32_t row, col;
+  INTERNAL_CHRTR_HEADER *chrtr = chrtr_handle (hnd);
 
 
-  if (lat < chrtrh[hnd].header.slat || lat > chrtrh[hnd].header.nlat ||
-      lon < chrtrh[hnd].header.wlon || lon > chrtrh[hnd].header.elon)
+  if (lat < chrtr->header.slat || lat > chrtr->header.nlat ||
+      lon < chrtr->header.wlon || lon > chrtr->header.elon)
     return (NVFalse);
 
 
-  row = (lat - chrtrh[hnd].header.slat) / chrtrh[hnd].grid_degrees;
-  col = (lon - chrtrh[hnd].header.wlon) / chrtrh[hnd].grid_degrees;
+  row = (lat - chrtr->header.slat) / chrtr->grid_degrees;
+  col = (lon - chrtr->header.wlon) / chrtr->grid_degrees;
 
 
-  /*  Compute the record position within the CHRTR file (row + 1 gets us past the header).  */
-    
-  pos = (row + 1) * chrtrh[hnd].header.width * sizeof (float) + col * sizeof (float);
+  if (chrtr->tiled) return (chrtr_tiled_read (chrtr, row, col, 1, value));
 
-  if (fseek (chrtrh[hnd].fp, pos, SEEK_SET)) return (NVFalse);
 
-  if (!fread (value, sizeof (float), 1, chrtrh[hnd].fp)) return (NVFalse);
+  if (chrtr->map != NULL)
+    {
+      if (row >= chrtr->header.height || col >= chrtr->header.width) return (NVFalse);
+
+      memcpy (value, chrtr->map + chrtr_pos (chrtr, row, col), sizeof (float));
+
+      if (chrtr->map_native) return (NVTrue);
+    }
+  else
+    {
+      if (chrtr_pread (chrtr, value, sizeof (float), chrtr_pos (chrtr, row, col)) != sizeof (float)) return (NVFalse);
+    }
 
-  if (chrtrh[hnd].swap) swap_float (value);
+  if (chrtr->swap) swap_float (value);
+
+  return (NVTrue);
+}
+
+
+
+/*  A single request for get_chrtr_values.  */
+
+typedef struct
+{
+  int32_t       row;                                 /*  Row (lower row of the pair when interpolating)  */
+  int32_t       col;                                 /*  Column (left column of the pair when interpolating)  */
+  float         row_frac;                            /*  Fraction of the way to the next row (interpolation only)  */
+  float         col_frac;                            /*  Fraction of the way to the next column (interpolation only)  */
+  int32_t       ndx;                                 /*  Index into the caller's arrays  */
+} CHRTR_REQUEST;
+
+
+/*  Requests in the same row that are more than this many columns apart are read separately rather than reading
+    all of the columns between them.  */
+
+#define CHRTR_MAX_SPAN_GAP      1024
+
+
+static int chrtr_request_compare (const void *a, const void *b)
+{
+  const CHRTR_REQUEST *ra = (const CHRTR_REQUEST *) a, *rb = (const CHRTR_REQUEST *) b;
+
+  if (ra->row != rb->row) return (ra->row < rb->row ? -1 : 1);
+  if (ra->col != rb->col) return (ra->col < rb->col ? -1 : 1);
+  return (0);
+}
+
+
+
+/********************************************************************/
+/*!
+
+  - Function:    get_chrtr_values
+
+  - Purpose:     Batch version of get_chrtr_value.  The requests are
+                 sorted by row and column and the cells are read in row
+                 spans so that each span costs one read instead of one
+                 read per point.
+                 - If bilinear is NVFalse you get the value of the cell
+                   that contains each position (same as get_chrtr_value).
+                 - If bilinear is set the value is interpolated from the
+                   four surrounding cell centers.  Positions within half
+                   a cell of the edge of the grid use the edge cells.  If
+                   any of the four cells is null the value of the cell
+                   containing the position is returned instead.
+
+  - Date:        10/18/26
+
+  - Arguments:
+                 - hnd            =    The file handle
+                 - lat            =    Array of latitudes
+                 - lon            =    Array of longitudes
+                 - n              =    Number of positions
+                 - out            =    Returned values (CHRTRNULL for
+                                       positions outside of the area)
+                 - bilinear       =    NVTrue to interpolate
+
+  - Returns:     uint8_t          =    NVFalse on memory allocation or
+                                       read error
+
+********************************************************************/
+
+uint8_t get_chrtr_values (int32_t hnd, const double *lat, const double *lon, int32_t n, float *out, uint8_t bilinear)
+{
+  int32_t          i, j, k, count, start, end, start_col, end_col, num_cols, num_rows, buf_size = 0, r, c;
+  float            *buf = NULL, *new_buf, v[4], *row0, *row1;
+  double           y, x;
+  CHRTR_REQUEST    *req;
+  INTERNAL_CHRTR_HEADER *chrtr = chrtr_handle (hnd);
+
+
+  if (n <= 0) return (NVTrue);
+
+  req = (CHRTR_REQUEST *) malloc (n * sizeof (CHRTR_REQUEST));
+  if (req == NULL)
+    {
+      perror ("Allocating chrtr request memory");
+      return (NVFalse);
+    }
+
+
+  /*  Figure out which cells we need and throw away anything outside of the area.  */
+
+  count = 0;
+  for (i = 0 ; i < n ; i++)
+    {
+      out[i] = CHRTRNULL;
+
+      if (lat[i] < chrtr->header.slat || lat[i] > chrtr->header.nlat ||
+          lon[i] < chrtr->header.wlon || lon[i] > chrtr->header.elon) continue;
+
+      y = (lat[i] - chrtr->header.slat) / chrtr->grid_degrees;
+      x = (lon[i] - chrtr->header.wlon) / chrtr->grid_degrees;
+
+      if (bilinear && chrtr->header.height > 1 && chrtr->header.width > 1)
+        {
+          /*  Cell centers are at half cell offsets.  */
+
+          y -= 0.5;
+          x -= 0.5;
+
+          req[count].row = MIN (MAX ((int32_t) floor (y), 0), chrtr->header.height - 2);
+          req[count].col = MIN (MAX ((int32_t) floor (x), 0), chrtr->header.width - 2);
+          req[count].row_frac = MIN (MAX (y - req[count].row, 0.0), 1.0);
+          req[count].col_frac = MIN (MAX (x - req[count].col, 0.0), 1.0);
+        }
+      else
+        {
+          req[count].row = MIN ((int32_t) y, chrtr->header.height - 1);
+          req[count].col = MIN ((int32_t) x, chrtr->header.width - 1);
+          req[count].row_frac = req[count].col_frac = 0.0;
+        }
+
+      req[count].ndx = i;
+      count++;
+    }
+
+
+  if (!bilinear || chrtr->header.height < 2 || chrtr->header.width < 2)
+    {
+      bilinear = NVFalse;
+      num_rows = 1;
+    }
+  else
+    {
+      num_rows = 2;
+    }
+
+
+  qsort (req, count, sizeof (CHRTR_REQUEST), chrtr_request_compare);
+
+
+  /*  Walk through the sorted requests one span at a time.  A span is a run of requests in the same row whose
+      columns are no more than CHRTR_MAX_SPAN_GAP apart.  */
+
+  for (start = 0 ; start < count ; start = end)
+    {
+      start_col = end_col = req[start].col;
+
+      for (end = start + 1 ; end < count ; end++)
+        {
+          if (req[end].row != req[start].row || req[end].col - end_col > CHRTR_MAX_SPAN_GAP) break;
+          end_col = req[end].col;
+        }
+
+      if (bilinear) end_col++;
+      num_cols = end_col - start_col + 1;
+
+
+      if (num_cols * num_rows > buf_size)
+        {
+          buf_size = num_cols * num_rows;
+          if ((new_buf = (float *) realloc (buf, buf_size * sizeof (float))) == NULL)
+            {
+              perror ("Allocating chrtr span memory");
+              free (buf);
+              free (req);
+              return (NVFalse);
+            }
+          buf = new_buf;
+        }
+
+      row0 = buf;
+      row1 = buf + num_cols;
+
+      for (j = 0 ; j < num_rows ; j++)
+        {
+          if (!read_chrtr (hnd, req[start].row + j, start_col, num_cols, buf + j * num_cols))
+            {
+              free (buf);
+              free (req);
+              return (NVFalse);
+            }
+        }
+
+
+      for (k = start ; k < end ; k++)
+        {
+          c = req[k].col - start_col;
+
+          if (!bilinear)
+            {
+              out[req[k].ndx] = row0[c];
+              continue;
+            }
+
+          v[0] = row0[c];
+          v[1] = row0[c + 1];
+          v[2] = row1[c];
+          v[3] = row1[c + 1];
+
+
+          /*  If any of the corners is null, fall back to the cell that contains the point.  */
+
+          if (v[0] >= CHRTRNULL || v[1] >= CHRTRNULL || v[2] >= CHRTRNULL || v[3] >= CHRTRNULL)
+            {
+              r = req[k].row_frac < 0.5 ? 0 : 1;
+              out[req[k].ndx] = v[r * 2 + (req[k].col_frac < 0.5 ? 0 : 1)];
+            }
+          else
+            {
+              out[req[k].ndx] = (v[0] * (1.0 - req[k].col_frac) + v[1] * req[k].col_frac) * (1.0 - req[k].row_frac) +
+                (v[2] * (1.0 - req[k].col_frac) + v[3] * req[k].col_frac) * req[k].row_frac;
+            }
+        }
+    }
+
+
+  free (buf);
+  free (req);
 
   return (NVTrue);
 }
@@ -602,21 +1464,675 @@ uint8_t get_chrtr_value (int32_t hnd, double lat, double lon, float *value)
 
 void dump_chrtr_header (int32_t hnd)
 {
-  if (fseek (chrtrh[hnd].fp, 0, SEEK_SET))
+  INTERNAL_CHRTR_HEADER *chrtr = chrtr_handle (hnd);
+
+
+  if (chrtr->fp == NULL)
     {
-      fprintf (stderr, "Unable to seek to location 0 for CHRTR handle %d\n", hnd);
+      fprintf (stderr, "CHRTR handle %d is not open\n", hnd);
     }
   else
     {
-      fprintf (stderr, "\nWest lon            : %.09f\n", chrtrh[hnd].header.wlon);
-      fprintf (stderr, "East lon            : %.09f\n", chrtrh[hnd].header.elon);
-      fprintf (stderr, "South lat           : %.09f\n", chrtrh[hnd].header.slat);
-      fprintf (stderr, "North lat           : %.09f\n", chrtrh[hnd].header.nlat);
-      fprintf (stderr, "Grid size (minutes) : %.06f\n", chrtrh[hnd].header.grid_minutes);
-      fprintf (stderr, "Width (bins)        : %d\n", chrtrh[hnd].header.width);
-      fprintf (stderr, "Height (bins)       : %d\n", chrtrh[hnd].header.height);
-      fprintf (stderr, "Swap                : %d\n", chrtrh[hnd].swap);
-      fprintf (stderr, "Minimum Z           : %.04f\n", chrtrh[hnd].header.min_z);
-      fprintf (stderr, "Maximum Z           : %.04f\n\n", chrtrh[hnd].header.max_z);
+      fprintf (stderr, "\nWest lon            : %.09f\n", chrtr->header.wlon);
+      fprintf (stderr, "East lon            : %.09f\n", chrtr->header.elon);
+      fprintf (stderr, "South lat           : %.09f\n", chrtr->header.slat);
+      fprintf (stderr, "North lat           : %.09f\n", chrtr->header.nlat);
+      fprintf (stderr, "Grid size (minutes) : %.06f\n", chrtr->header.grid_minutes);
+      fprintf (stderr, "Width (bins)        : %d\n", chrtr->header.width);
+      fprintf (stderr, "Height (bins)       : %d\n", chrtr->header.height);
+      fprintf (stderr, "Swap                : %d\n", chrtr->swap);
+      if (chrtr->tiled) fprintf (stderr, "Tile size (bins)    : %d\n", chrtr->tile_size);
+      fprintf (stderr, "Minimum Z           : %.04f\n", chrtr->header.min_z);
+      fprintf (stderr, "Maximum Z           : %.04f\n\n", chrtr->header.max_z);
+    }
+}
+
+
+
+/********************************************************************/
+/*!
+
+  - Function:    chrtr_map
+
+  - Purpose:     Memory map the data portion of an open chrtr file so
+                 that rows can be accessed directly with chrtr_map_row
+                 (no system calls or copies).  Once a file is mapped
+                 read_chrtr and get_chrtr_value also read from the map.
+                 - Files in native byte order are mapped read only and
+                   shared with the system file cache.
+                 - Byte swapped files are only mapped if convert is set.
+                   In that case the file is mapped copy-on-write and all
+                   of the data is swapped in memory once, right here.
+                   The file on disk is not modified.  Since this touches
+                   every page of the file it should only be used when you
+                   are going to scan most of the grid.
+                 - Tiled files can't be mapped.
+                 - Data written with write_chrtr after a byte swapped file
+                   has been mapped will not show up in the map.
+
+  - Date:        10/18/26
+
+  - Arguments:
+                 - hnd            =    The file handle
+                 - convert        =    NVTrue to convert byte swapped
+                                       files on open
+
+  - Returns:     uint8_t          =    NVFalse if the file could not be
+                                       mapped (tiled file, byte swapped
+                                       file without convert, file
+                                       shorter than the
+                                       header says, or map failure)
+
+********************************************************************/
+
+uint8_t chrtr_map (int32_t hnd, uint8_t convert)
+{
+  int64_t          size, count;
+  float            *data;
+  INTERNAL_CHRTR_HEADER *chrtr = chrtr_handle (hnd);
+
+
+  if (chrtr->map != NULL) return (NVTrue);
+
+  if (chrtr->tiled || (chrtr->swap && !convert)) return (NVFalse);
+
+
+  size = chrtr_pos (chrtr, chrtr->header.height, 0);
+
+  if ((uint64_t) size > (uint64_t) ((size_t) -1)) return (NVFalse);
+
+
+  /*  Make sure the file is as big as the header says it is or we'll get a bus error trying to read past the end.  */
+
+  fflush (chrtr->fp);
+
+#ifdef NVWIN3X
+  {
+    HANDLE file = (HANDLE) _get_osfhandle (fileno (chrtr->fp));
+    LARGE_INTEGER file_size;
+
+    if (!GetFileSizeEx (file, &file_size) || file_size.QuadPart < size) return (NVFalse);
+
+    chrtr->map_handle = CreateFileMapping (file, NULL, PAGE_READONLY, 0, 0, NULL);
+    if (chrtr->map_handle == NULL) return (NVFalse);
+
+    chrtr->map = (uint8_t *) MapViewOfFile (chrtr->map_handle, chrtr->swap ? FILE_MAP_COPY : FILE_MAP_READ, 0, 0, (SIZE_T) size);
+    if (chrtr->map == NULL)
+      {
+        CloseHandle (chrtr->map_handle);
+        chrtr->map_handle = NULL;
+        return (NVFalse);
+      }
+  }
+#else
+  {
+    struct stat64 st;
+    void *map;
+
+    if (fstat64 (fileno (chrtr->fp), &st) || st.st_size < size) return (NVFalse);
+
+    if (chrtr->swap)
+      {
+        map = mmap (NULL, (size_t) size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fileno (chrtr->fp), 0);
+      }
+    else
+      {
+        map = mmap (NULL, (size_t) size, PROT_READ, MAP_SHARED, fileno (chrtr->fp), 0);
+      }
+
+    if (map == MAP_FAILED) return (NVFalse);
+
+    chrtr->map = (uint8_t *) map;
+  }
+#endif
+
+  chrtr->map_size = size;
+
+
+  /*  Convert byte swapped data to native order (the header row is left alone).  */
+
+  if (chrtr->swap)
+    {
+      data = (float *) (chrtr->map + chrtr_pos (chrtr, 0, 0));
+      count = (int64_t) chrtr->header.width * (int64_t) chrtr->header.height;
+
+      swap_float_array (data, count);
+    }
+
+  chrtr->map_native = NVTrue;
+
+  return (NVTrue);
+}
+
+
+
+/********************************************************************/
+/*!
+
+  - Function:    chrtr_map_row
+
+  - Purpose:     Return a pointer to a row of a chrtr file that has been
+                 mapped with chrtr_map.  The data is in native byte
+                 order.  The pointer is valid until chrtr_unmap or
+                 close_chrtr is called.
+
+  - Date:        10/18/26
+
+  - Arguments:
+                 - hnd            =    The file handle
+                 - row            =    The row number
+
+  - Returns:     const float *    =    Pointer to the first column of
+                                       the row or NULL if the file isn't
+                                       mapped or the row is out of range
+
+********************************************************************/
+
+const float *chrtr_map_row (int32_t hnd, int32_t row)
+{
+  INTERNAL_CHRTR_HEADER *chrtr = chrtr_handle (hnd);
+
+
+  if (chrtr->map == NULL || row < 0 || row >= chrtr->header.height) return (NULL);
+
+  return ((const float *) (chrtr->map + chrtr_pos (chrtr, row, 0)));
+}
+
+
+
+/********************************************************************/
+/*!
+
+  - Function:    chrtr_unmap
+
+  - Purpose:     Release the memory map created by chrtr_map.  The file
+                 stays open and read_chrtr goes back to reading from the
+                 file.  This is called by close_chrtr so you only need
+                 it if you want to release the map early.
+
+  - Date:        10/18/26
+
+  - Arguments:   hnd            -    The file handle
+
+  - Returns:     N/A
+
+********************************************************************/
+
+void chrtr_unmap (int32_t hnd)
+{
+  INTERNAL_CHRTR_HEADER *chrtr = chrtr_handle (hnd);
+
+
+  if (chrtr->map == NULL) return;
+
+#ifdef NVWIN3X
+  UnmapViewOfFile (chrtr->map);
+  CloseHandle (chrtr->map_handle);
+  chrtr->map_handle = NULL;
+#else
+  munmap (chrtr->map, (size_t) chrtr->map_size);
+#endif
+
+  chrtr->map = NULL;
+  chrtr->map_size = 0;
+  chrtr->map_native = NVFalse;
+}
+
+
+
+/*  Block states for the CHRTR writer.  */
+
+#define CHRTR_BLOCK_FREE        0
+#define CHRTR_BLOCK_FILLING     1
+#define CHRTR_BLOCK_QUEUED      2
+#define CHRTR_BLOCK_WRITING     3
+
+
+/*  Default block size in bytes and number of blocks for chrtr_writer_open.  */
+
+#define CHRTR_WRITER_BLOCK_SIZE 4194304
+#define CHRTR_WRITER_BLOCKS     4
+
+
+/*  A block of consecutive rows.  Since the rows are consecutive in the file a full block is written with a
+    single write.  */
+
+typedef struct
+{
+  int32_t       state;                               /*  CHRTR_BLOCK_FREE, _FILLING, _QUEUED, or _WRITING  */
+  int32_t       first_row;                           /*  First row in the block  */
+  int32_t       num_rows;                            /*  Number of rows in the block (the last block may be short)  */
+  int32_t       filled;                              /*  Number of rows that have been put in the block  */
+  int32_t       busy;                                /*  Number of producers copying into the block right now  */
+  int64_t       stamp;                               /*  Last time (put count) the block was used  */
+  uint8_t       *row_done;                           /*  Set for each row that has been put  */
+  float         *data;                               /*  num_rows * width floats  */
+} CHRTR_WRITER_BLOCK;
+
+
+struct CHRTR_WRITER
+{
+  int32_t       hnd;
+  int32_t       block_rows;
+  int32_t       num_blocks;
+  int32_t       width;
+  int64_t       stamp;
+  uint8_t       error;
+  uint8_t       closing;
+  uint8_t       thread_started;
+  CHRTR_WRITER_BLOCK *block;
+  pthread_t     thread;
+  pthread_mutex_t mutex;
+  pthread_cond_t  queued;                            /*  Signaled when a block is queued or we're closing  */
+  pthread_cond_t  freed;                             /*  Signaled when a block is freed or a producer is done copying  */
+};
+
+
+
+/*  Write the rows of a queued block to the file.  Full blocks go out in one write, partial blocks (from
+    chrtr_writer_close or from being evicted) are written one run of filled rows at a time.  */
+
+static uint8_t chrtr_writer_flush_block (CHRTR_WRITER *writer, CHRTR_WRITER_BLOCK *block)
+{
+  int32_t          start, end;
+  int64_t          count;
+  INTERNAL_CHRTR_HEADER *chrtr = chrtr_handle (writer->hnd);
+
+
+  /*  Tiled files are written a row at a time through the tile code (which does its own swapping).  */
+
+  if (chrtr->tiled)
+    {
+      for (start = 0 ; start < block->num_rows ; start++)
+        {
+          if (block->row_done[start] &&
+              !chrtr_tiled_write (chrtr, block->first_row + start, 0, writer->width, block->data + (int64_t) start * writer->width))
+            return (NVFalse);
+        }
+
+      return (NVTrue);
+    }
+
+
+  /*  Convert to the file's byte order in one pass over the whole block.  */
+
+  if (chrtr->swap)
+    {
+      count = (int64_t) block->num_rows * (int64_t) writer->width;
+      swap_float_array (block->data, count);
+    }
+
+
+  for (start = 0 ; start < block->num_rows ; start = end)
+    {
+      if (!block->row_done[start])
+        {
+          end = start + 1;
+          continue;
+        }
+
+      for (end = start + 1 ; end < block->num_rows && block->row_done[end] ; end++);
+
+      if (chrtr_pwrite (chrtr, block->data + (int64_t) start * writer->width, (int64_t) (end - start) * writer->width * sizeof (float),
+                        chrtr_pos (chrtr, block->first_row + start, 0)) < 0) return (NVFalse);
     }
+
+  return (NVTrue);
+}
+
+
+
+/*  Background thread that writes queued blocks.  */
+
+static void *chrtr_writer_thread (void *arg)
+{
+  int32_t          i, oldest;
+  uint8_t          ok;
+  CHRTR_WRITER     *writer = (CHRTR_WRITER *) arg;
+  CHRTR_WRITER_BLOCK *block;
+
+
+  pthread_mutex_lock (&writer->mutex);
+
+  while (1)
+    {
+      /*  Write blocks in the order they were last used.  */
+
+      oldest = -1;
+      for (i = 0 ; i < writer->num_blocks ; i++)
+        {
+          if (writer->block[i].state == CHRTR_BLOCK_QUEUED && (oldest < 0 || writer->block[i].stamp < writer->block[oldest].stamp))
+            oldest = i;
+        }
+
+      if (oldest < 0)
+        {
+          if (writer->closing) break;
+
+          pthread_cond_wait (&writer->queued, &writer->mutex);
+          continue;
+        }
+
+
+      block = &writer->block[oldest];
+      block->state = CHRTR_BLOCK_WRITING;
+
+      pthread_mutex_unlock (&writer->mutex);
+
+      ok = chrtr_writer_flush_block (writer, block);
+
+      pthread_mutex_lock (&writer->mutex);
+
+      if (!ok) writer->error = NVTrue;
+      block->state = CHRTR_BLOCK_FREE;
+      pthread_cond_broadcast (&writer->freed);
+    }
+
+  pthread_mutex_unlock (&writer->mutex);
+
+  return (NULL);
+}
+
+
+
+/********************************************************************/
+/*!
+
+  - Function:    chrtr_writer_open
+
+  - Purpose:     Create a buffered, asynchronous writer for a CHRTR file
+                 that was opened with create_chrtr or open_chrtr.  Rows
+                 are collected into blocks of consecutive rows which are
+                 converted to the file's byte order and written by a
+                 background thread, one write per block.  No more than
+                 num_blocks blocks are ever held in memory; producers
+                 wait for the writer thread when they are all in use.
+                 - Multiple threads may call chrtr_writer_put_row at the
+                   same time as long as each row is only put once.  For
+                   the best results each thread should write its own
+                   range of rows in order.
+                 - Don't use write_chrtr on the same rows while the
+                   writer is open.
+
+  - Date:        10/18/26
+
+  - Arguments:
+                 - hnd            =    The file handle
+                 - block_rows     =    Rows per block (0 for about 4MB
+                                       per block)
+                 - num_blocks     =    Maximum number of blocks in memory
+                                       (0 for the default of 4)
+
+  - Returns:     CHRTR_WRITER *   =    The writer or NULL on error
+
+********************************************************************/
+
+CHRTR_WRITER *chrtr_writer_open (int32_t hnd, int32_t block_rows, int32_t num_blocks)
+{
+  int32_t          i;
+  CHRTR_WRITER     *writer;
+  INTERNAL_CHRTR_HEADER *chrtr = chrtr_handle (hnd);
+
+
+  if (chrtr->fp == NULL || chrtr->header.width <= 0 || chrtr->header.height <= 0) return (NULL);
+
+
+  writer = (CHRTR_WRITER *) calloc (1, sizeof (CHRTR_WRITER));
+  if (writer == NULL)
+    {
+      perror ("Allocating chrtr writer memory");
+      return (NULL);
+    }
+
+  writer->hnd = hnd;
+  writer->width = chrtr->header.width;
+
+  if (block_rows <= 0) block_rows = MAX (1, CHRTR_WRITER_BLOCK_SIZE / (writer->width * (int32_t) sizeof (float)));
+  writer->block_rows = MIN (block_rows, chrtr->header.height);
+
+  writer->num_blocks = num_blocks > 0 ? num_blocks : CHRTR_WRITER_BLOCKS;
+
+
+  writer->block = (CHRTR_WRITER_BLOCK *) calloc (writer->num_blocks, sizeof (CHRTR_WRITER_BLOCK));
+  if (writer->block == NULL)
+    {
+      perror ("Allocating chrtr writer memory");
+      free (writer);
+      return (NULL);
+    }
+
+  for (i = 0 ; i < writer->num_blocks ; i++)
+    {
+      writer->block[i].data = (float *) malloc ((int64_t) writer->block_rows * writer->width * sizeof (float));
+      writer->block[i].row_done = (uint8_t *) malloc (writer->block_rows);
+
+      if (writer->block[i].data == NULL || writer->block[i].row_done == NULL)
+        {
+          perror ("Allocating chrtr writer block memory");
+          for ( ; i >= 0 ; i--)
+            {
+              free (writer->block[i].data);
+              free (writer->block[i].row_done);
+            }
+          free (writer->block);
+          free (writer);
+          return (NULL);
+        }
+    }
+
+
+  pthread_mutex_init (&writer->mutex, NULL);
+  pthread_cond_init (&writer->queued, NULL);
+  pthread_cond_init (&writer->freed, NULL);
+
+  if (pthread_create (&writer->thread, NULL, chrtr_writer_thread, writer))
+    {
+      fprintf (stderr, "Unable to start chrtr writer thread\n");
+      fflush (stderr);
+      writer->error = NVTrue;
+      chrtr_writer_close (writer);
+      return (NULL);
+    }
+
+  writer->thread_started = NVTrue;
+
+  return (writer);
+}
+
+
+
+/********************************************************************/
+/*!
+
+  - Function:    chrtr_writer_put_row
+
+  - Purpose:     Give a complete row to a CHRTR writer.  The data is
+                 copied so the caller may reuse the buffer as soon as
+                 this returns.  The data is in native byte order.
+
+  - Date:        10/18/26
+
+  - Arguments:
+                 - writer         =    The writer
+                 - row            =    The row number
+                 - data           =    Width floats
+
+  - Returns:     uint8_t          =    NVFalse if the row is out of
+                                       range or a write has failed
+
+********************************************************************/
+
+uint8_t chrtr_writer_put_row (CHRTR_WRITER *writer, int32_t row, const float *data)
+{
+  int32_t          i, first_row, oldest, r;
+  CHRTR_WRITER_BLOCK *block = NULL;
+  INTERNAL_CHRTR_HEADER *chrtr = chrtr_handle (writer->hnd);
+
+
+  if (row < 0 || row >= chrtr->header.height) return (NVFalse);
+
+  first_row = row - row % writer->block_rows;
+
+
+  pthread_mutex_lock (&writer->mutex);
+
+  while (block == NULL)
+    {
+      if (writer->error)
+        {
+          pthread_mutex_unlock (&writer->mutex);
+          return (NVFalse);
+        }
+
+
+      /*  Look for the block that holds this row (or a free block).  */
+
+      oldest = -1;
+      for (i = 0 ; i < writer->num_blocks ; i++)
+        {
+          if (writer->block[i].state == CHRTR_BLOCK_FILLING && writer->block[i].first_row == first_row)
+            {
+              block = &writer->block[i];
+              break;
+            }
+
+          if (writer->block[i].state == CHRTR_BLOCK_FREE && oldest < 0) oldest = i;
+        }
+
+      if (block != NULL) break;
+
+
+      if (oldest >= 0)
+        {
+          block = &writer->block[oldest];
+          block->state = CHRTR_BLOCK_FILLING;
+          block->first_row = first_row;
+          block->num_rows = MIN (writer->block_rows, chrtr->header.height - first_row);
+          block->filled = 0;
+          block->busy = 0;
+          memset (block->row_done, 0, block->num_rows);
+          break;
+        }
+
+
+      /*  All of the blocks are in use.  If the writer thread has nothing to do then the producers are filling
+          rows out of order.  In that case we send the least recently used partial block that nobody is copying
+          into off to be written.  Then we wait for a block to be freed.  */
+
+      oldest = -1;
+      for (i = 0 ; i < writer->num_blocks ; i++)
+        {
+          if (writer->block[i].state == CHRTR_BLOCK_QUEUED || writer->block[i].state == CHRTR_BLOCK_WRITING)
+            {
+              oldest = -1;
+              break;
+            }
+
+          if (writer->block[i].state == CHRTR_BLOCK_FILLING && !writer->block[i].busy &&
+              (oldest < 0 || writer->block[i].stamp < writer->block[oldest].stamp)) oldest = i;
+        }
+
+      if (oldest >= 0)
+        {
+          writer->block[oldest].state = CHRTR_BLOCK_QUEUED;
+          pthread_cond_signal (&writer->queued);
+        }
+
+      pthread_cond_wait (&writer->freed, &writer->mutex);
+    }
+
+  block->busy++;
+  block->stamp = writer->stamp++;
+
+  pthread_mutex_unlock (&writer->mutex);
+
+
+  r = row - first_row;
+  memcpy (block->data + (int64_t) r * writer->width, data, writer->width * sizeof (float));
+
+
+  pthread_mutex_lock (&writer->mutex);
+
+  block->busy--;
+
+  if (!block->row_done[r])
+    {
+      block->row_done[r] = NVTrue;
+      block->filled++;
+    }
+
+  if (block->filled == block->num_rows && !block->busy)
+    {
+      block->state = CHRTR_BLOCK_QUEUED;
+      pthread_cond_signal (&writer->queued);
+    }
+
+  pthread_cond_broadcast (&writer->freed);
+
+  pthread_mutex_unlock (&writer->mutex);
+
+  return (NVTrue);
+}
+
+
+
+/********************************************************************/
+/*!
+
+  - Function:    chrtr_writer_close
+
+  - Purpose:     Write anything left in a CHRTR writer, stop the writer
+                 thread, and free the writer.  The CHRTR file itself is
+                 left open.  All producers must be finished before this
+                 is called.
+
+  - Date:        10/18/26
+
+  - Arguments:   writer         -    The writer
+
+  - Returns:     uint8_t        =    NVFalse if any write failed
+
+********************************************************************/
+
+uint8_t chrtr_writer_close (CHRTR_WRITER *writer)
+{
+  int32_t          i;
+  uint8_t          ret;
+
+
+  pthread_mutex_lock (&writer->mutex);
+
+  if (!writer->error)
+    {
+      for (i = 0 ; i < writer->num_blocks ; i++)
+        {
+          if (writer->block[i].state == CHRTR_BLOCK_FILLING) writer->block[i].state = CHRTR_BLOCK_QUEUED;
+        }
+    }
+
+  writer->closing = NVTrue;
+  pthread_cond_signal (&writer->queued);
+
+  pthread_mutex_unlock (&writer->mutex);
+
+  if (writer->thread_started) pthread_join (writer->thread, NULL);
+
+
+  ret = !writer->error;
+
+
+  pthread_mutex_destroy (&writer->mutex);
+  pthread_cond_destroy (&writer->queued);
+  pthread_cond_destroy (&writer->freed);
+
+  for (i = 0 ; i < writer->num_blocks ; i++)
+    {
+      free (writer->block[i].data);
+      free (writer->block[i].row_done);
+    }
+
+  free (writer->block);
+  free (writer);
+
+  return (ret);
 }
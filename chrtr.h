@@ -55,7 +55,17 @@ extern "C" {
 #define CHRTRNULL               10000000000000000.0  /*!<  CHRTR null value  */
 
 
-#define MAX_CHRTR_FILES         32                   /*!<  MAximum number of CHRTR files that may be opened at once  */
+#define CHRTR_TILED_ENDIAN      0x00010204           /*!<  Endian indicator for a tiled CHRTR file in native byte order  */
+#define CHRTR_TILED_SWAPPED     0x04020100           /*!<  Endian indicator for a tiled CHRTR file that must be byte swapped  */
+#define CHRTR_TILE_SIZE         256                  /*!<  Default tile size for create_chrtr_tiled  */
+
+
+#define MAX_CHRTR_FILES         32                   /*!<  Number of CHRTR handles allocated at a time (the handle table grows as needed)  */
+
+
+  /*!  Buffered, asynchronous CHRTR writer (see chrtr_writer_open).  */
+
+  typedef struct CHRTR_WRITER CHRTR_WRITER;
 
 
   typedef struct 
@@ -77,11 +87,19 @@ extern "C" {
   int32_t bit_test (float value, int32_t bit);
   int32_t open_chrtr (const char *path, CHRTR_HEADER *header);
   int32_t create_chrtr (const char *path, CHRTR_HEADER *header);
+  int32_t create_chrtr_tiled (const char *path, CHRTR_HEADER *header, int32_t tile_size);
   void close_chrtr (int32_t hnd);
   uint8_t read_chrtr (int32_t hnd, int32_t row, int32_t start_col, int32_t num_cols, float *data);
   uint8_t write_chrtr (int32_t hnd, int32_t row, int32_t start_col, int32_t num_cols, float *data);
   uint8_t get_chrtr_value (int32_t hnd, double lat, double lon, float *value);
+  uint8_t get_chrtr_values (int32_t hnd, const double *lat, const double *lon, int32_t n, float *out, uint8_t bilinear);
   void dump_chrtr_header (int32_t hnd);
+  uint8_t chrtr_map (int32_t hnd, uint8_t convert);
+  const float *chrtr_map_row (int32_t hnd, int32_t row);
+  void chrtr_unmap (int32_t hnd);
+  CHRTR_WRITER *chrtr_writer_open (int32_t hnd, int32_t block_rows, int32_t num_blocks);
+  uint8_t chrtr_writer_put_row (CHRTR_WRITER *writer, int32_t row, const float *data);
+  uint8_t chrtr_writer_close (CHRTR_WRITER *writer);
 
 
 
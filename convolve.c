@@ -36,8 +36,418 @@
 
 
 
+#include <string.h>
+#include <math.h>
+
+#include "nvdef.h"
+#include "parallel_for.h"
 #include "convolve.h"
 
+
+/*  Runtime selected AVX2/FMA kernels for the direct convolution.  These are only built with GCC compatible
+    compilers on x86 since they rely on the target attribute and __builtin_cpu_supports.  */
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+  #define CONVOLVE_SIMD
+  #include <immintrin.h>
+#endif
+
+
+/*  Smallest overlap-save FFT size.  The FFT size is the smallest power of two that is at least four times the
+    number of taps (so that at least 3/4 of each block is usable output).  */
+
+#define CONVOLVE_MIN_FFT         256
+
+
+/*  Work description for convolve_filter and convolve_filter_f.  Rows are processed as one long run of
+    rows * width samples so that parallel_for can split single long rows (time series) as well as lots of short
+    ones.  */
+
+typedef struct
+{
+  CONVOLVE_FILTER  *cf;
+  const double     *in;
+  double           *out;
+  const float      *in_f;
+  float            *out_f;
+  int32_t          width;
+  int32_t          fma;
+} CONVOLVE_BATCH;
+
+
+
+/*  In place, iterative, radix 2 complex FFT of cf->fft_size interleaved (real, imaginary) values.  Set inverse
+    to use the conjugate twiddle factors (no scaling is done).  */
+
+static void convolve_fft (CONVOLVE_FILTER *cf, double *data, int32_t inverse)
+{
+  int32_t          n = cf->fft_size, i, j, k, len, half, step;
+  double           tr, ti, wr, wi, *a, *b;
+
+
+  for (i = 0 ; i < n ; i++)
+    {
+      j = cf->bitrev[i];
+      if (j > i)
+        {
+          tr = data[2 * i];
+          ti = data[2 * i + 1];
+          data[2 * i] = data[2 * j];
+          data[2 * i + 1] = data[2 * j + 1];
+          data[2 * j] = tr;
+          data[2 * j + 1] = ti;
+        }
+    }
+
+  /*  The first pass has a twiddle factor of 1 so it is done separately.  */
+
+  for (i = 0 ; i < n ; i += 2)
+    {
+      a = &data[2 * i];
+      tr = a[2];
+      ti = a[3];
+      a[2] = a[0] - tr;
+      a[3] = a[1] - ti;
+      a[0] += tr;
+      a[1] += ti;
+    }
+
+  for (len = 4 ; len <= n ; len <<= 1)
+    {
+      half = len >> 1;
+      step = n / len;
+
+      for (k = 0 ; k < half ; k++)
+        {
+          wr = cf->twiddle[2 * k * step];
+          wi = inverse ? -cf->twiddle[2 * k * step + 1] : cf->twiddle[2 * k * step + 1];
+
+          for (i = k ; i < n ; i += len)
+            {
+              a = &data[2 * i];
+              b = &data[2 * (i + half)];
+
+              tr = b[0] * wr - b[1] * wi;
+              ti = b[0] * wi + b[1] * wr;
+
+              b[0] = a[0] - tr;
+              b[1] = a[1] - ti;
+              a[0] += tr;
+              a[1] += ti;
+            }
+        }
+    }
+}
+
+
+
+/*  Direct convolution of outputs start through end - 1 of one row (all in the filtered part of the row).  */
+
+static void convolve_direct (CONVOLVE_FILTER *cf, const double *in, double *out, int32_t start, int32_t end)
+{
+  int32_t          j, k;
+  double           sum;
+  const double     *x;
+
+
+  for (j = start ; j < end ; j++)
+    {
+      x = &in[j - cf->length];
+      sum = 0.0;
+
+      for (k = 0 ; k < cf->taps ; k++) sum += cf->filter[k] * x[k];
+
+      out[j] = sum;
+    }
+}
+
+
+
+static void convolve_direct_f (CONVOLVE_FILTER *cf, const float *in, float *out, int32_t start, int32_t end)
+{
+  int32_t          j, k;
+  float            sum;
+  const float      *x;
+
+
+  for (j = start ; j < end ; j++)
+    {
+      x = &in[j - cf->length];
+      sum = 0.0;
+
+      for (k = 0 ; k < cf->taps ; k++) sum += cf->filter_f[k] * x[k];
+
+      out[j] = sum;
+    }
+}
+
+
+
+#ifdef CONVOLVE_SIMD
+
+/*  convolve_direct 16 (then 4) outputs at a time.  Returns the index of the first output that wasn't done.  */
+
+__attribute__ ((target ("avx2,fma")))
+static int32_t convolve_direct_avx2 (CONVOLVE_FILTER *cf, const double *in, double *out, int32_t start, int32_t end)
+{
+  int32_t          j, k;
+  __m256d          f, acc0, acc1, acc2, acc3;
+  const double     *x;
+
+
+  for (j = start ; j + 16 <= end ; j += 16)
+    {
+      x = &in[j - cf->length];
+      acc0 = acc1 = acc2 = acc3 = _mm256_setzero_pd ();
+
+      for (k = 0 ; k < cf->taps ; k++)
+        {
+          f = _mm256_broadcast_sd (&cf->filter[k]);
+          acc0 = _mm256_fmadd_pd (f, _mm256_loadu_pd (&x[k]), acc0);
+          acc1 = _mm256_fmadd_pd (f, _mm256_loadu_pd (&x[k + 4]), acc1);
+          acc2 = _mm256_fmadd_pd (f, _mm256_loadu_pd (&x[k + 8]), acc2);
+          acc3 = _mm256_fmadd_pd (f, _mm256_loadu_pd (&x[k + 12]), acc3);
+        }
+
+      _mm256_storeu_pd (&out[j], acc0);
+      _mm256_storeu_pd (&out[j + 4], acc1);
+      _mm256_storeu_pd (&out[j + 8], acc2);
+      _mm256_storeu_pd (&out[j + 12], acc3);
+    }
+
+  for ( ; j + 4 <= end ; j += 4)
+    {
+      x = &in[j - cf->length];
+      acc0 = _mm256_setzero_pd ();
+
+      for (k = 0 ; k < cf->taps ; k++) acc0 = _mm256_fmadd_pd (_mm256_broadcast_sd (&cf->filter[k]), _mm256_loadu_pd (&x[k]), acc0);
+
+      _mm256_storeu_pd (&out[j], acc0);
+    }
+
+  return (j);
+}
+
+
+
+/*  convolve_direct_f 32 (then 8) outputs at a time.  Returns the index of the first output that wasn't done.  */
+
+__attribute__ ((target ("avx2,fma")))
+static int32_t convolve_direct_f_avx2 (CONVOLVE_FILTER *cf, const float *in, float *out, int32_t start, int32_t end)
+{
+  int32_t          j, k;
+  __m256           f, acc0, acc1, acc2, acc3;
+  const float      *x;
+
+
+  for (j = start ; j + 32 <= end ; j += 32)
+    {
+      x = &in[j - cf->length];
+      acc0 = acc1 = acc2 = acc3 = _mm256_setzero_ps ();
+
+      for (k = 0 ; k < cf->taps ; k++)
+        {
+          f = _mm256_broadcast_ss (&cf->filter_f[k]);
+          acc0 = _mm256_fmadd_ps (f, _mm256_loadu_ps (&x[k]), acc0);
+          acc1 = _mm256_fmadd_ps (f, _mm256_loadu_ps (&x[k + 8]), acc1);
+          acc2 = _mm256_fmadd_ps (f, _mm256_loadu_ps (&x[k + 16]), acc2);
+          acc3 = _mm256_fmadd_ps (f, _mm256_loadu_ps (&x[k + 24]), acc3);
+        }
+
+      _mm256_storeu_ps (&out[j], acc0);
+      _mm256_storeu_ps (&out[j + 8], acc1);
+      _mm256_storeu_ps (&out[j + 16], acc2);
+      _mm256_storeu_ps (&out[j + 24], acc3);
+    }
+
+  for ( ; j + 8 <= end ; j += 8)
+    {
+      x = &in[j - cf->length];
+      acc0 = _mm256_setzero_ps ();
+
+      for (k = 0 ; k < cf->taps ; k++) acc0 = _mm256_fmadd_ps (_mm256_broadcast_ss (&cf->filter_f[k]), _mm256_loadu_ps (&x[k]), acc0);
+
+      _mm256_storeu_ps (&out[j], acc0);
+    }
+
+  return (j);
+}
+
+#endif
+
+
+
+/*  Overlap-save FFT convolution of outputs start through end - 1 of one row (all in the filtered part of the
+    row).  Either the double (in, out) or float (in_f, out_f) pointers are used.  Since the filter is real we do
+    two blocks at once, one in the real part and one in the imaginary part of the FFT.  The work array must
+    hold 2 * fft_size doubles.  */
+
+static void convolve_fft_range (CONVOLVE_FILTER *cf, const double *in, double *out, const float *in_f, float *out_f,
+                                int32_t width, int32_t start, int32_t end, double *work)
+{
+  int32_t          n = cf->fft_size, step = cf->fft_size - 2 * cf->length, i, j, b, s, o, cnt;
+
+
+  for (o = start ; o < end ; o += 2 * step)
+    {
+      /*  Block b covers outputs o + b * step through o + (b + 1) * step - 1 and needs input starting at
+          o + b * step - length.  Anything past the end of the row is zero (it only affects outputs that we
+          don't keep).  */
+
+      for (b = 0 ; b < 2 ; b++)
+        {
+          s = o + b * step - cf->length;
+
+          for (i = 0 ; i < n ; i++)
+            {
+              j = s + i;
+              work[2 * i + b] = (j < width && o + b * step < end) ? (in != NULL ? in[j] : (double) in_f[j]) : 0.0;
+            }
+        }
+
+      convolve_fft (cf, work, 0);
+
+      for (i = 0 ; i < n ; i++)
+        {
+          work[2 * i] *= cf->spectrum[i];
+          work[2 * i + 1] *= cf->spectrum[i];
+        }
+
+      convolve_fft (cf, work, 1);
+
+      for (b = 0 ; b < 2 ; b++)
+        {
+          s = o + b * step;
+          cnt = MIN (step, end - s);
+
+          for (i = 0 ; i < cnt ; i++)
+            {
+              if (out != NULL)
+                {
+                  out[s + i] = work[2 * (cf->length + i) + b];
+                }
+              else
+                {
+                  out_f[s + i] = (float) work[2 * (cf->length + i) + b];
+                }
+            }
+        }
+    }
+}
+
+
+
+/*  Filter samples start through end - 1 of the rows * width run.  Just like convolve, the first length and the
+    last length + 1 samples of each row are copied unfiltered.  */
+
+static void convolve_filter_chunk (int64_t start, int64_t end, void *arg)
+{
+  CONVOLVE_BATCH   *batch = (CONVOLVE_BATCH *) arg;
+  CONVOLVE_FILTER  *cf = batch->cf;
+  int64_t          row, base;
+  int32_t          width = batch->width, first, last, lo, hi, j;
+  double           *work = NULL;
+  const double     *in = NULL;
+  double           *out = NULL;
+  const float      *in_f = NULL;
+  float            *out_f = NULL;
+
+
+  if (cf->fft_size)
+    {
+      if ((work = (double *) malloc (2 * cf->fft_size * sizeof (double))) == NULL)
+        {
+          perror ("Allocating FFT work memory in convolve.c");
+          exit (-1);
+        }
+    }
+
+
+  /*  Filtered part of each row.  */
+
+  first = cf->length;
+  last = width - cf->length - 1;
+
+  for (row = start / width ; row * width < end ; row++)
+    {
+      base = row * width;
+      lo = (int32_t) (MAX (start, base) - base);
+      hi = (int32_t) (MIN (end, base + width) - base);
+
+      if (batch->in != NULL)
+        {
+          in = &batch->in[base];
+          out = &batch->out[base];
+
+          for (j = lo ; j < MIN (hi, first) ; j++) out[j] = in[j];
+          for (j = MAX (lo, MAX (last, first)) ; j < hi ; j++) out[j] = in[j];
+        }
+      else
+        {
+          in_f = &batch->in_f[base];
+          out_f = &batch->out_f[base];
+
+          for (j = lo ; j < MIN (hi, first) ; j++) out_f[j] = in_f[j];
+          for (j = MAX (lo, MAX (last, first)) ; j < hi ; j++) out_f[j] = in_f[j];
+        }
+
+      lo = MAX (lo, first);
+      hi = MIN (hi, last);
+      if (lo >= hi) continue;
+
+      if (cf->fft_size)
+        {
+          convolve_fft_range (cf, in, out, in_f, out_f, width, lo, hi, work);
+        }
+      else if (batch->in != NULL)
+        {
+#ifdef CONVOLVE_SIMD
+          if (batch->fma) lo = convolve_direct_avx2 (cf, in, out, lo, hi);
+#endif
+          convolve_direct (cf, in, out, lo, hi);
+        }
+      else
+        {
+#ifdef CONVOLVE_SIMD
+          if (batch->fma) lo = convolve_direct_f_avx2 (cf, in_f, out_f, lo, hi);
+#endif
+          convolve_direct_f (cf, in_f, out_f, lo, hi);
+        }
+    }
+
+  free (work);
+}
+
+
+
+static void convolve_filter_run (CONVOLVE_FILTER *cf, const double *in, double *out, const float *in_f, float *out_f,
+                                 int32_t width, int32_t rows)
+{
+  CONVOLVE_BATCH   batch;
+
+
+  if (width <= 0 || rows <= 0) return;
+
+  batch.cf = cf;
+  batch.in = in;
+  batch.out = out;
+  batch.in_f = in_f;
+  batch.out_f = out_f;
+  batch.width = width;
+  batch.fma = 0;
+
+#ifdef CONVOLVE_SIMD
+  batch.fma = __builtin_cpu_supports ("avx2") && __builtin_cpu_supports ("fma");
+#endif
+
+
+  /*  Keep each thread's share worth at least a few million multiply-adds.  */
+
+  parallel_for ((int64_t) rows * width, cf->fft_size ? 65536 : MAX (4194304 / cf->taps, 4096), convolve_filter_chunk, &batch);
+}
+
+
+
 /***************************************************************************/
 /*!
 
@@ -49,13 +459,16 @@
 
   - Purpose:            Convolve one row data with the filter.
                         The filter weights were created using the function
-                        martin.
+                        martin.  If you are going to filter more than one
+                        row with the same weights use create_convolve_filter
+                        and convolve_filter instead.
 
   - Arguments:
                         - indat       =   input row
-                        - outdat      =   output row
+                        - outdat      =   output row (can't be indat)
                         - width       =   row size
                         - length      =   filter length
+                        - weights     =   filter weights from martin
 
   - Return value:       None
 
@@ -63,34 +476,239 @@
 
 void convolve (double *indat, double *outdat, int32_t width, int32_t length, double *weights)
 {
-  int32_t              i, ii, j, k, npts;
-  double               filter[MAX_MARTIN_FILTER_WEIGHTS];
+  CONVOLVE_FILTER      *cf, direct;
+  double               filter[MAX_MARTIN_FILTER_WEIGHTS * 2];
+  int32_t              i;
+
 
-  npts = length + 1;
-  for (i = 0 ; i < npts ; i++)
+  /*  Long filters on long rows are worth setting up the FFT for.  */
+
+  if (2 * length + 1 >= CONVOLVE_FFT_TAPS && width >= 16 * (2 * length + 1) &&
+      (cf = create_convolve_filter (weights, length)) != NULL)
     {
-      filter[i] = weights[length - i];
-      filter[i + length] = weights[i];
+      convolve_filter (cf, indat, outdat, width, 1);
+      free_convolve_filter (cf);
+      return;
+    }
+
+
+  /*  Otherwise just mirror the filter and convolve directly.  */
+
+  memset (&direct, 0, sizeof (CONVOLVE_FILTER));
+  direct.length = length;
+  direct.taps = 2 * length + 1;
+  direct.filter = filter;
+
+  if (length >= MAX_MARTIN_FILTER_WEIGHTS)
+    {
+      if ((direct.filter = (double *) malloc (direct.taps * sizeof (double))) == NULL)
+        {
+          perror ("Allocating filter memory in convolve.c");
+          exit (-1);
+        }
     }
 
+  for (i = 0 ; i <= length ; i++)
+    {
+      direct.filter[i] = weights[length - i];
+      direct.filter[i + length] = weights[i];
+    }
+
+  convolve_filter (&direct, indat, outdat, width, 1);
+
+  if (direct.filter != filter) free (direct.filter);
+}
+
+
+
+/***************************************************************************/
+/*!
+
+  - Module Name:        create_convolve_filter
 
-  /*  Fill borders with original data.    */
+  - Date Written:       October 2026
 
-  for (i = 0 ; i < npts - 1 ; i++) outdat[i] = indat[i];
+  - Purpose:            Prepares a filter for convolve_filter and
+                        convolve_filter_f.  The weights are mirrored into
+                        the full, two sided filter once.  Filters with
+                        fewer than CONVOLVE_FFT_TAPS taps are applied
+                        directly (with AVX2/FMA when the CPU supports it),
+                        longer ones with overlap-save FFT convolution.
 
+  - Arguments:
+                        - weights     =   filter weights (length + 1 of
+                                          them) from martin
+                        - length      =   filter length
 
-  for (i = width - npts ; i < width ; i++) outdat[i] = indat[i];
+  - Return value:
+                        - Prepared filter (free with free_convolve_filter)
+                        - NULL on memory allocation error
+
+****************************************************************************/
+
+CONVOLVE_FILTER *create_convolve_filter (double *weights, int32_t length)
+{
+  CONVOLVE_FILTER      *cf;
+  int32_t              i, j, k, n, bits;
+  double               *work, angle;
 
 
-  for (j = npts - 1 ; j < width - npts ; j++)
+  if (length < 0) return (NULL);
+
+  if ((cf = (CONVOLVE_FILTER *) calloc (1, sizeof (CONVOLVE_FILTER))) == NULL)
     {
-      outdat[j] = 0.0;
-      ii = 0;
+      perror ("Allocating CONVOLVE_FILTER in create_convolve_filter");
+      return (NULL);
+    }
 
-      for (k = j - length ; k <= j + length ; k++)
-        {
-          outdat[j] += (filter[ii] * indat[k]);
-          ii++;
-        }
+  cf->length = length;
+  cf->taps = 2 * length + 1;
+
+  cf->filter = (double *) malloc (cf->taps * sizeof (double));
+  cf->filter_f = (float *) malloc (cf->taps * sizeof (float));
+
+  if (cf->filter == NULL || cf->filter_f == NULL)
+    {
+      perror ("Allocating filter memory in create_convolve_filter");
+      free_convolve_filter (cf);
+      return (NULL);
+    }
+
+  for (i = 0 ; i <= length ; i++)
+    {
+      cf->filter[i] = weights[length - i];
+      cf->filter[i + length] = weights[i];
+    }
+
+  for (i = 0 ; i < cf->taps ; i++) cf->filter_f[i] = (float) cf->filter[i];
+
+  if (cf->taps < CONVOLVE_FFT_TAPS) return (cf);
+
+
+  /*  Set up the FFT.  */
+
+  for (n = CONVOLVE_MIN_FFT, bits = 8 ; n < 4 * cf->taps ; n <<= 1, bits++);
+
+  cf->fft_size = n;
+  cf->spectrum = (double *) malloc (n * sizeof (double));
+  cf->twiddle = (double *) malloc (n * sizeof (double));
+  cf->bitrev = (int32_t *) malloc (n * sizeof (int32_t));
+  work = (double *) calloc (2 * n, sizeof (double));
+
+  if (cf->spectrum == NULL || cf->twiddle == NULL || cf->bitrev == NULL || work == NULL)
+    {
+      perror ("Allocating FFT memory in create_convolve_filter");
+      free (work);
+      free_convolve_filter (cf);
+      return (NULL);
+    }
+
+  for (i = 0 ; i < n / 2 ; i++)
+    {
+      angle = -6.283185307179586 * (double) i / (double) n;
+      cf->twiddle[2 * i] = cos (angle);
+      cf->twiddle[2 * i + 1] = sin (angle);
     }
+
+  for (i = 0 ; i < n ; i++)
+    {
+      for (j = 0, k = 0 ; j < bits ; j++) k |= ((i >> j) & 1) << (bits - 1 - j);
+      cf->bitrev[i] = k;
+    }
+
+
+  /*  Center the filter on sample 0 (wrapping the left half around to the end) so that its spectrum is real.  */
+
+  work[0] = weights[0];
+  for (i = 1 ; i <= length ; i++)
+    {
+      work[2 * i] = weights[i];
+      work[2 * (n - i)] = weights[i];
+    }
+
+  convolve_fft (cf, work, 0);
+
+  for (i = 0 ; i < n ; i++) cf->spectrum[i] = work[2 * i] / (double) n;
+
+  free (work);
+
+  return (cf);
+}
+
+
+
+/***************************************************************************/
+/*!
+
+  - Module Name:        convolve_filter
+
+  - Date Written:       October 2026
+
+  - Purpose:            Convolve one or more rows of data with a filter
+                        from create_convolve_filter.  This gives the same
+                        results as calling convolve on each row (to within
+                        rounding) including copying the first length and
+                        last length + 1 samples of each row unfiltered.
+                        Large jobs are split across threads (see
+                        parallel_for), including single long rows.
+
+  - Arguments:
+                        - cf          =   filter from create_convolve_filter
+                        - indat       =   input rows (rows * width values)
+                        - outdat      =   output rows (can't be indat)
+                        - width       =   row size
+                        - rows        =   number of rows
+
+  - Return value:       None
+
+****************************************************************************/
+
+void convolve_filter (CONVOLVE_FILTER *cf, const double *indat, double *outdat, int32_t width, int32_t rows)
+{
+  convolve_filter_run (cf, indat, outdat, NULL, NULL, width, rows);
+}
+
+
+
+/***************************************************************************/
+/*!
+
+  - Module Name:        convolve_filter_f
+
+  - Date Written:       October 2026
+
+  - Purpose:            Single precision version of convolve_filter.  The
+                        direct convolution is done in single precision, the
+                        FFT convolution in double precision.
+
+  - Arguments:
+                        - cf          =   filter from create_convolve_filter
+                        - indat       =   input rows (rows * width values)
+                        - outdat      =   output rows (can't be indat)
+                        - width       =   row size
+                        - rows        =   number of rows
+
+  - Return value:       None
+
+****************************************************************************/
+
+void convolve_filter_f (CONVOLVE_FILTER *cf, const float *indat, float *outdat, int32_t width, int32_t rows)
+{
+  convolve_filter_run (cf, NULL, NULL, indat, outdat, width, rows);
+}
+
+
+
+/*!  Free a filter from create_convolve_filter.  */
+
+void free_convolve_filter (CONVOLVE_FILTER *cf)
+{
+  if (cf == NULL) return;
+
+  free (cf->filter);
+  free (cf->filter_f);
+  free (cf->spectrum);
+  free (cf->twiddle);
+  free (cf->bitrev);
+  free (cf);
 }
@@ -50,7 +50,32 @@ extern "C" {
 #include "martin.h"
 
 
+  /*!  Filters with at least this many taps (2 * length + 1) are applied with overlap-save FFT convolution
+       instead of directly.  */
+
+#define CONVOLVE_FFT_TAPS        301
+
+
+  /*!  Prepared filter for convolve_filter and convolve_filter_f (see create_convolve_filter).  */
+
+  typedef struct
+  {
+    int32_t       length;                  /*!<  Filter length (the filter has 2 * length + 1 taps)  */
+    int32_t       taps;                    /*!<  Number of taps (2 * length + 1)  */
+    double        *filter;                 /*!<  Two sided (mirrored) filter  */
+    float         *filter_f;               /*!<  Single precision copy of filter  */
+    int32_t       fft_size;                /*!<  Overlap-save FFT size or 0 if we convolve directly  */
+    double        *spectrum;               /*!<  FFT of the centered filter (real since the filter is symmetric), scaled by 1 / fft_size  */
+    double        *twiddle;                /*!<  fft_size / 2 complex FFT twiddle factors  */
+    int32_t       *bitrev;                 /*!<  FFT bit reversal permutation  */
+  } CONVOLVE_FILTER;
+
+
   void convolve (double *indat, double *outdat, int32_t width, int32_t length, double *weights);
+  CONVOLVE_FILTER *create_convolve_filter (double *weights, int32_t length);
+  void convolve_filter (CONVOLVE_FILTER *cf, const double *indat, double *outdat, int32_t width, int32_t rows);
+  void convolve_filter_f (CONVOLVE_FILTER *cf, const float *indat, float *outdat, int32_t width, int32_t rows);
+  void free_convolve_filter (CONVOLVE_FILTER *cf);
 
 
 #ifdef  __cplusplus
@@ -23,6 +23,10 @@
 
 #include "dted.h"
 
+#ifdef __SSE2__
+  #include <emmintrin.h>
+#endif
+
 
 /*  This stuff only works on little endian systems.  */
 
@@ -56,15 +60,14 @@ static double convert_pos (char *string)
 }
 
 
-int32_t read_uhl (FILE *fp, UHL *uhl)
+/*  Parse an 80 byte UHL record.  */
+
+static int32_t parse_uhl (uint8_t *uhl_data, UHL *uhl)
 {
-  uint8_t            uhl_data[80], cut[20];
+  uint8_t            cut[20];
   int32_t            interval[2];
 
 
-  if (!fread (uhl_data, sizeof (uhl_data), 1, fp)) return (-1);
-
-
   strncpy (uhl->sentinel, (char *) &uhl_data[0], 3);
   uhl->sentinel[3] = 0;
 
@@ -102,6 +105,19 @@ int32_t read_uhl (FILE *fp, UHL *uhl)
 }
 
 
+int32_t read_uhl (FILE *fp, UHL *uhl)
+{
+  uint8_t            uhl_data[81];
+
+
+  if (!fread (uhl_data, 80, 1, fp)) return (-1);
+
+  uhl_data[80] = 0;
+
+  return (parse_uhl (uhl_data, uhl));
+}
+
+
 int32_t read_dsi (FILE *fp, DSI *dsi __attribute__ ((unused)))
 {
   uint8_t            dsi_data[648];
@@ -133,7 +149,7 @@ int32_t read_dted_data (FILE *fp, int32_t count, int32_t block, DTED_DATA *dted_
   cpos = 8 + count * 2;
   size = cpos + 4;
 
-  position = 80 + 648 + 2700 + block * size;
+  position = DTED_DATA_OFFSET + block * size;
 
   fseek (fp, position, SEEK_SET);
 
@@ -176,7 +192,7 @@ int32_t read_dted_data (FILE *fp, int32_t count, int32_t block, DTED_DATA *dted_
 }
 
 
-int32_t write_dted_data (FILE *fp, int32_t count, int32_t block, DTED_DATA dted_data)
+int32_t write_dted_data (FILE *fp, int32_t count, int32_t block, DTED_DATA *dted_data)
 {
   uint8_t            data[7214];
   int32_t            i, j, position, cpos, size;
@@ -188,7 +204,7 @@ int32_t write_dted_data (FILE *fp, int32_t count, int32_t block, DTED_DATA dted_
   cpos = 8 + count * 2;
   size = cpos + 4;
 
-  position = 80 + 648 + 2700 + block * size;
+  position = DTED_DATA_OFFSET + block * size;
 
   fseek (fp, position, SEEK_SET);
 
@@ -207,15 +223,15 @@ int32_t write_dted_data (FILE *fp, int32_t count, int32_t block, DTED_DATA dted_
   for (i = 0 ; i < count ; i++)
     {
       j = i * 2 + 8;
-      if (dted_data.elev[i] < 0)
+      if (dted_data->elev[i] < 0)
         {
           sign = 0x80;
-          elev = -dted_data.elev[i];
+          elev = -dted_data->elev[i];
         }
       else
         {
           sign = 0;
-          elev = dted_data.elev[i];
+          elev = dted_data->elev[i];
         }
       data[j] = ((elev & 0xff00) >> 8) | sign;
       data[j + 1] = elev & 0x00ff;
@@ -267,3 +283,201 @@ void dump_acc (ACC acc __attribute__ ((unused)))
 void dump_dted_data (DTED_DATA dted_data __attribute__ ((unused)))
 {
 }
+
+
+/*  Sum the bytes of a DTED data record (the record checksum).  */
+
+static uint32_t dted_byte_sum (const uint8_t *data, int32_t size)
+{
+  int32_t            i = 0;
+  uint32_t           sum = 0;
+
+#ifdef __SSE2__
+  __m128i            zero = _mm_setzero_si128 (), acc = _mm_setzero_si128 ();
+
+  for ( ; i + 16 <= size ; i += 16)
+    acc = _mm_add_epi64 (acc, _mm_sad_epu8 (_mm_loadu_si128 ((const __m128i *) &data[i]), zero));
+
+  sum = (uint32_t) _mm_cvtsi128_si32 (acc) + (uint32_t) _mm_cvtsi128_si32 (_mm_srli_si128 (acc, 8));
+#endif
+
+  for ( ; i < size ; i++) sum += data[i];
+
+  return (sum);
+}
+
+
+
+/*  Convert count big endian, sign-magnitude posts to native int16_t.  */
+
+static void dted_decode_posts (const uint8_t *data, int32_t count, int16_t *elev)
+{
+  int32_t            i = 0;
+  uint16_t           v;
+  int16_t            sign;
+
+#ifdef __SSE2__
+  __m128i            raw, mag, sgn, mask = _mm_set1_epi16 (0x7fff);
+
+  for ( ; i + 8 <= count ; i += 8)
+    {
+      raw = _mm_loadu_si128 ((const __m128i *) &data[i * 2]);
+      raw = _mm_or_si128 (_mm_slli_epi16 (raw, 8), _mm_srli_epi16 (raw, 8));
+      mag = _mm_and_si128 (raw, mask);
+      sgn = _mm_srai_epi16 (raw, 15);
+      _mm_storeu_si128 ((__m128i *) &elev[i], _mm_sub_epi16 (_mm_xor_si128 (mag, sgn), sgn));
+    }
+#endif
+
+  for ( ; i < count ; i++)
+    {
+      v = (data[i * 2] << 8) | data[i * 2 + 1];
+      sign = (v & 0x8000) ? -1 : 0;
+      elev[i] = ((int16_t) (v & 0x7fff) ^ sign) - sign;
+    }
+}
+
+
+
+/***************************************************************************/
+/*!
+
+  - Function:    dted_load_tile
+
+  - Purpose:     Read an entire DTED file (level 0, 1, or 2) with a single
+                 read, check every data record's sentinel and checksum, and
+                 decode all of the posts into a row major grid.  This is
+                 much faster than calling read_dted_data once per
+                 longitude line.
+
+  - Date:        10/18/26
+
+  - Arguments:
+                 - path        =   DTED file name
+                 - uhl         =   Returned UHL record (gives the grid
+                                   origin, spacing, and dimensions)
+                 - grid        =   Returned grid of uhl->num_lat_points rows
+                                   (south to north) by uhl->num_lon_lines
+                                   columns (west to east).  This is allocated
+                                   here and must be freed by the caller.
+
+  - Returns:
+                 - 0 on success
+                 - -1 on open, read, or memory allocation error
+                 - -2 if a data record doesn't start with the sentinel
+                 - -3 on a checksum error
+
+****************************************************************************/
+
+int32_t dted_load_tile (const char *path, UHL *uhl, int16_t **grid)
+{
+  FILE               *fp;
+  uint8_t            *buf, *rec;
+  int16_t            *column, *out;
+  int32_t            i, j, rows, cols, size, cpos, ret = 0;
+  int64_t            file_size;
+
+
+  *grid = NULL;
+
+  if ((fp = fopen64 (path, "rb")) == NULL) return (-1);
+
+
+  fseeko64 (fp, 0, SEEK_END);
+  file_size = ftello64 (fp);
+  fseeko64 (fp, 0, SEEK_SET);
+
+  if (file_size < DTED_DATA_OFFSET)
+    {
+      fclose (fp);
+      return (-1);
+    }
+
+
+  buf = (uint8_t *) malloc (file_size + 1);
+  if (buf == NULL)
+    {
+      perror ("Allocating DTED file memory");
+      fclose (fp);
+      return (-1);
+    }
+
+  if (!fread (buf, file_size, 1, fp))
+    {
+      free (buf);
+      fclose (fp);
+      return (-1);
+    }
+
+  fclose (fp);
+
+
+  /*  The UHL record tells us the size of the grid.  */
+
+  if (parse_uhl (buf, uhl))
+    {
+      free (buf);
+      return (-1);
+    }
+
+  cols = uhl->num_lon_lines;
+  rows = uhl->num_lat_points;
+  cpos = 8 + rows * 2;
+  size = cpos + 4;
+
+  if (rows <= 0 || cols <= 0 || DTED_DATA_OFFSET + (int64_t) cols * size > file_size)
+    {
+      free (buf);
+      return (-1);
+    }
+
+
+  out = (int16_t *) malloc ((int64_t) rows * cols * sizeof (int16_t));
+  column = (int16_t *) malloc (rows * sizeof (int16_t));
+  if (out == NULL || column == NULL)
+    {
+      perror ("Allocating DTED grid memory");
+      free (out);
+      free (column);
+      free (buf);
+      return (-1);
+    }
+
+
+  /*  Each data record is one longitude line from south to north.  */
+
+  for (i = 0 ; i < cols ; i++)
+    {
+      rec = buf + DTED_DATA_OFFSET + (int64_t) i * size;
+
+      if (rec[0] != 0xaa)
+        {
+          ret = -2;
+          break;
+        }
+
+      if (dted_byte_sum (rec, cpos) != (uint32_t) ((rec[cpos] << 24) | (rec[cpos + 1] << 16) | (rec[cpos + 2] << 8) | rec[cpos + 3]))
+        {
+          ret = -3;
+          break;
+        }
+
+      dted_decode_posts (&rec[8], rows, column);
+
+      for (j = 0 ; j < rows ; j++) out[(int64_t) j * cols + i] = column[j];
+    }
+
+
+  free (column);
+  free (buf);
+
+  if (ret)
+    {
+      free (out);
+      return (ret);
+    }
+
+  *grid = out;
+
+  return (0);
+}
@@ -40,6 +40,9 @@ extern "C" {
 #include "nvdef.h"
 
 
+#define DTED_DATA_OFFSET   (80 + 648 + 2700)   /*!<  Offset of the first data record (after the UHL, DSI, and ACC records)  */
+
+
 typedef struct
 {
   char               sentinel[4];
@@ -128,7 +131,8 @@ int32_t read_uhl (FILE *fp, UHL *uhl);
 int32_t read_dsi (FILE *fp, DSI *dsi);
 int32_t read_acc (FILE *fp, ACC *acc);
 int32_t read_dted_data (FILE *fp, int32_t count, int32_t block, DTED_DATA *dted_data);
-int32_t write_dted_data (FILE *fp, int32_t count, int32_t block, DTED_DATA dted_data);
+int32_t write_dted_data (FILE *fp, int32_t count, int32_t block, DTED_DATA *dted_data);
+int32_t dted_load_tile (const char *path, UHL *uhl, int16_t **grid);
 void dump_uhl (UHL uhl);
 void dump_dsi (DSI dsi);
 void dump_acc (ACC acc);
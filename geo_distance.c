@@ -37,6 +37,7 @@
 
 
 #include "geo_distance.h"
+#include "parallel_for.h"
 
 /***************************************************************************/
 /*!
@@ -80,120 +81,172 @@
 
   - Return Value:      NVTrue on success, NVFalse on failure
 
+  - Caveats:           init_geo_distance, geo_distance, and
+                       clean_geo_distance work on a single, default area
+                       and are not thread safe.  To work with more than one
+                       area at a time, or from worker threads, use
+                       geo_distance_create, geo_distance_ctx (or
+                       geo_distance_batch), and geo_distance_free.
+
 ****************************************************************************/
 
-static double                   *geo_dist;
-static double                   *geo_post;
-static double                   l_min_x, l_min_y, l_max_x, l_max_y, x_bin_size_degrees, y_bin_size_degrees, l_bin_size_meters;
-static uint8_t                  geo_dist_init;
+typedef struct
+{
+  GEO_DISTANCE     *ctx;
+  const double     *lat0;
+  const double     *lon0;
+  const double     *lat1;
+  const double     *lon1;
+  double           *distance;
+} GEO_DISTANCE_BATCH;
 
 
-void init_geo_distance (double bin_size_meters, double min_x, double min_y, double max_x, double max_y)
-{
-  int32_t                 i, height;
-  double                  az, x_dist[2], x[2], y[2], mid_lat;
+static GEO_DISTANCE             *default_geo_distance = NULL;
 
 
-  l_min_x = min_x;
-  l_min_y = min_y;
-  l_max_x = max_x;
-  l_max_y = max_y;
-  l_bin_size_meters = bin_size_meters;
 
+/***************************************************************************/
+/*!
 
-  invgp (NV_A0, NV_B0, min_y, min_x, max_y, min_x, &x_dist[0], &az);
+  - Module Name:        geo_distance_create
 
-  height = NINT (x_dist[0] / bin_size_meters);
+  - Date Written:       October 2026
 
-  y_bin_size_degrees = (max_y - min_y) / (double) height;
+  - Purpose:            Pre-computes the X bin sizes for an area (see
+                        geo_distance above).  Each context is independent
+                        so any number of areas can be in use at once and,
+                        once created, a context can be used from any number
+                        of threads.
 
-  mid_lat = min_y + (max_y - min_y) / 2.0;
+  - Arguments:
+                        - bin_size_meters =   bin size in meters
+                        - mbr             =   geographic MBR of the area (X is
+                                              longitude, Y is latitude)
 
-  newgp (mid_lat, min_x, 90.0, bin_size_meters, &y[0], &x[0]);
+  - Return Value:       Pointer to the GEO_DISTANCE context or NULL on
+                        memory allocation failure.  Free it with
+                        geo_distance_free.
 
-  x_bin_size_degrees = x[0] - min_x;
+****************************************************************************/
+
+GEO_DISTANCE *geo_distance_create (double bin_size_meters, NV_F64_XYMBR mbr)
+{
+  GEO_DISTANCE            *ctx;
+  GEODESIC                geo;
+  int32_t                 i;
+  double                  az, x_dist[2], x[2], y[2], mid_lat;
 
 
-  geo_dist = (double *) calloc (height + 2, sizeof (double));
-  if (geo_dist == NULL) 
+  ctx = (GEO_DISTANCE *) calloc (1, sizeof (GEO_DISTANCE));
+  if (ctx == NULL)
     {
-      perror ("Allocating geo_dist array in init_geo_distance");
-      exit (-1);
+      perror ("Allocating GEO_DISTANCE in geo_distance_create");
+      return (NULL);
     }
 
-  geo_post = (double *) calloc (height + 2, sizeof (double));
-  if (geo_post == NULL)
+  ctx->min_x = mbr.min_x;
+  ctx->min_y = mbr.min_y;
+  ctx->max_x = mbr.max_x;
+  ctx->max_y = mbr.max_y;
+  ctx->bin_size_meters = bin_size_meters;
+
+  init_geodesic (&geo, NV_A0, NV_B0);
+
+
+  invgp_geodesic (&geo, mbr.min_y, mbr.min_x, mbr.max_y, mbr.min_x, &x_dist[0], &az);
+
+  ctx->height = NINT (x_dist[0] / bin_size_meters);
+
+  ctx->y_bin_size_degrees = (mbr.max_y - mbr.min_y) / (double) ctx->height;
+
+  mid_lat = mbr.min_y + (mbr.max_y - mbr.min_y) / 2.0;
+
+  newgp (mid_lat, mbr.min_x, 90.0, bin_size_meters, &y[0], &x[0]);
+
+  ctx->x_bin_size_degrees = x[0] - mbr.min_x;
+
+
+  ctx->geo_dist = (double *) calloc (ctx->height + 2, sizeof (double));
+  ctx->geo_post = (double *) calloc (ctx->height + 2, sizeof (double));
+  if (ctx->geo_dist == NULL || ctx->geo_post == NULL)
     {
-      perror ("Allocating geo_dist array in init_geo_distance");
-      exit (-1);
+      perror ("Allocating geo_dist array in geo_distance_create");
+      geo_distance_free (ctx);
+      return (NULL);
     }
 
 
   /*  Get the incremental distances.  Go one extra to cover points on the upper boundary.  */
 
-  for (i = 0 ; i <= height + 1 ; i++)
+  for (i = 0 ; i <= ctx->height + 1 ; i++)
     {
       /*  Get the latitude "post" positions.  */
 
-      geo_post[i] = min_y + (double) i * y_bin_size_degrees;
+      ctx->geo_post[i] = mbr.min_y + (double) i * ctx->y_bin_size_degrees;
 
 
       /*  Compute the actual X bin size at this lat band.  */
 
-      invgp (NV_A0, NV_B0, geo_post[i], min_x, geo_post[i], min_x + x_bin_size_degrees, &geo_dist[i], &az);
+      invgp_geodesic (&geo, ctx->geo_post[i], mbr.min_x, ctx->geo_post[i], mbr.min_x + ctx->x_bin_size_degrees,
+                      &ctx->geo_dist[i], &az);
     }
 
-  geo_dist_init = NVTrue;
+  return (ctx);
 }
 
 
 
-uint8_t geo_distance (double lat0, double lon0, double lat1, double lon1, double *distance)
+/*  geo_distance using the context "ctx" instead of the default area.  */
+
+uint8_t geo_distance_ctx (GEO_DISTANCE *ctx, double lat0, double lon0, double lat1, double lon1, double *distance)
 {
   double                  x_dist[2], x[2], y[2], x_bin_size, next_lat;
   NV_I32_COORD2           coord[2];
 
 
-  if (!geo_dist_init) return (NVFalse);
+  if (ctx == NULL) return (NVFalse);
 
 
   /*  Check the points.  */
 
-  if (lon0 > l_max_x || lon0 < l_min_x || lat0 > l_max_y || lat0 < l_min_y || lon1 > l_max_x || lon1 < l_min_x || lat1 > l_max_y || lat1 < l_min_y)
+  if (lon0 > ctx->max_x || lon0 < ctx->min_x || lat0 > ctx->max_y || lat0 < ctx->min_y || lon1 > ctx->max_x ||
+      lon1 < ctx->min_x || lat1 > ctx->max_y || lat1 < ctx->min_y)
     return (NVFalse);
 
 
   /*  Compute our own indices so we can deal with round-off.  */
 
-  coord[0].x = (int32_t) ((double) (lon0 - l_min_x) / (double) x_bin_size_degrees + 0.05);
-  coord[0].y = (int32_t) ((double) (lat0 - l_min_y) / (double) y_bin_size_degrees + 0.05);
+  coord[0].x = (int32_t) ((double) (lon0 - ctx->min_x) / (double) ctx->x_bin_size_degrees + 0.05);
+  coord[0].y = (int32_t) ((double) (lat0 - ctx->min_y) / (double) ctx->y_bin_size_degrees + 0.05);
 
-  coord[1].x = (int32_t) ((double) (lon1 - l_min_x) / (double) x_bin_size_degrees + 0.05);
-  coord[1].y = (int32_t) ((double) (lat1 - l_min_y) / (double) y_bin_size_degrees + 0.05);
+  coord[1].x = (int32_t) ((double) (lon1 - ctx->min_x) / (double) ctx->x_bin_size_degrees + 0.05);
+  coord[1].y = (int32_t) ((double) (lat1 - ctx->min_y) / (double) ctx->y_bin_size_degrees + 0.05);
 
 
   /*  Get the Y positions in "meters".  */
 
-  y[0] = ((double) coord[0].y + (lat0 - geo_post[coord[0].y]) / y_bin_size_degrees) * l_bin_size_meters;
-  y[1] = ((double) coord[1].y + (lat1 - geo_post[coord[1].y]) / y_bin_size_degrees) * l_bin_size_meters;
+  y[0] = ((double) coord[0].y + (lat0 - ctx->geo_post[coord[0].y]) / ctx->y_bin_size_degrees) * ctx->bin_size_meters;
+  y[1] = ((double) coord[1].y + (lat1 - ctx->geo_post[coord[1].y]) / ctx->y_bin_size_degrees) * ctx->bin_size_meters;
 
 
   /*  Get the X positions in "meters" adjusted for the change in Y.  Interpolating the value between the 
       posts on either side of the lat.  This is probably serious overkill but not too computationally
       taxing.  */
 
-  next_lat = geo_post[coord[0].y] + y_bin_size_degrees;
-  x_dist[0] = geo_dist[coord[0].y] + (geo_dist[coord[0].y + 1] - geo_dist[coord[0].y]) * ((lat0 - geo_post[coord[0].y]) / (next_lat - geo_post[coord[0].y]));
+  next_lat = ctx->geo_post[coord[0].y] + ctx->y_bin_size_degrees;
+  x_dist[0] = ctx->geo_dist[coord[0].y] + (ctx->geo_dist[coord[0].y + 1] - ctx->geo_dist[coord[0].y]) *
+    ((lat0 - ctx->geo_post[coord[0].y]) / (next_lat - ctx->geo_post[coord[0].y]));
 
-  next_lat = geo_post[coord[1].y] + y_bin_size_degrees;
-  x_dist[1] = geo_dist[coord[1].y] + (geo_dist[coord[1].y + 1] - geo_dist[coord[1].y]) * ((lat1 - geo_post[coord[1].y]) / (next_lat - geo_post[coord[1].y]));
+  next_lat = ctx->geo_post[coord[1].y] + ctx->y_bin_size_degrees;
+  x_dist[1] = ctx->geo_dist[coord[1].y] + (ctx->geo_dist[coord[1].y + 1] - ctx->geo_dist[coord[1].y]) *
+    ((lat1 - ctx->geo_post[coord[1].y]) / (next_lat - ctx->geo_post[coord[1].y]));
 
 
   x_bin_size = (x_dist[1] + x_dist[0]) / 2.0;
 
 
-  x[0] = ((lon0 - l_min_x) / x_bin_size_degrees) * x_bin_size;
-  x[1] = ((lon1 - l_min_x) / x_bin_size_degrees) * x_bin_size;
+  x[0] = ((lon0 - ctx->min_x) / ctx->x_bin_size_degrees) * x_bin_size;
+  x[1] = ((lon1 - ctx->min_x) / ctx->x_bin_size_degrees) * x_bin_size;
 
 
   /*  Damn, this looks familiar doesn't it?  I wonder what it is?  */
@@ -206,13 +259,108 @@ uint8_t geo_distance (double lat0, double lon0, double lat1, double lon1, double
 
 
 
-void clean_geo_distance ()
+static void geo_distance_batch_chunk (int64_t start, int64_t end, void *arg)
 {
-  if (!geo_dist_init) return;
+  GEO_DISTANCE_BATCH      *batch = (GEO_DISTANCE_BATCH *) arg;
+  int64_t                 k;
 
-  free (geo_dist);
-  free (geo_post);
 
-  geo_dist_init = NVFalse;
+  for (k = start ; k < end ; k++)
+    {
+      if (!geo_distance_ctx (batch->ctx, batch->lat0[k], batch->lon0[k], batch->lat1[k], batch->lon1[k], &batch->distance[k]))
+        batch->distance[k] = -1.0;
+    }
 }
 
+
+
+/***************************************************************************/
+/*!
+
+  - Module Name:        geo_distance_batch
+
+  - Date Written:       October 2026
+
+  - Purpose:            Runs geo_distance_ctx for arrays of position pairs,
+                        splitting large batches across threads (see
+                        parallel_for).
+
+  - Arguments:
+                        - ctx             =   context from geo_distance_create
+                        - lat0            =   latitudes of the first points
+                        - lon0            =   longitudes of the first points
+                        - lat1            =   latitudes of the second points
+                        - lon1            =   longitudes of the second points
+                        - n               =   number of pairs
+                        - distance        =   returned distances.  Pairs with
+                                              either point outside of the
+                                              area are set to -1.0.
+
+  - Return Value:       None
+
+****************************************************************************/
+
+void geo_distance_batch (GEO_DISTANCE *ctx, const double *lat0, const double *lon0, const double *lat1,
+                         const double *lon1, int64_t n, double *distance)
+{
+  GEO_DISTANCE_BATCH      batch;
+
+
+  if (n <= 0) return;
+
+  batch.ctx = ctx;
+  batch.lat0 = lat0;
+  batch.lon0 = lon0;
+  batch.lat1 = lat1;
+  batch.lon1 = lon1;
+  batch.distance = distance;
+
+  parallel_for (n, 65536, geo_distance_batch_chunk, &batch);
+}
+
+
+
+void geo_distance_free (GEO_DISTANCE *ctx)
+{
+  if (ctx == NULL) return;
+
+  free (ctx->geo_dist);
+  free (ctx->geo_post);
+  free (ctx);
+}
+
+
+
+/*  The original single area interface.  These just manage a default context.  */
+
+void init_geo_distance (double bin_size_meters, double min_x, double min_y, double max_x, double max_y)
+{
+  NV_F64_XYMBR            mbr;
+
+
+  clean_geo_distance ();
+
+  mbr.min_x = min_x;
+  mbr.min_y = min_y;
+  mbr.max_x = max_x;
+  mbr.max_y = max_y;
+
+  default_geo_distance = geo_distance_create (bin_size_meters, mbr);
+  if (default_geo_distance == NULL) exit (-1);
+}
+
+
+
+uint8_t geo_distance (double lat0, double lon0, double lat1, double lon1, double *distance)
+{
+  return (geo_distance_ctx (default_geo_distance, lat0, lon0, lat1, lon1, distance));
+}
+
+
+
+void clean_geo_distance ()
+{
+  geo_distance_free (default_geo_distance);
+
+  default_geo_distance = NULL;
+}
@@ -52,6 +52,28 @@ extern "C" {
 #include "newgp.h"
 
 
+  /*!  Precomputed longitudinal bin sizes for an area.  Create it with geo_distance_create.  */
+
+  typedef struct
+  {
+    double        min_x;                /*!<  Western boundary of the area  */
+    double        min_y;                /*!<  Southern boundary of the area  */
+    double        max_x;                /*!<  Eastern boundary of the area  */
+    double        max_y;                /*!<  Northern boundary of the area  */
+    double        x_bin_size_degrees;   /*!<  X bin size in degrees  */
+    double        y_bin_size_degrees;   /*!<  Y bin size in degrees  */
+    double        bin_size_meters;      /*!<  Bin size in meters  */
+    int32_t       height;               /*!<  Number of latitude bins  */
+    double        *geo_dist;            /*!<  Actual X bin size in meters at each latitude post  */
+    double        *geo_post;            /*!<  Latitude posts  */
+  } GEO_DISTANCE;
+
+
+  GEO_DISTANCE *geo_distance_create (double bin_size_meters, NV_F64_XYMBR mbr);
+  uint8_t geo_distance_ctx (GEO_DISTANCE *ctx, double lat0, double lon0, double lat1, double lon1, double *distance);
+  void geo_distance_batch (GEO_DISTANCE *ctx, const double *lat0, const double *lon0, const double *lat1,
+                           const double *lon1, int64_t n, double *distance);
+  void geo_distance_free (GEO_DISTANCE *ctx);
   void init_geo_distance (double bin_size_meters, double min_x, double min_y, double max_x, double max_y);
   uint8_t geo_distance (double lat0, double lon0, double lat1, double lon1, double *distance);
   void clean_geo_distance ();
@@ -0,0 +1,609 @@
+
+/*********************************************************************************************
+
+    This is public domain software that was developed by or for the U.S. Naval Oceanographic
+    Office and/or the U.S. Army Corps of Engineers.
+
+    This is a work of the U.S. Government. In accordance with 17 USC 105, copyright protection
+    is not available for any work of the U.S. Government.
+
+    Neither the United States Government, nor any employees of the United States Government,
+    nor the author, makes any warranty, express or implied, without even the implied warranty
+    of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE, or assumes any liability or
+    responsibility for the accuracy, completeness, or usefulness of any information,
+    apparatus, product, or process disclosed, or represents that its use would not infringe
+    privately-owned rights. Reference herein to any specific commercial products, process,
+    or service by trade name, trademark, manufacturer, or otherwise, does not necessarily
+    constitute or imply its endorsement, recommendation, or favoring by the United States
+    Government. The views and opinions of authors expressed herein do not necessarily state
+    or reflect those of the United States Government, and shall not be used for advertising
+    or product endorsement purposes.
+*********************************************************************************************/
+
+
+/****************************************  IMPORTANT NOTE  **********************************
+
+    Comments in this file that start with / * ! are being used by Doxygen to document the
+    software.  Dashes in these comment blocks are used to create bullet lists.  The lack of
+    blank lines after a block of dash preceeded comments means that the next block of dash
+    preceeded comments is a new, indented bullet list.  I've tried to keep the Doxygen
+    formatting to a minimum but there are some other items (like <br> and <pre>) that need
+    to be left alone.  If you see a comment that starts with / * ! and there is something
+    that looks a bit weird it is probably due to some arcane Doxygen syntax.  Be very
+    careful modifying blocks of Doxygen comments.
+
+*****************************************  IMPORTANT NOTE  **********************************/
+
+
+
+#include <string.h>
+#include <math.h>
+
+#include "nvdef.h"
+#include "parallel_for.h"
+#include "geo_neighbor.h"
+
+
+typedef struct
+{
+  int64_t          key;
+  int32_t          id;
+} GEO_NEIGHBOR_SORT;
+
+
+typedef struct
+{
+  GEO_NEIGHBOR     *gn;
+  int64_t          *start;
+  int32_t          *ids;
+  double           *dist;
+} GEO_NEIGHBOR_JOIN;
+
+
+
+static int32_t geo_neighbor_compare (const void *a, const void *b)
+{
+  const GEO_NEIGHBOR_SORT *sa = (const GEO_NEIGHBOR_SORT *) a, *sb = (const GEO_NEIGHBOR_SORT *) b;
+
+  if (sa->key != sb->key) return (sa->key < sb->key ? -1 : 1);
+
+  return (sa->id - sb->id);
+}
+
+
+
+static uint32_t geo_neighbor_hash (GEO_NEIGHBOR *gn, int64_t key)
+{
+  return ((uint32_t) (((uint64_t) key * 0x9E3779B97F4A7C15ULL) >> 32) & gn->mask);
+}
+
+
+
+static void geo_neighbor_cell_of (GEO_NEIGHBOR *gn, double lat, double lon, int32_t *row, int32_t *col)
+{
+  double           c, r;
+
+  c = floor ((lon - gn->mbr.min_x) / gn->cell_lon);
+  r = floor ((lat - gn->mbr.min_y) / gn->cell_lat);
+
+  *col = (int32_t) MAX (0.0, MIN (c, (double) (gn->cols - 1)));
+  *row = (int32_t) MAX (0.0, MIN (r, (double) (gn->rows - 1)));
+}
+
+
+
+static GEO_NEIGHBOR_CELL *geo_neighbor_find (GEO_NEIGHBOR *gn, int32_t row, int32_t col)
+{
+  int64_t          key;
+  uint32_t         h;
+
+
+  if (row < 0 || row >= gn->rows || col < 0 || col >= gn->cols) return (NULL);
+
+  key = (int64_t) row * gn->cols + col;
+
+  for (h = geo_neighbor_hash (gn, key) ; gn->cell[h].key != -1 ; h = (h + 1) & gn->mask)
+    {
+      if (gn->cell[h].key == key) return (&gn->cell[h]);
+    }
+
+  return (NULL);
+}
+
+
+
+/***************************************************************************/
+/*!
+
+  - Module Name:        create_geo_neighbor
+
+  - Date Written:       October 2026
+
+  - Purpose:            Builds an index for finding all of the points
+                        within a given distance (in meters) of a position.
+                        Distances are computed with geo_distance_ctx using
+                        a GEO_DISTANCE context that covers the points.  The
+                        points are hashed into cells that are at least
+                        "radius" meters on a side (in the geo_distance
+                        metric) so a radius query only has to look at the
+                        3 by 3 block of cells around the query position.
+                        Only occupied cells are stored so small radii over
+                        large areas don't cost anything extra.
+
+  - Arguments:
+                        - lat              =   latitudes of the points
+                        - lon              =   longitudes of the points
+                        - count            =   number of points
+                        - radius           =   search radius in meters that
+                                               the cells are sized for
+                        - bin_size_meters  =   bin size for the geo_distance
+                                               context (see
+                                               geo_distance_create).  This is
+                                               normally the bin size of the
+                                               grid the points came from.
+
+  - Return Value:       Pointer to the GEO_NEIGHBOR index or NULL on
+                        failure.  Free it with free_geo_neighbor.  IDs
+                        returned by the queries are the positions of the
+                        points in the input arrays.
+
+  - Caveats:            Longitudes must not cross the dateline (the same
+                        restriction as geo_distance).
+
+****************************************************************************/
+
+GEO_NEIGHBOR *create_geo_neighbor (const double *lat, const double *lon, int32_t count, double radius,
+                                   double bin_size_meters)
+{
+  GEO_NEIGHBOR      *gn;
+  GEO_NEIGHBOR_SORT *sort;
+  NV_F64_XYMBR      mbr;
+  double            min_x_meters, cols, rows, max_lat;
+  int32_t           i, j, row, col, unique, size;
+  uint32_t          h;
+
+
+  gn = (GEO_NEIGHBOR *) calloc (1, sizeof (GEO_NEIGHBOR));
+  if (gn == NULL)
+    {
+      perror ("Allocating GEO_NEIGHBOR in create_geo_neighbor");
+      return (NULL);
+    }
+
+  gn->radius = radius;
+  gn->count = MAX (count, 0);
+  if (!gn->count || radius <= 0.0) return (gn);
+
+
+  /*  Point MBR padded by the radius so that any query position that could have a neighbor is inside the
+      geo_distance area.  The padding is deliberately generous.  */
+
+  mbr.min_x = mbr.max_x = lon[0];
+  mbr.min_y = mbr.max_y = lat[0];
+
+  for (i = 1 ; i < count ; i++)
+    {
+      mbr.min_x = MIN (mbr.min_x, lon[i]);
+      mbr.max_x = MAX (mbr.max_x, lon[i]);
+      mbr.min_y = MIN (mbr.min_y, lat[i]);
+      mbr.max_y = MAX (mbr.max_y, lat[i]);
+    }
+
+  mbr.min_y = MAX (mbr.min_y - 1.1 * radius / 110000.0, -89.99);
+  mbr.max_y = MIN (mbr.max_y + 1.1 * radius / 110000.0, 89.99);
+  max_lat = MAX (fabs (mbr.min_y), fabs (mbr.max_y));
+  mbr.min_x -= 1.1 * radius / (111000.0 * cos (max_lat * NV_DEG_TO_RAD));
+  mbr.max_x += 1.1 * radius / (111000.0 * cos (max_lat * NV_DEG_TO_RAD));
+
+  gn->mbr = mbr;
+
+  gn->ctx = geo_distance_create (bin_size_meters, mbr);
+  if (gn->ctx == NULL)
+    {
+      free_geo_neighbor (gn);
+      return (NULL);
+    }
+
+
+  /*  geo_distance never uses an X scale smaller than the smallest post value, so a cell that is "radius" wide
+      at that scale is at least "radius" wide everywhere.  The 1.0001 covers round-off.  */
+
+  min_x_meters = gn->ctx->geo_dist[0];
+  for (i = 1 ; i <= gn->ctx->height + 1 ; i++) min_x_meters = MIN (min_x_meters, gn->ctx->geo_dist[i]);
+
+  gn->cell_lon = radius * 1.0001 * gn->ctx->x_bin_size_degrees / MAX (min_x_meters, 1.0e-6);
+  gn->cell_lat = radius * 1.0001 * gn->ctx->y_bin_size_degrees / gn->ctx->bin_size_meters;
+
+
+  /*  Keep the cell indices sane for tiny radii over huge areas (bigger cells are still correct).  */
+
+  cols = floor ((mbr.max_x - mbr.min_x) / gn->cell_lon) + 1.0;
+  rows = floor ((mbr.max_y - mbr.min_y) / gn->cell_lat) + 1.0;
+
+  if (cols > 1.0e9)
+    {
+      cols = 1.0e9;
+      gn->cell_lon = (mbr.max_x - mbr.min_x) / (cols - 1.0);
+    }
+
+  if (rows > 1.0e9)
+    {
+      rows = 1.0e9;
+      gn->cell_lat = (mbr.max_y - mbr.min_y) / (rows - 1.0);
+    }
+
+  gn->cols = (int32_t) cols;
+  gn->rows = (int32_t) rows;
+
+
+  /*  Sort the points by cell.  */
+
+  sort = (GEO_NEIGHBOR_SORT *) malloc (count * sizeof (GEO_NEIGHBOR_SORT));
+  gn->lat = (double *) malloc (count * sizeof (double));
+  gn->lon = (double *) malloc (count * sizeof (double));
+  gn->id = (int32_t *) malloc (count * sizeof (int32_t));
+  if (sort == NULL || gn->lat == NULL || gn->lon == NULL || gn->id == NULL)
+    {
+      perror ("Allocating point memory in create_geo_neighbor");
+      free (sort);
+      free_geo_neighbor (gn);
+      return (NULL);
+    }
+
+  for (i = 0 ; i < count ; i++)
+    {
+      geo_neighbor_cell_of (gn, lat[i], lon[i], &row, &col);
+      sort[i].key = (int64_t) row * gn->cols + col;
+      sort[i].id = i;
+    }
+
+  qsort (sort, count, sizeof (GEO_NEIGHBOR_SORT), geo_neighbor_compare);
+
+  unique = 0;
+  for (i = 0 ; i < count ; i++)
+    {
+      gn->id[i] = sort[i].id;
+      gn->lat[i] = lat[sort[i].id];
+      gn->lon[i] = lon[sort[i].id];
+
+      if (!i || sort[i].key != sort[i - 1].key) unique++;
+    }
+
+
+  /*  Hash the occupied cells (open addressing, at most half full).  */
+
+  for (size = 16 ; size < 2 * unique ; size *= 2);
+
+  gn->mask = size - 1;
+  gn->cell = (GEO_NEIGHBOR_CELL *) malloc (size * sizeof (GEO_NEIGHBOR_CELL));
+  if (gn->cell == NULL)
+    {
+      perror ("Allocating cell hash in create_geo_neighbor");
+      free (sort);
+      free_geo_neighbor (gn);
+      return (NULL);
+    }
+
+  for (h = 0 ; h < (uint32_t) size ; h++) gn->cell[h].key = -1;
+
+  for (i = 0 ; i < count ; i = j)
+    {
+      for (j = i + 1 ; j < count && sort[j].key == sort[i].key ; j++);
+
+      for (h = geo_neighbor_hash (gn, sort[i].key) ; gn->cell[h].key != -1 ; h = (h + 1) & gn->mask);
+
+      gn->cell[h].key = sort[i].key;
+      gn->cell[h].start = i;
+      gn->cell[h].count = j - i;
+    }
+
+  free (sort);
+
+  return (gn);
+}
+
+
+
+/*  Finds every point within "radius" of (lat, lon) except the one at position "skip" (-1 to keep them all).  If
+    ids is NULL we just count.  */
+
+static int32_t geo_neighbor_scan (GEO_NEIGHBOR *gn, double lat, double lon, double radius, int32_t skip, int32_t *ids,
+                                  double *dist, int32_t max_ids)
+{
+  GEO_NEIGHBOR_CELL *cell;
+  int32_t           row, col, r, c, k, n, found = 0;
+  double            d;
+
+
+  if (!gn->count || gn->ctx == NULL) return (0);
+
+  if (lon < gn->mbr.min_x || lon > gn->mbr.max_x || lat < gn->mbr.min_y || lat > gn->mbr.max_y) return (0);
+
+  n = (int32_t) ceil (radius / gn->radius);
+  n = MAX (n, 1);
+
+  geo_neighbor_cell_of (gn, lat, lon, &row, &col);
+
+  for (r = row - n ; r <= row + n ; r++)
+    {
+      for (c = col - n ; c <= col + n ; c++)
+        {
+          if ((cell = geo_neighbor_find (gn, r, c)) == NULL) continue;
+
+          for (k = cell->start ; k < cell->start + cell->count ; k++)
+            {
+              if (k == skip) continue;
+
+              if (geo_distance_ctx (gn->ctx, lat, lon, gn->lat[k], gn->lon[k], &d) && d <= radius)
+                {
+                  if (ids != NULL && found < max_ids)
+                    {
+                      ids[found] = gn->id[k];
+                      if (dist != NULL) dist[found] = d;
+                    }
+                  found++;
+                }
+            }
+        }
+    }
+
+  return (found);
+}
+
+
+
+/***************************************************************************/
+/*!
+
+  - Module Name:        geo_neighbor_radius_query
+
+  - Date Written:       October 2026
+
+  - Purpose:            Finds every point in the index within "radius"
+                        meters of a position.  Any radius works but radii
+                        larger than the one the index was built with have
+                        to look at more cells.
+
+  - Arguments:
+                        - gn       =   GEO_NEIGHBOR index
+                        - lat      =   latitude of the position
+                        - lon      =   longitude of the position
+                        - radius   =   search radius in meters
+                        - ids      =   returned point IDs (in no particular
+                                       order)
+                        - dist     =   returned distances in meters (may be
+                                       NULL)
+                        - max_ids  =   size of the ids and dist arrays
+
+  - Return Value:       Number of points within the radius.  If this is
+                        larger than max_ids only the first max_ids were
+                        stored.
+
+****************************************************************************/
+
+int32_t geo_neighbor_radius_query (GEO_NEIGHBOR *gn, double lat, double lon, double radius, int32_t *ids,
+                                   double *dist, int32_t max_ids)
+{
+  return (geo_neighbor_scan (gn, lat, lon, radius, -1, ids, dist, max_ids));
+}
+
+
+
+/***************************************************************************/
+/*!
+
+  - Module Name:        geo_neighbor_knn_query
+
+  - Date Written:       October 2026
+
+  - Purpose:            Finds the k points in the index that are nearest to
+                        a position.  Cells are searched in rings around the
+                        position until nothing farther out can be closer
+                        than the k'th point found so far.  This is fast
+                        when the neighbors are within a few index radii of
+                        the position.
+
+  - Arguments:
+                        - gn       =   GEO_NEIGHBOR index
+                        - lat      =   latitude of the position (must be
+                                       inside the area covered by the
+                                       index)
+                        - lon      =   longitude of the position
+                        - k        =   number of neighbors wanted
+                        - ids      =   returned point IDs, nearest first
+                        - dist     =   returned distances in meters (k
+                                       elements)
+
+  - Return Value:       Number of neighbors found (k unless there are fewer
+                        than k points in the index)
+
+****************************************************************************/
+
+int32_t geo_neighbor_knn_query (GEO_NEIGHBOR *gn, double lat, double lon, int32_t k, int32_t *ids, double *dist)
+{
+  GEO_NEIGHBOR_CELL *cell;
+  int32_t           row, col, ring, max_ring, r, c, step, p, i, found = 0, seen = 0;
+  double            d;
+
+
+  if (!gn->count || gn->ctx == NULL || k <= 0) return (0);
+
+  if (lon < gn->mbr.min_x || lon > gn->mbr.max_x || lat < gn->mbr.min_y || lat > gn->mbr.max_y) return (0);
+
+  k = MIN (k, gn->count);
+
+  geo_neighbor_cell_of (gn, lat, lon, &row, &col);
+
+  max_ring = MAX (MAX (row, gn->rows - 1 - row), MAX (col, gn->cols - 1 - col));
+
+  for (ring = 0 ; ring <= max_ring ; ring++)
+    {
+      for (r = MAX (row - ring, 0) ; r <= MIN (row + ring, gn->rows - 1) ; r++)
+        {
+          /*  Only the edges of the ring, except for the top and bottom rows.  */
+
+          step = (r == row - ring || r == row + ring) ? 1 : MAX (2 * ring, 1);
+
+          for (c = col - ring ; c <= col + ring ; c += step)
+            {
+              if ((cell = geo_neighbor_find (gn, r, c)) == NULL) continue;
+
+              seen += cell->count;
+
+              for (p = cell->start ; p < cell->start + cell->count ; p++)
+                {
+                  if (!geo_distance_ctx (gn->ctx, lat, lon, gn->lat[p], gn->lon[p], &d)) continue;
+
+                  if (found == k && d >= dist[k - 1]) continue;
+
+
+                  /*  Insertion into the sorted list.  */
+
+                  i = (found < k) ? found++ : k - 1;
+                  for ( ; i > 0 && dist[i - 1] > d ; i--)
+                    {
+                      dist[i] = dist[i - 1];
+                      ids[i] = ids[i - 1];
+                    }
+                  dist[i] = d;
+                  ids[i] = gn->id[p];
+                }
+            }
+        }
+
+
+      /*  Anything outside this ring is at least ring * radius away.  */
+
+      if (found == k && (dist[k - 1] <= (double) ring * gn->radius || seen == gn->count)) break;
+    }
+
+  return (found);
+}
+
+
+
+static void geo_neighbor_count_chunk (int64_t start, int64_t end, void *arg)
+{
+  GEO_NEIGHBOR_JOIN *join = (GEO_NEIGHBOR_JOIN *) arg;
+  GEO_NEIGHBOR      *gn = join->gn;
+  int64_t           p;
+
+
+  for (p = start ; p < end ; p++)
+    {
+      join->start[gn->id[p] + 1] = geo_neighbor_scan (gn, gn->lat[p], gn->lon[p], gn->radius, (int32_t) p, NULL, NULL, 0);
+    }
+}
+
+
+
+static void geo_neighbor_fill_chunk (int64_t start, int64_t end, void *arg)
+{
+  GEO_NEIGHBOR_JOIN *join = (GEO_NEIGHBOR_JOIN *) arg;
+  GEO_NEIGHBOR      *gn = join->gn;
+  int64_t           p, s;
+
+
+  for (p = start ; p < end ; p++)
+    {
+      s = join->start[gn->id[p]];
+
+      geo_neighbor_scan (gn, gn->lat[p], gn->lon[p], gn->radius, (int32_t) p, &join->ids[s],
+                         join->dist != NULL ? &join->dist[s] : NULL, (int32_t) (join->start[gn->id[p] + 1] - s));
+    }
+}
+
+
+
+/***************************************************************************/
+/*!
+
+  - Module Name:        geo_neighbor_join
+
+  - Date Written:       October 2026
+
+  - Purpose:            Finds, for every point in the index, all of the
+                        other points within the index radius.  The work is
+                        split across threads (see parallel_for).  The
+                        neighbors of point i are (*ids)[start[i]] through
+                        (*ids)[start[i + 1] - 1].
+
+  - Arguments:
+                        - gn       =   GEO_NEIGHBOR index
+                        - start    =   count + 1 element array that will hold
+                                       the offset of each point's neighbors
+                        - ids      =   returned, allocated array of neighbor
+                                       IDs.  The caller must free it.
+                        - dist     =   returned, allocated array of neighbor
+                                       distances in meters.  The caller must
+                                       free it.  Pass NULL if they aren't
+                                       needed.
+
+  - Return Value:       Total number of neighbors (each pair is counted
+                        twice) or -1 on memory allocation failure
+
+****************************************************************************/
+
+int64_t geo_neighbor_join (GEO_NEIGHBOR *gn, int64_t *start, int32_t **ids, double **dist)
+{
+  GEO_NEIGHBOR_JOIN join;
+  int32_t           i;
+
+
+  *ids = NULL;
+  if (dist != NULL) *dist = NULL;
+
+  start[0] = 0;
+  if (!gn->count) return (0);
+
+  join.gn = gn;
+  join.start = start;
+  join.dist = NULL;
+
+
+  /*  Count each point's neighbors, then fill them in.  Points are visited in cell order so that neighboring
+      queries hit the same cells.  */
+
+  parallel_for (gn->count, 1024, geo_neighbor_count_chunk, &join);
+
+  for (i = 0 ; i < gn->count ; i++) start[i + 1] += start[i];
+
+  join.ids = (int32_t *) malloc (MAX (start[gn->count], 1) * sizeof (int32_t));
+  if (join.ids == NULL)
+    {
+      perror ("Allocating ids in geo_neighbor_join");
+      return (-1);
+    }
+
+  if (dist != NULL)
+    {
+      join.dist = (double *) malloc (MAX (start[gn->count], 1) * sizeof (double));
+      if (join.dist == NULL)
+        {
+          perror ("Allocating dist in geo_neighbor_join");
+          free (join.ids);
+          return (-1);
+        }
+    }
+
+  parallel_for (gn->count, 1024, geo_neighbor_fill_chunk, &join);
+
+  *ids = join.ids;
+  if (dist != NULL) *dist = join.dist;
+
+  return (start[gn->count]);
+}
+
+
+
+void free_geo_neighbor (GEO_NEIGHBOR *gn)
+{
+  if (gn == NULL) return;
+
+  geo_distance_free (gn->ctx);
+  free (gn->lat);
+  free (gn->lon);
+  free (gn->id);
+  free (gn->cell);
+  free (gn);
+}
@@ -0,0 +1,96 @@
+
+/*********************************************************************************************
+
+    This is public domain software that was developed by or for the U.S. Naval Oceanographic
+    Office and/or the U.S. Army Corps of Engineers.
+
+    This is a work of the U.S. Government. In accordance with 17 USC 105, copyright protection
+    is not available for any work of the U.S. Government.
+
+    Neither the United States Government, nor any employees of the United States Government,
+    nor the author, makes any warranty, express or implied, without even the implied warranty
+    of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE, or assumes any liability or
+    responsibility for the accuracy, completeness, or usefulness of any information,
+    apparatus, product, or process disclosed, or represents that its use would not infringe
+    privately-owned rights. Reference herein to any specific commercial products, process,
+    or service by trade name, trademark, manufacturer, or otherwise, does not necessarily
+    constitute or imply its endorsement, recommendation, or favoring by the United States
+    Government. The views and opinions of authors expressed herein do not necessarily state
+    or reflect those of the United States Government, and shall not be used for advertising
+    or product endorsement purposes.
+*********************************************************************************************/
+
+
+/****************************************  IMPORTANT NOTE  **********************************
+
+    Comments in this file that start with / * ! are being used by Doxygen to document the
+    software.  Dashes in these comment blocks are used to create bullet lists.  The lack of
+    blank lines after a block of dash preceeded comments means that the next block of dash
+    preceeded comments is a new, indented bullet list.  I've tried to keep the Doxygen
+    formatting to a minimum but there are some other items (like <br> and <pre>) that need
+    to be left alone.  If you see a comment that starts with / * ! and there is something
+    that looks a bit weird it is probably due to some arcane Doxygen syntax.  Be very
+    careful modifying blocks of Doxygen comments.
+
+*****************************************  IMPORTANT NOTE  **********************************/
+
+
+
+#ifndef _GEO_NEIGHBOR_H_
+#define _GEO_NEIGHBOR_H_
+
+#ifdef  __cplusplus
+extern "C" {
+#endif
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "pfm_nvtypes.h"
+#include "geo_distance.h"
+
+
+  /*!  One occupied cell of the GEO_NEIGHBOR spatial hash.  */
+
+  typedef struct
+  {
+    int64_t       key;          /*!<  row * cols + col, -1 if the slot is empty  */
+    int32_t       start;        /*!<  Index of the first point in the cell  */
+    int32_t       count;        /*!<  Number of points in the cell  */
+  } GEO_NEIGHBOR_CELL;
+
+
+  /*!  Fixed radius neighbor index over geographic points.  See create_geo_neighbor in geo_neighbor.c.  */
+
+  typedef struct
+  {
+    GEO_DISTANCE      *ctx;     /*!<  geo_distance context covering the points (plus the radius)  */
+    double            radius;   /*!<  Radius (meters) that the cells were sized for  */
+    int32_t           count;    /*!<  Number of points  */
+    double            *lat;     /*!<  Latitudes in cell order  */
+    double            *lon;     /*!<  Longitudes in cell order  */
+    int32_t           *id;      /*!<  Original index of each point in cell order  */
+    NV_F64_XYMBR      mbr;      /*!<  Area covered by the cells (X is longitude, Y is latitude)  */
+    double            cell_lon; /*!<  Cell width in degrees  */
+    double            cell_lat; /*!<  Cell height in degrees  */
+    int32_t           cols;     /*!<  Number of cell columns  */
+    int32_t           rows;     /*!<  Number of cell rows  */
+    uint32_t          mask;     /*!<  Hash table size - 1  */
+    GEO_NEIGHBOR_CELL *cell;    /*!<  Hash table of occupied cells  */
+  } GEO_NEIGHBOR;
+
+
+  GEO_NEIGHBOR *create_geo_neighbor (const double *lat, const double *lon, int32_t count, double radius,
+                                     double bin_size_meters);
+  int32_t geo_neighbor_radius_query (GEO_NEIGHBOR *gn, double lat, double lon, double radius, int32_t *ids,
+                                     double *dist, int32_t max_ids);
+  int32_t geo_neighbor_knn_query (GEO_NEIGHBOR *gn, double lat, double lon, int32_t k, int32_t *ids, double *dist);
+  int64_t geo_neighbor_join (GEO_NEIGHBOR *gn, int64_t *start, int32_t **ids, double **dist);
+  void free_geo_neighbor (GEO_NEIGHBOR *gn);
+
+
+#ifdef  __cplusplus
+}
+#endif
+
+#endif
@@ -36,174 +36,496 @@
 
 
 
+#include <sys/stat.h>
+#include <time.h>
+#include <pthread.h>
+
+#include "nvdef.h"
 #include "get_area_mbr.h"
 
 
-/*!  Get an NV_F64_XYMBR from the supplied area file (path) and return in polygon X and Y arrays.  Area file may be .ARE, .are, or .afs.  */
+/*  Parsed area files are kept in a small, process wide cache keyed by path, size, and modification time.  A lot
+    of programs read the same area file over and over so after the first read it only costs us a stat call.
+    The modification time is only good to a second so a file that was modified in the same second that we looked
+    at it isn't cached (it could be rewritten with the same size and time after we read it).  */
 
-uint8_t get_area_mbr (const char *path, int32_t *polygon_count, double *polygon_x, double *polygon_y, NV_F64_XYMBR *mbr)
+#define AREA_CACHE_SIZE         16
+
+
+typedef struct
+{
+  char          *path;                               /*  Area file name or NULL if the slot is empty  */
+  int64_t       size;                                /*  File size when it was read  */
+  int64_t       mtime;                               /*  File modification time (seconds)  */
+  int32_t       count;                               /*  Number of polygon points  */
+  double        *x;                                  /*  Polygon X (longitude) values  */
+  double        *y;                                  /*  Polygon Y (latitude) values  */
+  NV_F64_XYMBR  mbr;                                 /*  Polygon MBR  */
+  int64_t       stamp;                               /*  Last time the entry was used  */
+} AREA_CACHE;
+
+
+/*  Growable point list used while parsing.  */
+
+typedef struct
 {
-  char                    string[256], tmp[256], lat_hemi, lon_hemi;
-  FILE                    *area_fp = NULL;
-  int32_t                 i, k, j, lat_deg, lat_min, lon_deg, lon_min, numShapes, type;
-  float                   lat_sec, lon_sec;
-  double                  minBounds[4], maxBounds[4];
-  uint8_t                 west = NVFalse, east = NVFalse;
-  SHPHandle               shpHandle;
-  SHPObject               *shape = NULL;
+  int32_t       count;
+  int32_t       size;
+  double        *x;
+  double        *y;
+} AREA_POINTS;
+
+
+static AREA_CACHE area_cache[AREA_CACHE_SIZE];
+static int64_t area_stamp = 0;
+static pthread_mutex_t area_mutex = PTHREAD_MUTEX_INITIALIZER;
 
 
-  /*  Don't open the file if it is a shape file.  */
+static const double area_pow10[23] = {1.0e0, 1.0e1, 1.0e2, 1.0e3, 1.0e4, 1.0e5, 1.0e6, 1.0e7, 1.0e8, 1.0e9, 1.0e10,
+                                      1.0e11, 1.0e12, 1.0e13, 1.0e14, 1.0e15, 1.0e16, 1.0e17, 1.0e18, 1.0e19, 1.0e20,
+                                      1.0e21, 1.0e22};
 
-  if (strcmp (&path[strlen (path) - 4], ".shp"))
+
+
+static uint8_t area_add_point (AREA_POINTS *pts, double x, double y)
+{
+  double            *new_x, *new_y;
+  int32_t           size;
+
+
+  if (pts->count == pts->size)
     {
-      if ((area_fp = fopen (path, "r")) == NULL)
+      size = pts->size ? pts->size * 2 : 1024;
+
+      if ((new_x = (double *) realloc (pts->x, size * sizeof (double))) == NULL)
         {
-          perror (path);
+          perror ("Allocating polygon_x in get_area_mbr.c");
           return (NVFalse);
         }
+      pts->x = new_x;
+
+      if ((new_y = (double *) realloc (pts->y, size * sizeof (double))) == NULL)
+        {
+          perror ("Allocating polygon_y in get_area_mbr.c");
+          return (NVFalse);
+        }
+      pts->y = new_y;
+
+      pts->size = size;
     }
 
+  pts->x[pts->count] = x;
+  pts->y[pts->count] = y;
+  pts->count++;
+
+  return (NVTrue);
+}
+
+
+
+static void area_free_points (AREA_POINTS *pts)
+{
+  free (pts->x);
+  free (pts->y);
+  memset (pts, 0, sizeof (AREA_POINTS));
+}
+
 
-  *polygon_count = 0;
 
+/*  Scan a number starting at *ptr (leading white space is skipped) and move *ptr past it.  Plain decimal numbers
+    with up to 19 digits are converted by hand (the mantissa and the power of ten are both exact so the division
+    is correctly rounded), anything else goes to strtod.  Either way the result is exactly what sscanf's %lf would
+    have given us.  Returns NVFalse if there is no number at *ptr.  */
+
+static uint8_t area_scan_number (char **ptr, double *value)
+{
+  char              *p = *ptr, *start, *end;
+  uint64_t          mant = 0;
+  int32_t           digits = 0, frac = 0;
+  uint8_t           neg = NVFalse;
 
-  /*  ISS-60 format area file.  */
 
-  if (!strcmp (&path[strlen (path) - 4], ".ARE"))
+  while (*p == ' ' || *p == '\t' || *p == '\r' || *p == '\n' || *p == '\v' || *p == '\f') p++;
+
+  start = p;
+
+  if (*p == '-' || *p == '+')
     {
-      while (fgets (string, sizeof (string), area_fp) != NULL)
-        {
-          if (!strncmp (string, "POINT=", 6))
-            {
-              strtok (string, ";");
-              strcpy (tmp, strtok (NULL, ";"));
-              posfix (tmp, &polygon_y[*polygon_count], POS_LAT);
-              strcpy (tmp, strtok (NULL, ";"));
-              posfix (tmp, &polygon_x[*polygon_count], POS_LON);
+      neg = (*p == '-');
+      p++;
+    }
 
-              (*polygon_count)++;
-            }
-        }
+  for ( ; *p >= '0' && *p <= '9' ; p++, digits++) if (digits < 19) mant = mant * 10 + (*p - '0');
+
+  if (*p == '.')
+    {
+      for (p++ ; *p >= '0' && *p <= '9' ; p++, digits++, frac++) if (digits < 19) mant = mant * 10 + (*p - '0');
     }
 
 
-  /*  Polygon list format area file.  */
+  /*  Exponents, hex, inf, nan, too many digits, or no digits at all.  */
 
-  else if (!strcmp (&path[strlen (path) - 4], ".are"))
+  if (!digits || digits > 19 || frac > 22 || mant > ((uint64_t) 1 << 53) || (*p >= 'a' && *p <= 'z') ||
+      (*p >= 'A' && *p <= 'Z'))
     {
-      while (fget_coord (area_fp, &lat_hemi, &lat_deg, &lat_min, &lat_sec, 
-                         &lon_hemi, &lon_deg, &lon_min, &lon_sec))
-        {
-          polygon_y[*polygon_count] = (double) lat_deg + (double) lat_min / 60.0 + 
-            (double) lat_sec / 3600.0;
-          if (lat_hemi == 'S') polygon_y[*polygon_count] = -polygon_y[*polygon_count];
-
-          polygon_x[*polygon_count] = (double) lon_deg + (double) lon_min / 60.0 +
-            (double) lon_sec / 3600.0;
-          if (lon_hemi == 'W') polygon_x[*polygon_count] = -polygon_x[*polygon_count];
+      *value = strtod (start, &end);
+      if (end == start) return (NVFalse);
 
-          (*polygon_count)++;
-        }
+      *ptr = end;
+      return (NVTrue);
     }
 
+  *value = (double) mant;
+  if (frac) *value /= area_pow10[frac];
+  if (neg) *value = -*value;
+
+  *ptr = p;
 
-  /*  Army Corps area file.  */
+  return (NVTrue);
+}
+
+
+
+/*  Convert a latitude (type = POS_LAT) or longitude (type = POS_LON) field to unsigned degrees the same way
+    posfix and fget_coord do.  The field is modified (hemisphere and sign characters are blanked).  */
 
-  else if (!strcmp (&path[strlen (path) - 4], ".afs"))
+static double area_degrees (char *string, int32_t type, uint8_t *sign)
+{
+  char              *p;
+  double            f[3] = {0.0, 0.0, 0.0}, fdeg = 0.0, fmin = 0.0, fsec = 0.0;
+  int32_t           i;
+
+
+  *sign = NVFalse;
+  for (p = string ; *p ; p++)
     {
-      while (fgets (string, sizeof (string), area_fp) != NULL)
+      if (type)
+        {
+          if (*p == 'W' || *p == 'w' || *p == '-')
+            {
+              *p = ' ';
+              *sign = NVTrue;
+            }
+        }
+      else
         {
-	  if (strchr (string, ','))
-	    {
-	      sscanf (string, "%lf,%lf", &polygon_x[*polygon_count], &polygon_y[*polygon_count]);
-	    }
-	  else
-	    {
-	      sscanf (string, "%lf %lf", &polygon_x[*polygon_count], &polygon_y[*polygon_count]);
-	    }
-
-          (*polygon_count)++;
+          if (*p == 'S' || *p == 's' || *p == '-')
+            {
+              *p = ' ';
+              *sign = NVTrue;
+            }
         }
+
+      if (*p == 'n' || *p == 'N' || *p == 'e' || *p == 'E' || *p == '+') *p = ' ';
     }
 
 
-  /*  Shape file.  */
+  p = string;
+  for (i = 0 ; i < 3 ; i++) if (!area_scan_number (&p, &f[i])) break;
 
-  else if (!strcmp (&path[strlen (path) - 4], ".shp"))
+  switch (i)
     {
-      //  Open shape file
+    case 3:
+      fsec = f[2] / 3600.0;
+#ifdef NVLinux
+      __attribute__ ((fallthrough));
+#endif
+
+    case 2:
+      fmin = f[1] / 60.0;
+#ifdef NVLinux
+      __attribute__ ((fallthrough));
+#endif
+
+    case 1:
+      fdeg = f[0];
+      break;
+    }
 
-      shpHandle = SHPOpen (path, "rb");
+  fdeg += fmin + fsec;
 
-      if (shpHandle != NULL)
-        {
-          //  Get shape file header info
+  return (fdeg);
+}
+
+
+
+/*  Same as posfix.  */
+
+static double area_posfix (char *string, int32_t type)
+{
+  double            degs;
+  uint8_t           sign;
+
+
+  degs = area_degrees (string, type, &sign);
+  if (sign) degs = -degs;
+
+  return (degs);
+}
+
+
+
+/*  Same as fget_coord followed by the degrees, minutes, seconds to degrees conversion we used to do for .are
+    files (including the trip through float seconds so that we get exactly the same positions as before).  */
+
+static double area_fget_coord (char *string, int32_t type)
+{
+  int32_t           deg, min;
+  float             sec;
+  double            fdeg, fmin, degs;
+  uint8_t           sign;
+
+
+  fdeg = area_degrees (string, type, &sign);
+
+  deg = (int32_t) fdeg;
+  fmin = (fdeg - deg) * 60.0;
+  min = (int32_t) (fmin + 0.00001);
+  sec = (fmin - min) * 60.0 + 0.00001;
+
+  degs = (double) deg + (double) min / 60.0 + (double) sec / 3600.0;
+  if (sign) degs = -degs;
+
+  return (degs);
+}
+
+
+
+/*  Same as strtok with a single delimiter but with the position kept in *ptr.  */
+
+static char *area_token (char **ptr, char delim)
+{
+  char              *p = *ptr, *token;
+
+
+  while (*p == delim) p++;
+  if (!*p) return (NULL);
 
-          SHPGetInfo (shpHandle, &numShapes, &type, minBounds, maxBounds);
+  token = p;
+  while (*p && *p != delim) p++;
+  if (*p) *p++ = 0;
 
+  *ptr = p;
+
+  return (token);
+}
+
+
+
+/*  Parse an .ARE, .are, or .afs area file.  The whole file is read in one shot and parsed in place, one line at
+    a time.  */
+
+static uint8_t area_read_text (const char *path, int64_t size, int32_t type, AREA_POINTS *pts)
+{
+  FILE              *area_fp;
+  char              *buffer, *line, *next, *p, *lat, *lon;
+  double            x, y;
+  int64_t           len;
+
+
+  if ((area_fp = fopen (path, "rb")) == NULL)
+    {
+      perror (path);
+      return (NVFalse);
+    }
+
+  if ((buffer = (char *) malloc (size + 1)) == NULL)
+    {
+      perror ("Allocating area file buffer in get_area_mbr.c");
+      fclose (area_fp);
+      return (NVFalse);
+    }
 
-          //  Read all shapes
+  len = fread (buffer, 1, size, area_fp);
+  buffer[len] = 0;
 
-          for (k = 0 ; k < numShapes ; k++)
+  fclose (area_fp);
+
+
+  for (line = buffer ; line < buffer + len ; line = next)
+    {
+      if ((next = strchr (line, '\n')) == NULL)
+        {
+          next = buffer + len;
+        }
+      else
+        {
+          *next++ = 0;
+        }
+
+      switch (type)
+        {
+
+          /*  ISS-60 format area file.  */
+
+        case 0:
+          if (!strncmp (line, "POINT=", 6))
             {
-              shape = SHPReadObject (shpHandle, k);
+              p = line;
+              if (area_token (&p, ';') == NULL || (lat = area_token (&p, ';')) == NULL || (lon = area_token (&p, ';')) == NULL) break;
 
+              y = area_posfix (lat, POS_LAT);
+              x = area_posfix (lon, POS_LON);
 
-              //  Get all vertices
+              if (!area_add_point (pts, x, y)) goto fail;
+            }
+          break;
 
-              if (shape->nVertices >= 2)
-                {
-                  (*polygon_count) = 0;
 
-                  for (j = 0 ; j < shape->nVertices ; j++)
-                    {
-                      polygon_y[*polygon_count] = shape->padfY[j];
-                      polygon_x[*polygon_count] = shape->padfX[j];
+          /*  Polygon list format area file.  */
 
-                      (*polygon_count)++;
-                    }
-                }
+        case 1:
+          if ((p = strchr (line, ',')) != NULL)
+            {
+              *p = 0;
 
+              y = area_fget_coord (line, POS_LAT);
+              x = area_fget_coord (p + 1, POS_LON);
 
-              /*  If this is a PolyLine file instead of a Polygon file we need to dupe the first point and increase the count by one.  */
+              if (!area_add_point (pts, x, y)) goto fail;
+            }
+          break;
 
-              if (type == SHPT_ARC || type == SHPT_ARCZ || type == SHPT_ARCM)
-                {
-                  polygon_y[*polygon_count] = shape->padfY[0];
-                  polygon_x[*polygon_count] = shape->padfX[0];
 
-                  (*polygon_count)++;
-                }
+          /*  Army Corps area file.  Lines that don't have both values are skipped.  */
 
+        case 2:
+          p = line;
+          if (!area_scan_number (&p, &x)) break;
 
-              SHPDestroyObject (shape);
+          if (strchr (line, ','))
+            {
+              while (*p == ' ' || *p == '\t') p++;
+              if (*p++ != ',') break;
             }
 
-          SHPClose (shpHandle);
+          if (!area_scan_number (&p, &y)) break;
+
+          if (!area_add_point (pts, x, y)) goto fail;
+          break;
         }
-      else
+    }
+
+  free (buffer);
+
+  return (NVTrue);
+
+
+ fail:
+  free (buffer);
+  area_free_points (pts);
+
+  return (NVFalse);
+}
+
+
+
+/*  Read the polygon from a shape file.  As always, we only keep the last shape that has at least two vertices.  */
+
+static uint8_t area_read_shape (const char *path, AREA_POINTS *pts)
+{
+  int32_t           k, j, numShapes, type;
+  double            minBounds[4], maxBounds[4];
+  uint8_t           ok = NVTrue;
+  SHPHandle         shpHandle;
+  SHPObject         *shape = NULL;
+
+
+  //  Open shape file
+
+  if ((shpHandle = SHPOpen (path, "rb")) == NULL) return (NVFalse);
+
+
+  //  Get shape file header info
+
+  SHPGetInfo (shpHandle, &numShapes, &type, minBounds, maxBounds);
+
+
+  //  Read all shapes
+
+  for (k = 0 ; k < numShapes && ok ; k++)
+    {
+      if ((shape = SHPReadObject (shpHandle, k)) == NULL) continue;
+
+
+      //  Get all vertices
+
+      if (shape->nVertices >= 2)
         {
-          return (NVFalse);
+          pts->count = 0;
+
+          for (j = 0 ; j < shape->nVertices && ok ; j++) ok = area_add_point (pts, shape->padfX[j], shape->padfY[j]);
         }
+
+
+      /*  If this is a PolyLine file instead of a Polygon file we need to dupe the first point and increase the
+          count by one.  */
+
+      if (ok && shape->nVertices && (type == SHPT_ARC || type == SHPT_ARCZ || type == SHPT_ARCM))
+        ok = area_add_point (pts, shape->padfX[0], shape->padfY[0]);
+
+      SHPDestroyObject (shape);
     }
-  else
+
+  SHPClose (shpHandle);
+
+  if (!ok)
     {
-      if (strcmp (&path[strlen (path) - 4], ".shp")) fclose (area_fp);
+      area_free_points (pts);
       return (NVFalse);
     }
 
+  return (NVTrue);
+}
+
+
+
+/*  Read and parse an area file (no caching) and compute the MBR.  */
+
+static uint8_t area_read (const char *path, int64_t size, AREA_POINTS *pts, NV_F64_XYMBR *mbr)
+{
+  const char        *ext;
+  int32_t           i;
+  uint8_t           west = NVFalse, east = NVFalse, ret;
+
+
+  memset (pts, 0, sizeof (AREA_POINTS));
 
-  if (strcmp (&path[strlen (path) - 4], ".shp")) fclose (area_fp);
+  if (strlen (path) < 4) return (NVFalse);
+
+  ext = &path[strlen (path) - 4];
+
+  if (!strcmp (ext, ".ARE"))
+    {
+      ret = area_read_text (path, size, 0, pts);
+    }
+  else if (!strcmp (ext, ".are"))
+    {
+      ret = area_read_text (path, size, 1, pts);
+    }
+  else if (!strcmp (ext, ".afs"))
+    {
+      ret = area_read_text (path, size, 2, pts);
+    }
+  else if (!strcmp (ext, ".shp"))
+    {
+      ret = area_read_shape (path, pts);
+    }
+  else
+    {
+      return (NVFalse);
+    }
+
+  if (!ret) return (NVFalse);
 
 
   /*  Check for dateline crossing.  If you're making an area that goes more than half way around the earth
       you're on your own!  */
 
-  for (i = 0 ; i < *polygon_count ; i++)
+  for (i = 0 ; i < pts->count ; i++)
     {
-      if (polygon_x[i] < -90.0) west = NVTrue;
-      if (polygon_x[i] > 90.0) east = NVTrue;
+      if (pts->x[i] < -90.0) west = NVTrue;
+      if (pts->x[i] > 90.0) east = NVTrue;
     }
 
 
@@ -211,15 +533,15 @@ uint8_t get_area_mbr (const char *path, int32_t *polygon_count, double *polygon_
   mbr->min_x = 99999999999.0;
   mbr->max_y = -99999999999.0;
   mbr->max_x = -99999999999.0;
-    
-  for (i = 0 ; i < *polygon_count ; i++)
+
+  for (i = 0 ; i < pts->count ; i++)
     {
-      if (east && west && polygon_x[i] < 0.0) polygon_x[i] += 360.0;
+      if (east && west && pts->x[i] < 0.0) pts->x[i] += 360.0;
 
-      if (polygon_y[i] < mbr->min_y) mbr->min_y = polygon_y[i];
-      if (polygon_y[i] > mbr->max_y) mbr->max_y = polygon_y[i];
-      if (polygon_x[i] < mbr->min_x) mbr->min_x = polygon_x[i];
-      if (polygon_x[i] > mbr->max_x) mbr->max_x = polygon_x[i];
+      if (pts->y[i] < mbr->min_y) mbr->min_y = pts->y[i];
+      if (pts->y[i] > mbr->max_y) mbr->max_y = pts->y[i];
+      if (pts->x[i] < mbr->min_x) mbr->min_x = pts->x[i];
+      if (pts->x[i] > mbr->max_x) mbr->max_x = pts->x[i];
     }
 
   return (NVTrue);
@@ -227,184 +549,265 @@ uint8_t get_area_mbr (const char *path, int32_t *polygon_count, double *polygon_
 
 
 
-/*!  Get an NV_F64_XYMBR from the supplied area file (path) and return in polygon NV_F64_COORD2 array.  Area file may be .ARE, .are, or .afs.  */
+/*  Copy count points to newly allocated arrays.  */
 
-uint8_t get_area_mbr2 (const char *path, int32_t *polygon_count, NV_F64_COORD2 *polygon, NV_F64_XYMBR *mbr)
+static uint8_t area_copy (int32_t count, const double *x, const double *y, double **new_x, double **new_y)
+{
+  *new_x = (double *) malloc (MAX (count, 1) * sizeof (double));
+  *new_y = (double *) malloc (MAX (count, 1) * sizeof (double));
+
+  if (*new_x == NULL || *new_y == NULL)
+    {
+      free (*new_x);
+      free (*new_y);
+      *new_x = *new_y = NULL;
+      return (NVFalse);
+    }
+
+  if (count)
+    {
+      memcpy (*new_x, x, count * sizeof (double));
+      memcpy (*new_y, y, count * sizeof (double));
+    }
+
+  return (NVTrue);
+}
+
+
+
+static void area_cache_free (AREA_CACHE *entry)
+{
+  free (entry->path);
+  free (entry->x);
+  free (entry->y);
+  memset (entry, 0, sizeof (AREA_CACHE));
+}
+
+
+
+/*  Get the points and MBR for an area file from the cache, reading (and caching) the file if we don't have it or
+    it has changed since we read it.  The returned points belong to the caller.  */
+
+static uint8_t area_get (const char *path, AREA_POINTS *pts, NV_F64_XYMBR *mbr)
 {
-  char                    string[256], tmp[256], lat_hemi, lon_hemi;
-  FILE                    *area_fp = NULL;
-  int32_t                 i, k, j, lat_deg, lat_min, lon_deg, lon_min, numShapes, type;
-  float                   lat_sec, lon_sec;
-  double                  minBounds[4], maxBounds[4];;
-  uint8_t                 west = NVFalse, east = NVFalse;
-  SHPHandle               shpHandle;
-  SHPObject               *shape = NULL;
+  struct stat       st;
+  int64_t           mtime;
+  time_t            now;
+  int32_t           i, slot;
+  AREA_CACHE        *entry;
+
+
+  memset (pts, 0, sizeof (AREA_POINTS));
 
+  now = time (NULL);
 
-  if ((area_fp = fopen (path, "r")) == NULL)
+  if (stat (path, &st))
     {
       perror (path);
       return (NVFalse);
     }
-    
 
-  *polygon_count = 0;
+  mtime = (int64_t) st.st_mtime;
 
 
-  /*  ISS-60 format area file.  */
+  pthread_mutex_lock (&area_mutex);
 
-  if (!strcmp (&path[strlen (path) - 4], ".ARE"))
+  for (i = 0 ; i < AREA_CACHE_SIZE ; i++)
     {
-      while (fgets (string, sizeof (string), area_fp) != NULL)
+      entry = &area_cache[i];
+
+      if (entry->path != NULL && entry->size == (int64_t) st.st_size && entry->mtime == mtime && !strcmp (entry->path, path))
         {
-          if (!strncmp (string, "POINT=", 6))
+          if (!area_copy (entry->count, entry->x, entry->y, &pts->x, &pts->y))
             {
-              strtok (string, ";");
-              strcpy (tmp, strtok (NULL, ";"));
-              posfix (tmp, &polygon[*polygon_count].y, POS_LAT);
-              strcpy (tmp, strtok (NULL, ";"));
-              posfix (tmp, &polygon[*polygon_count].x, POS_LON);
-
-              (*polygon_count)++;
+              pthread_mutex_unlock (&area_mutex);
+              perror ("Allocating area polygon memory in get_area_mbr.c");
+              return (NVFalse);
             }
+
+          pts->count = pts->size = entry->count;
+          *mbr = entry->mbr;
+          entry->stamp = ++area_stamp;
+
+          pthread_mutex_unlock (&area_mutex);
+
+          return (NVTrue);
         }
     }
 
+  pthread_mutex_unlock (&area_mutex);
 
-  /*  Polygon list format area file.  */
 
-  else if (!strcmp (&path[strlen (path) - 4], ".are"))
-    {
-      while (fget_coord (area_fp, &lat_hemi, &lat_deg, &lat_min, &lat_sec, 
-                         &lon_hemi, &lon_deg, &lon_min, &lon_sec))
-        {
-          polygon[*polygon_count].y = (double) lat_deg + (double) lat_min / 60.0 + 
-            (double) lat_sec / 3600.0;
-          if (lat_hemi == 'S') polygon[*polygon_count].y = -polygon[*polygon_count].y;
+  /*  Not in the cache (or stale) so we have to read it.  The file is parsed without holding the lock so that
+      other threads can keep using the cache.  */
 
-          polygon[*polygon_count].x = (double) lon_deg + (double) lon_min / 60.0 +
-            (double) lon_sec / 3600.0;
-          if (lon_hemi == 'W') polygon[*polygon_count].x = -polygon[*polygon_count].x;
+  if (!area_read (path, (int64_t) st.st_size, pts, mbr)) return (NVFalse);
 
-          (*polygon_count)++;
-        }
-    }
 
+  /*  Replace the old entry for this file if there is one, otherwise use an empty or the least recently used
+      slot.  If we can't get the memory for the cache copy we just don't cache it.  If the file was modified in
+      the current second (or the clock is behind the file system's) we just drop any old entry for it.  */
 
-  /*  Army Corps area file.  */
+  pthread_mutex_lock (&area_mutex);
 
-  else if (!strcmp (&path[strlen (path) - 4], ".afs"))
+  slot = -1;
+  for (i = 0 ; i < AREA_CACHE_SIZE ; i++)
     {
-      while (fgets (string, sizeof (string), area_fp) != NULL)
+      if (area_cache[i].path != NULL && !strcmp (area_cache[i].path, path))
         {
-	  if (strchr (string, ','))
-	    {
-	      sscanf (string, "%lf,%lf", &polygon[*polygon_count].x, &polygon[*polygon_count].y);
-	    }
-	  else
-	    {
-	      sscanf (string, "%lf %lf", &polygon[*polygon_count].x, &polygon[*polygon_count].y);
-	    }
-
-          (*polygon_count)++;
+          slot = i;
+          break;
         }
     }
 
+  if (st.st_mtime >= now)
+    {
+      if (slot >= 0) area_cache_free (&area_cache[slot]);
 
-  /*  Shape file.  */
+      pthread_mutex_unlock (&area_mutex);
 
-  else if (!strcmp (&path[strlen (path) - 4], ".shp"))
+      return (NVTrue);
+    }
+
+  if (slot < 0)
     {
-      //  Open shape file
+      slot = 0;
+      for (i = 1 ; i < AREA_CACHE_SIZE ; i++) if (area_cache[i].stamp < area_cache[slot].stamp) slot = i;
+    }
 
-      shpHandle = SHPOpen (path, "rb");
+  entry = &area_cache[slot];
+  area_cache_free (entry);
 
-      if (shpHandle != NULL)
-        {
-          //  Get shape file header info
+  if ((entry->path = (char *) malloc (strlen (path) + 1)) != NULL && area_copy (pts->count, pts->x, pts->y, &entry->x, &entry->y))
+    {
+      strcpy (entry->path, path);
+      entry->size = (int64_t) st.st_size;
+      entry->mtime = mtime;
+      entry->count = pts->count;
+      entry->mbr = *mbr;
+      entry->stamp = ++area_stamp;
+    }
+  else
+    {
+      area_cache_free (entry);
+    }
 
-          SHPGetInfo (shpHandle, &numShapes, &type, minBounds, maxBounds);
+  pthread_mutex_unlock (&area_mutex);
 
+  return (NVTrue);
+}
 
-          //  Read all shapes
 
-          for (k = 0 ; k < numShapes ; k++)
-            {
-              shape = SHPReadObject (shpHandle, k);
 
+/***************************************************************************/
+/*!
 
-              //  Get all vertices
+  - Module Name:        get_area_polygon
 
-              if (shape->nVertices >= 2)
-                {
-                  (*polygon_count) = 0;
+  - Date Written:       October 2026
 
-                  for (j = 0 ; j < shape->nVertices ; j++)
-                    {
-                      polygon[*polygon_count].y = shape->padfY[j];
-                      polygon[*polygon_count].x = shape->padfX[j];
+  - Purpose:            Same as get_area_mbr except that the polygon arrays
+                        are allocated here so there is no limit on the
+                        number of points (get_area_mbr assumes the caller's
+                        arrays are big enough).  Parsed area files are
+                        cached (keyed by path, size, and modification time)
+                        so reading the same area file again is almost free.
 
-                      (*polygon_count)++;
-                    }
-                }
+  - Arguments:
+                        - path           =   area file (.ARE, .are, .afs,
+                                             or .shp)
+                        - polygon_count  =   returned number of points
+                        - polygon_x      =   returned X (longitude) array,
+                                             free with free
+                        - polygon_y      =   returned Y (latitude) array,
+                                             free with free
+                        - mbr            =   returned MBR
 
+  - Return Value:       NVTrue on success, otherwise NVFalse
 
-              /*  If this is a PolyLine file instead of a Polygon file we need to dupe the first point and increase the count by one.  */
+****************************************************************************/
 
-              if (type == SHPT_ARC || type == SHPT_ARCZ || type == SHPT_ARCM)
-                {
-                  polygon[*polygon_count].y = shape->padfY[0];
-                  polygon[*polygon_count].x = shape->padfX[0];
+uint8_t get_area_polygon (const char *path, int32_t *polygon_count, double **polygon_x, double **polygon_y, NV_F64_XYMBR *mbr)
+{
+  AREA_POINTS       pts;
 
-                  (*polygon_count)++;
-                }
 
+  *polygon_count = 0;
+  *polygon_x = *polygon_y = NULL;
 
-              SHPDestroyObject (shape);
-            }
+  if (!area_get (path, &pts, mbr)) return (NVFalse);
 
-          SHPClose (shpHandle);
-        }
-      else
-        {
-          return (NVFalse);
-        }
-    }
-  else
-    {
-      fclose (area_fp);
-      return (NVFalse);
-    }
+  *polygon_count = pts.count;
+  *polygon_x = pts.x;
+  *polygon_y = pts.y;
 
+  return (NVTrue);
+}
 
-  fclose (area_fp);
 
 
-  /*  Check for dateline crossing.  If you're making an area that goes more than half way around the earth
-      you're on your own!  */
+/*!  Free all of the parsed area files held in the get_area_mbr cache.  */
 
-  for (i = 0 ; i < *polygon_count ; i++)
+void clear_area_cache ()
+{
+  int32_t           i;
+
+
+  pthread_mutex_lock (&area_mutex);
+
+  for (i = 0 ; i < AREA_CACHE_SIZE ; i++) area_cache_free (&area_cache[i]);
+
+  pthread_mutex_unlock (&area_mutex);
+}
+
+
+
+/*!  Get an NV_F64_XYMBR from the supplied area file (path) and return in polygon X and Y arrays.  Area file may be .ARE, .are, .afs, or .shp.  */
+
+uint8_t get_area_mbr (const char *path, int32_t *polygon_count, double *polygon_x, double *polygon_y, NV_F64_XYMBR *mbr)
+{
+  AREA_POINTS       pts;
+
+
+  *polygon_count = 0;
+
+  if (!area_get (path, &pts, mbr)) return (NVFalse);
+
+  *polygon_count = pts.count;
+  if (pts.count)
     {
-      if (polygon[i].x < -90.0) west = NVTrue;
-      if (polygon[i].x > 90.0) east = NVTrue;
+      memcpy (polygon_x, pts.x, pts.count * sizeof (double));
+      memcpy (polygon_y, pts.y, pts.count * sizeof (double));
     }
 
+  area_free_points (&pts);
 
-  mbr->min_y = 99999999999.0;
-  mbr->min_x = 99999999999.0;
-  mbr->max_y = -99999999999.0;
-  mbr->max_x = -99999999999.0;
-    
-  for (i = 0 ; i < *polygon_count ; i++)
-    {
-      if (east && west && polygon[i].x < 0.0) polygon[i].x += 360.0;
+  return (NVTrue);
+}
+
+
+
+/*!  Get an NV_F64_XYMBR from the supplied area file (path) and return in polygon NV_F64_COORD2 array.  Area file may be .ARE, .are, .afs, or .shp.  */
 
-      if (polygon[i].y < mbr->min_y) mbr->min_y = polygon[i].y;
-      if (polygon[i].y > mbr->max_y) mbr->max_y = polygon[i].y;
-      if (polygon[i].x < mbr->min_x) mbr->min_x = polygon[i].x;
-      if (polygon[i].x > mbr->max_x) mbr->max_x = polygon[i].x;
+uint8_t get_area_mbr2 (const char *path, int32_t *polygon_count, NV_F64_COORD2 *polygon, NV_F64_XYMBR *mbr)
+{
+  AREA_POINTS       pts;
+  int32_t           i;
+
+
+  *polygon_count = 0;
+
+  if (!area_get (path, &pts, mbr)) return (NVFalse);
+
+  *polygon_count = pts.count;
+  for (i = 0 ; i < pts.count ; i++)
+    {
+      polygon[i].x = pts.x[i];
+      polygon[i].y = pts.y[i];
     }
 
+  area_free_points (&pts);
+
   return (NVTrue);
 }
 
@@ -60,6 +60,8 @@ extern "C" {
   uint8_t get_area_mbr2 (const char *path, int32_t *polygon_count, NV_F64_COORD2 *polygon, NV_F64_XYMBR *mbr);
   uint8_t get_area_ll_mbr (const char *path, int32_t *polygon_count, double *polygon_x, double *polygon_y, NV_F64_MBR *mbr);
   uint8_t get_area_ll_mbr2 (const char *path, int32_t *polygon_count, NV_F64_COORD2 *polygon, NV_F64_MBR *mbr);
+  uint8_t get_area_polygon (const char *path, int32_t *polygon_count, double **polygon_x, double **polygon_y, NV_F64_XYMBR *mbr);
+  void clear_area_cache ();
   uint8_t polygon_is_rectangle (int32_t polygon_count, double *polygon_x, double *polygon_y);
   uint8_t polygon_is_rectangle2 (int32_t polygon_count, NV_F64_COORD2 *polygon);
 
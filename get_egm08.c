@@ -37,6 +37,7 @@
 
 
 #include "get_egm08.h"
+#include "swap_bytes.h"
 
 #ifndef NINT
   #define     NINT(a)     ((a) < 0.0 ? (int) ((a) - 0.5) : (int) ((a) + 0.5))
@@ -54,47 +55,6 @@ static uint8_t first = NVTrue;
 static float **h;
 
 
-/***************************************************************************\
-*                                                                           *
-*   Module Name:        swap_float                                          *
-*                                                                           *
-*   Programmer(s):      Jan C. Depner                                       *
-*                                                                           *
-*   Date Written:       July 1992                                           *
-*                                                                           *
-*   Purpose:            This function swaps bytes in a four byte float.     *
-*                                                                           *
-*   Arguments:          word                -   pointer to the float        *
-*                                                                           *
-\***************************************************************************/
-
-static void swap_float (float *word)
-{
-  uint32_t          temp[4];
-
-  union
-  {
-    uint32_t        iword;
-    float           fword;
-  } eq;
-
-  eq.fword = *word;
-
-  temp[0] = eq.iword & 0x000000ff;
-  temp[1] = (eq.iword & 0x0000ff00) >> 8;
-  temp[2] = (eq.iword & 0x00ff0000) >> 16;
-  temp[3] = (eq.iword & 0xff000000) >> 24;
-
-  eq.iword = (temp[0] << 24) + (temp[1] << 16) + (temp[2] << 8) + temp[3];
-
-  *word = eq.fword;
-
-  return;
-}
-
-
-
-
 /***************************************************************************\
 *                                                                           *
 *   Module Name:        big_endian                                          *
@@ -531,7 +491,7 @@ float get_egm08 (double lat, double lon)
   FILE *dfp;
   char dirfil[512], big_file[512], little_file[512];
   double flat, flon, un;
-  int32_t i, j, k, lon_offset, cross_offset, strip_size[2], iwindo, nlon;
+  int32_t i, k, lon_offset, cross_offset, strip_size[2], iwindo, nlon;
 
 
 
@@ -736,7 +696,7 @@ float get_egm08 (double lat, double lon)
 
           /*  If this system is not the same endian-ness as the data file we have to swap the data.  */
 
-          if (swap) for (j = 0 ; j < width ; j++) swap_float (&h[k][j]);
+          if (swap) swap_float_array (h[k], width);
         }
 
       fclose (dfp);
@@ -108,7 +108,7 @@ float get_geoid09 (double lat, double lon)
                               "g2009a01.bin", "g2009a02.bin", "g2009a03.bin", "g2009a04.bin",
                               "g2009h01.bin", "g2009p01.bin", "g2009g01.bin", "g2009s01.bin"};
 
-  int32_t i, j, row, col, endian, current_file, ll_ndx, ul_ndx, ur_ndx, lr_ndx, size;
+  int32_t i, row, col, endian, current_file, ll_ndx, ul_ndx, ur_ndx, lr_ndx, size;
   float ll_height, ul_height, ur_height, lr_height, l_diff, r_diff, lr_diff, l_height, r_height, height;
   double lat_grid, lon_grid;
   FILE *fp;
@@ -296,13 +296,7 @@ float get_geoid09 (double lat, double lon)
 
       if (swap[current_file])
         {
-          for (i = 0 ; i < rows[current_file] ; i++)
-            {
-              for (j = 0 ; j < cols[current_file] ; j++)
-                {
-                  swap_float (&array[i * cols[current_file] + j]);
-                }
-            }
+          swap_float_array (array, (int64_t) rows[current_file] * cols[current_file]);
         }
 
       fclose (fp);
@@ -529,13 +523,7 @@ int32_t main (int32_t argc, char *argv[])
 
   if (swap)
     {
-      for (i = 0 ; i < rows ; i++)
-	{
-	  for (j = 0 ; j < cols ; j++)
-	    {
-	      swap_float (&array[i * cols + j]);
-	    }
-	}
+      swap_float_array (array, (int64_t) rows * cols);
     }
 
   fclose (fp);
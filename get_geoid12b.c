@@ -102,7 +102,7 @@ float get_geoid12b (double lat, double lon)
   static char dirfil[6][512], wvsdir[256];
   static char file[6][20] = {"g2012bu0.bin", "g2012ba0.bin", "g2012bh0.bin", "g2012bp0.bin", "g2012bg0.bin", "g2012bs0.bin"};
 
-  int32_t i, j, row, col, endian, current_file, ll_ndx, ul_ndx, ur_ndx, lr_ndx, size;
+  int32_t i, row, col, endian, current_file, ll_ndx, ul_ndx, ur_ndx, lr_ndx, size;
   float ll_height, ul_height, ur_height, lr_height, l_diff, r_diff, lr_diff, l_height, r_height, height;
   double lat_grid, lon_grid;
   FILE *fp;
@@ -290,13 +290,7 @@ float get_geoid12b (double lat, double lon)
 
       if (swap[current_file])
         {
-          for (i = 0 ; i < rows[current_file] ; i++)
-            {
-              for (j = 0 ; j < cols[current_file] ; j++)
-                {
-                  swap_float (&array[i * cols[current_file] + j]);
-                }
-            }
+          swap_float_array (array, (int64_t) rows[current_file] * cols[current_file]);
         }
 
       fclose (fp);
@@ -514,13 +508,7 @@ int32_t main (int32_t argc, char *argv[])
 
   if (swap)
     {
-      for (i = 0 ; i < rows ; i++)
-	{
-	  for (j = 0 ; j < cols ; j++)
-	    {
-	      swap_float (&array[i * cols + j]);
-	    }
-	}
+      swap_float_array (array, (int64_t) rows * cols);
     }
 
   fclose (fp);
@@ -0,0 +1,592 @@
+
+/*********************************************************************************************
+
+    This is public domain software that was developed by or for the U.S. Naval Oceanographic
+    Office and/or the U.S. Army Corps of Engineers.
+
+    This is a work of the U.S. Government. In accordance with 17 USC 105, copyright protection
+    is not available for any work of the U.S. Government.
+
+    Neither the United States Government, nor any employees of the United States Government,
+    nor the author, makes any warranty, express or implied, without even the implied warranty
+    of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE, or assumes any liability or
+    responsibility for the accuracy, completeness, or usefulness of any information,
+    apparatus, product, or process disclosed, or represents that its use would not infringe
+    privately-owned rights. Reference herein to any specific commercial products, process,
+    or service by trade name, trademark, manufacturer, or otherwise, does not necessarily
+    constitute or imply its endorsement, recommendation, or favoring by the United States
+    Government. The views and opinions of authors expressed herein do not necessarily state
+    or reflect those of the United States Government, and shall not be used for advertising
+    or product endorsement purposes.
+*********************************************************************************************/
+
+
+/****************************************  IMPORTANT NOTE  **********************************
+
+    Comments in this file that start with / * ! are being used by Doxygen to document the
+    software.  Dashes in these comment blocks are used to create bullet lists.  The lack of
+    blank lines after a block of dash preceeded comments means that the next block of dash
+    preceeded comments is a new, indented bullet list.  I've tried to keep the Doxygen
+    formatting to a minimum but there are some other items (like <br> and <pre>) that need
+    to be left alone.  If you see a comment that starts with / * ! and there is something
+    that looks a bit weird it is probably due to some arcane Doxygen syntax.  Be very
+    careful modifying blocks of Doxygen comments.
+
+*****************************************  IMPORTANT NOTE  **********************************/
+
+
+
+#include <string.h>
+
+#include "nvdef.h"
+#include "parallel_for.h"
+#include "grid_filter.h"
+
+
+/*  Runtime selected AVX2/FMA kernel for the column pass.  This is only built with GCC compatible compilers on
+    x86 since it relies on the target attribute and __builtin_cpu_supports.  */
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+  #define GRID_FILTER_SIMD
+  #include <immintrin.h>
+#endif
+
+
+/*  Number of columns per block in the column pass.  For the longest martin filter (361 taps) a block of all of
+    the rows we need is about 720KB which stays in L2 while we work down the rows of a chunk.  */
+
+#define GRID_FILTER_BLOCK        512
+
+
+/*  Work description for the column pass.  For in memory grids (grid_filter) the threads split the rows and we
+    use in, num, and den.  For streaming (grid_filter_stream) the threads split the columns of a single output
+    row and we use the row pointers.  */
+
+typedef struct
+{
+  GRID_FILTER      *gf;
+  const float      *in;
+  const float      *num;
+  const float      *den;
+  float            *out;
+  int32_t          width;
+  int32_t          height;
+  float            null_value;
+  const float      **num_rows;
+  const float      **den_rows;
+  const float      *in_row;
+  float            *out_row;
+  uint8_t          border;
+  int32_t          fma;
+} GRID_FILTER_BATCH;
+
+
+
+/*  Weighted sum of the taps rows (the column filter) for columns c0 through c1 - 1.  */
+
+static void grid_filter_combine (CONVOLVE_FILTER *cf, const float **rows, float *sum, int32_t c0, int32_t c1)
+{
+  int32_t          c, k;
+  const float      *row;
+  float            f;
+
+
+  for (c = c0 ; c < c1 ; c++) sum[c - c0] = 0.0;
+
+  for (k = 0 ; k < cf->taps ; k++)
+    {
+      f = cf->filter_f[k];
+      row = rows[k];
+
+      for (c = c0 ; c < c1 ; c++) sum[c - c0] += f * row[c];
+    }
+}
+
+
+
+#ifdef GRID_FILTER_SIMD
+
+/*  grid_filter_combine 32 (then 8) columns at a time.  Returns the index of the first column that wasn't done.  */
+
+__attribute__ ((target ("avx2,fma")))
+static int32_t grid_filter_combine_avx2 (CONVOLVE_FILTER *cf, const float **rows, float *sum, int32_t c0, int32_t c1)
+{
+  int32_t          c, k;
+  __m256           f, acc0, acc1, acc2, acc3;
+
+
+  for (c = c0 ; c + 32 <= c1 ; c += 32)
+    {
+      acc0 = acc1 = acc2 = acc3 = _mm256_setzero_ps ();
+
+      for (k = 0 ; k < cf->taps ; k++)
+        {
+          f = _mm256_broadcast_ss (&cf->filter_f[k]);
+          acc0 = _mm256_fmadd_ps (f, _mm256_loadu_ps (&rows[k][c]), acc0);
+          acc1 = _mm256_fmadd_ps (f, _mm256_loadu_ps (&rows[k][c + 8]), acc1);
+          acc2 = _mm256_fmadd_ps (f, _mm256_loadu_ps (&rows[k][c + 16]), acc2);
+          acc3 = _mm256_fmadd_ps (f, _mm256_loadu_ps (&rows[k][c + 24]), acc3);
+        }
+
+      _mm256_storeu_ps (&sum[c - c0], acc0);
+      _mm256_storeu_ps (&sum[c - c0 + 8], acc1);
+      _mm256_storeu_ps (&sum[c - c0 + 16], acc2);
+      _mm256_storeu_ps (&sum[c - c0 + 24], acc3);
+    }
+
+  for ( ; c + 8 <= c1 ; c += 8)
+    {
+      acc0 = _mm256_setzero_ps ();
+
+      for (k = 0 ; k < cf->taps ; k++) acc0 = _mm256_fmadd_ps (_mm256_broadcast_ss (&cf->filter_f[k]), _mm256_loadu_ps (&rows[k][c]), acc0);
+
+      _mm256_storeu_ps (&sum[c - c0], acc0);
+    }
+
+  return (c);
+}
+
+#endif
+
+
+
+/*  Column filter one output row for columns c0 through c1 - 1 (no more than GRID_FILTER_BLOCK of them).  For
+    border rows (the first length and last length + 1 rows, just like convolve) the row filtered values are used
+    as is.  */
+
+static void grid_filter_span (GRID_FILTER_BATCH *batch, const float **num_rows, const float **den_rows,
+                              const float *in_row, float *out_row, uint8_t border, int32_t c0, int32_t c1)
+{
+  CONVOLVE_FILTER  *cf = batch->gf->cf;
+  float            num_sum[GRID_FILTER_BLOCK], den_sum[GRID_FILTER_BLOCK];
+  const float      *num, *den = NULL;
+  int32_t          c, lo;
+
+
+  if (border)
+    {
+      num = &num_rows[batch->gf->length][c0];
+      if (den_rows != NULL) den = &den_rows[batch->gf->length][c0];
+    }
+  else
+    {
+      lo = c0;
+#ifdef GRID_FILTER_SIMD
+      if (batch->fma) lo = grid_filter_combine_avx2 (cf, num_rows, num_sum, c0, c1);
+#endif
+      grid_filter_combine (cf, num_rows, &num_sum[lo - c0], lo, c1);
+      num = num_sum;
+
+      if (den_rows != NULL)
+        {
+          lo = c0;
+#ifdef GRID_FILTER_SIMD
+          if (batch->fma) lo = grid_filter_combine_avx2 (cf, den_rows, den_sum, c0, c1);
+#endif
+          grid_filter_combine (cf, den_rows, &den_sum[lo - c0], lo, c1);
+          den = den_sum;
+        }
+    }
+
+
+  /*  Nulls stay null.  With normalized convolution we divide by the sum of the weights of the non-null cells
+      that went into each value.  */
+
+  for (c = c0 ; c < c1 ; c++)
+    {
+      if (in_row[c] == batch->null_value)
+        {
+          out_row[c] = batch->null_value;
+        }
+      else if (den != NULL)
+        {
+          out_row[c] = den[c - c0] >= GRID_FILTER_MIN_WEIGHT ? num[c - c0] / den[c - c0] : in_row[c];
+        }
+      else
+        {
+          out_row[c] = num[c - c0];
+        }
+    }
+}
+
+
+
+/*  Row filter rows of in to num (and the non-null mask to den if we're normalizing).  With normalized
+    convolution nulls are zeroed in work (rows * width values) before filtering.  */
+
+static void grid_filter_row_pass (GRID_FILTER *gf, const float *in, float *num, float *den, float *work, int32_t width,
+                                  int32_t rows, float null_value)
+{
+  int64_t          i, n = (int64_t) width * rows;
+
+
+  if (!gf->normalize)
+    {
+      convolve_filter_f (gf->cf, in, num, width, rows);
+      return;
+    }
+
+  for (i = 0 ; i < n ; i++) work[i] = in[i] == null_value ? 0.0 : in[i];
+  convolve_filter_f (gf->cf, work, num, width, rows);
+
+  for (i = 0 ; i < n ; i++) work[i] = in[i] == null_value ? 0.0 : 1.0;
+  convolve_filter_f (gf->cf, work, den, width, rows);
+}
+
+
+
+/*  Column pass for rows start through end - 1 of an in memory grid.  We work across the grid in column blocks
+    and down the rows within each block so the rows we need stay in cache.  */
+
+static void grid_filter_rows_chunk (int64_t start, int64_t end, void *arg)
+{
+  GRID_FILTER_BATCH *batch = (GRID_FILTER_BATCH *) arg;
+  int32_t           length = batch->gf->length, taps = batch->gf->cf->taps, width = batch->width, c0, k;
+  const float       **num_rows, **den_rows = NULL;
+  int64_t           r;
+  uint8_t           border;
+
+
+  num_rows = (const float **) malloc (2 * taps * sizeof (float *));
+  if (num_rows == NULL)
+    {
+      perror ("Allocating row pointers in grid_filter.c");
+      exit (-1);
+    }
+  if (batch->den != NULL) den_rows = &num_rows[taps];
+
+  for (c0 = 0 ; c0 < width ; c0 += GRID_FILTER_BLOCK)
+    {
+      for (r = start ; r < end ; r++)
+        {
+          border = (r < length || r >= batch->height - length - 1);
+
+          for (k = 0 ; k < taps ; k++)
+            {
+              if (border && k != length) continue;
+
+              num_rows[k] = &batch->num[(r - length + k) * width];
+              if (den_rows != NULL) den_rows[k] = &batch->den[(r - length + k) * width];
+            }
+
+          grid_filter_span (batch, num_rows, den_rows, &batch->in[r * width], &batch->out[r * width], border, c0,
+                            MIN (c0 + GRID_FILTER_BLOCK, width));
+        }
+    }
+
+  free (num_rows);
+}
+
+
+
+/*  Column pass for columns start through end - 1 of one streamed output row.  */
+
+static void grid_filter_columns_chunk (int64_t start, int64_t end, void *arg)
+{
+  GRID_FILTER_BATCH *batch = (GRID_FILTER_BATCH *) arg;
+  int64_t           c0;
+
+
+  for (c0 = start ; c0 < end ; c0 += GRID_FILTER_BLOCK)
+    grid_filter_span (batch, batch->num_rows, batch->den_rows, batch->in_row, batch->out_row, batch->border,
+                      (int32_t) c0, (int32_t) MIN (c0 + GRID_FILTER_BLOCK, end));
+}
+
+
+
+/***************************************************************************/
+/*!
+
+  - Module Name:        create_grid_filter
+
+  - Date Written:       October 2026
+
+  - Purpose:            Sets up a separable 2D filter from a martin design
+                        for grid_filter and grid_filter_stream.  The
+                        filter is applied along the rows and then along
+                        the columns, exactly like calling convolve on each
+                        row and then on each column.
+
+                        With normalize set (low pass filters only) null
+                        cells are left out of the filter and each value is
+                        divided by the sum of the weights of the non-null
+                        cells that went into it (normalized convolution).
+                        Without it null values are filtered like any other
+                        value (the way calling convolve on each row always
+                        has).  Either way, null cells stay null.
+
+  - Arguments:
+                        - cutoff      =   cutoff frequency
+                        - slope       =   filter slope
+                        - length      =   filter length (less than
+                                          MAX_MARTIN_FILTER_WEIGHTS)
+                        - type        =   0 for high pass, 1 for low pass
+                        - normalize   =   NVTrue for normalized convolution
+                                          around nulls
+
+  - Return value:
+                        - Filter (free with free_grid_filter)
+                        - NULL on error
+
+****************************************************************************/
+
+GRID_FILTER *create_grid_filter (double cutoff, double slope, int32_t length, int32_t type, uint8_t normalize)
+{
+  GRID_FILTER          *gf;
+  double               weights[MAX_MARTIN_FILTER_WEIGHTS];
+
+
+  if (length < 0 || length >= MAX_MARTIN_FILTER_WEIGHTS)
+    {
+      fprintf (stderr, "\n\nGrid filter length %d is out of range (0 to %d)\n\n", length, MAX_MARTIN_FILTER_WEIGHTS - 1);
+      return (NULL);
+    }
+
+  if ((gf = (GRID_FILTER *) calloc (1, sizeof (GRID_FILTER))) == NULL)
+    {
+      perror ("Allocating GRID_FILTER in create_grid_filter");
+      return (NULL);
+    }
+
+  martin (cutoff, slope, length, weights, type);
+
+  if ((gf->cf = create_convolve_filter (weights, length)) == NULL)
+    {
+      free (gf);
+      return (NULL);
+    }
+
+  gf->length = length;
+
+
+  /*  The weights of a high pass filter sum to zero so there's nothing to normalize by.  */
+
+  gf->normalize = (normalize && type);
+
+  return (gf);
+}
+
+
+
+/***************************************************************************/
+/*!
+
+  - Module Name:        grid_filter
+
+  - Date Written:       October 2026
+
+  - Purpose:            Filters an in memory grid with a filter from
+                        create_grid_filter.  Rows are filtered with
+                        convolve_filter_f, columns by summing weighted rows
+                        in cache sized column blocks.  Both passes are
+                        split across threads (see parallel_for).  This
+                        needs one (two if normalizing) extra grids worth of
+                        memory.  If the grid is too big for that use
+                        grid_filter_stream.
+
+  - Arguments:
+                        - gf          =   filter from create_grid_filter
+                        - in          =   input grid (height rows of width
+                                          values)
+                        - out         =   output grid (can't be in)
+                        - width       =   grid width (columns)
+                        - height      =   grid height (rows)
+                        - null_value  =   null value (e.g. CHRTRNULL)
+
+  - Return value:       NVTrue on success, NVFalse on memory allocation
+                        error
+
+****************************************************************************/
+
+uint8_t grid_filter (GRID_FILTER *gf, const float *in, float *out, int32_t width, int32_t height, float null_value)
+{
+  GRID_FILTER_BATCH    batch;
+  int64_t              size = (int64_t) width * height;
+  float                *num, *den = NULL;
+
+
+  if (width <= 0 || height <= 0) return (NVTrue);
+
+  num = (float *) malloc (size * sizeof (float));
+  if (gf->normalize) den = (float *) malloc (size * sizeof (float));
+
+  if (num == NULL || (gf->normalize && den == NULL))
+    {
+      perror ("Allocating row filtered grid in grid_filter");
+      free (num);
+      free (den);
+      return (NVFalse);
+    }
+
+
+  /*  Row pass (the output grid is used for the masked input if we're normalizing).  */
+
+  grid_filter_row_pass (gf, in, num, den, out, width, height, null_value);
+
+
+  /*  Column pass.  */
+
+  memset (&batch, 0, sizeof (GRID_FILTER_BATCH));
+  batch.gf = gf;
+  batch.in = in;
+  batch.num = num;
+  batch.den = den;
+  batch.out = out;
+  batch.width = width;
+  batch.height = height;
+  batch.null_value = null_value;
+
+#ifdef GRID_FILTER_SIMD
+  batch.fma = __builtin_cpu_supports ("avx2") && __builtin_cpu_supports ("fma");
+#endif
+
+  parallel_for (height, MAX (4194304 / ((int64_t) gf->cf->taps * width), 1), grid_filter_rows_chunk, &batch);
+
+  free (num);
+  free (den);
+
+  return (NVTrue);
+}
+
+
+
+/***************************************************************************/
+/*!
+
+  - Module Name:        grid_filter_stream
+
+  - Date Written:       October 2026
+
+  - Purpose:            Same as grid_filter but for grids that don't fit in
+                        memory.  Rows are read one at a time (in order)
+                        with read_row, row filtered, and kept in a ring of
+                        2 * length + 1 rows.  As soon as we have all of the
+                        rows that an output row needs it is column filtered
+                        and passed to write_row (also in order).  Memory use
+                        is about three (four if normalizing) times
+                        2 * length + 1 rows.  For example, read_row could
+                        call read_chrtr and write_row could call
+                        chrtr_writer_put_row.
+
+  - Arguments:
+                        - gf          =   filter from create_grid_filter
+                        - width       =   grid width (columns)
+                        - height      =   grid height (rows)
+                        - null_value  =   null value (e.g. CHRTRNULL)
+                        - read_row    =   function to read a row
+                        - write_row   =   function to write a row
+                        - arg         =   passed to read_row and write_row
+
+  - Return value:       NVTrue on success, NVFalse on memory allocation
+                        error or if read_row or write_row failed
+
+****************************************************************************/
+
+uint8_t grid_filter_stream (GRID_FILTER *gf, int32_t width, int32_t height, float null_value,
+                            GRID_FILTER_READ_FUNC read_row, GRID_FILTER_WRITE_FUNC write_row, void *arg)
+{
+  GRID_FILTER_BATCH    batch;
+  int32_t              taps = gf->cf->taps, length = gf->length, r_in, r_out, k, slot;
+  int64_t              ring_size = (int64_t) taps * width;
+  float                *ring_in, *ring_num, *ring_den = NULL, *work, *out_row;
+  const float          **rows;
+  uint8_t              ret = NVTrue;
+
+
+  if (width <= 0 || height <= 0) return (NVTrue);
+
+  ring_in = (float *) malloc (ring_size * sizeof (float));
+  ring_num = (float *) malloc (ring_size * sizeof (float));
+  if (gf->normalize) ring_den = (float *) malloc (ring_size * sizeof (float));
+  work = (float *) malloc (width * sizeof (float));
+  out_row = (float *) malloc (width * sizeof (float));
+  rows = (const float **) malloc (2 * taps * sizeof (float *));
+
+  if (ring_in == NULL || ring_num == NULL || (gf->normalize && ring_den == NULL) || work == NULL || out_row == NULL ||
+      rows == NULL)
+    {
+      perror ("Allocating row buffers in grid_filter_stream");
+      ret = NVFalse;
+      goto done;
+    }
+
+  memset (&batch, 0, sizeof (GRID_FILTER_BATCH));
+  batch.gf = gf;
+  batch.width = width;
+  batch.height = height;
+  batch.null_value = null_value;
+  batch.num_rows = rows;
+  if (gf->normalize) batch.den_rows = &rows[taps];
+  batch.out_row = out_row;
+
+#ifdef GRID_FILTER_SIMD
+  batch.fma = __builtin_cpu_supports ("avx2") && __builtin_cpu_supports ("fma");
+#endif
+
+
+  /*  Output row r_out needs rows r_out - length through r_out + length so it goes out right after we read row
+      r_out + length.  The last length rows are all border rows and go out at the end.  */
+
+  for (r_in = 0, r_out = -length ; r_out < height ; r_in++, r_out++)
+    {
+      if (r_in < height)
+        {
+          slot = r_in % taps;
+
+          if (!read_row (r_in, &ring_in[(int64_t) slot * width], arg))
+            {
+              ret = NVFalse;
+              goto done;
+            }
+
+          grid_filter_row_pass (gf, &ring_in[(int64_t) slot * width], &ring_num[(int64_t) slot * width],
+                                ring_den != NULL ? &ring_den[(int64_t) slot * width] : NULL, work, width, 1, null_value);
+        }
+
+      if (r_out < 0) continue;
+
+      batch.border = (r_out < length || r_out >= height - length - 1);
+
+      for (k = 0 ; k < taps ; k++)
+        {
+          if (batch.border && k != length) continue;
+
+          slot = (r_out - length + k + taps) % taps;
+          rows[k] = &ring_num[(int64_t) slot * width];
+          if (ring_den != NULL) rows[taps + k] = &ring_den[(int64_t) slot * width];
+        }
+
+      batch.in_row = &ring_in[(int64_t) (r_out % taps) * width];
+
+      parallel_for (width, MAX (4194304 / taps, GRID_FILTER_BLOCK), grid_filter_columns_chunk, &batch);
+
+      if (!write_row (r_out, out_row, arg))
+        {
+          ret = NVFalse;
+          goto done;
+        }
+    }
+
+
+ done:
+  free (ring_in);
+  free (ring_num);
+  free (ring_den);
+  free (work);
+  free (out_row);
+  free (rows);
+
+  return (ret);
+}
+
+
+
+/*!  Free a filter from create_grid_filter.  */
+
+void free_grid_filter (GRID_FILTER *gf)
+{
+  if (gf == NULL) return;
+
+  free_convolve_filter (gf->cf);
+  free (gf);
+}
@@ -0,0 +1,88 @@
+
+/*********************************************************************************************
+
+    This is public domain software that was developed by or for the U.S. Naval Oceanographic
+    Office and/or the U.S. Army Corps of Engineers.
+
+    This is a work of the U.S. Government. In accordance with 17 USC 105, copyright protection
+    is not available for any work of the U.S. Government.
+
+    Neither the United States Government, nor any employees of the United States Government,
+    nor the author, makes any warranty, express or implied, without even the implied warranty
+    of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE, or assumes any liability or
+    responsibility for the accuracy, completeness, or usefulness of any information,
+    apparatus, product, or process disclosed, or represents that its use would not infringe
+    privately-owned rights. Reference herein to any specific commercial products, process,
+    or service by trade name, trademark, manufacturer, or otherwise, does not necessarily
+    constitute or imply its endorsement, recommendation, or favoring by the United States
+    Government. The views and opinions of authors expressed herein do not necessarily state
+    or reflect those of the United States Government, and shall not be used for advertising
+    or product endorsement purposes.
+*********************************************************************************************/
+
+
+/****************************************  IMPORTANT NOTE  **********************************
+
+    Comments in this file that start with / * ! are being used by Doxygen to document the
+    software.  Dashes in these comment blocks are used to create bullet lists.  The lack of
+    blank lines after a block of dash preceeded comments means that the next block of dash
+    preceeded comments is a new, indented bullet list.  I've tried to keep the Doxygen
+    formatting to a minimum but there are some other items (like <br> and <pre>) that need
+    to be left alone.  If you see a comment that starts with / * ! and there is something
+    that looks a bit weird it is probably due to some arcane Doxygen syntax.  Be very
+    careful modifying blocks of Doxygen comments.
+
+*****************************************  IMPORTANT NOTE  **********************************/
+
+
+
+#ifndef _GRID_FILTER_H_
+#define _GRID_FILTER_H_
+
+#ifdef  __cplusplus
+extern "C" {
+#endif
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "pfm_nvtypes.h"
+#include "martin.h"
+#include "convolve.h"
+
+
+  /*!  With normalized convolution, cells whose (filtered) sum of weights of non-null neighbors is less than this
+       keep their original value instead of being divided by a tiny number.  */
+
+#define GRID_FILTER_MIN_WEIGHT   0.25
+
+
+  /*!  Separable 2D filter built from a martin design (see create_grid_filter).  */
+
+  typedef struct
+  {
+    CONVOLVE_FILTER *cf;                   /*!<  Row (and column) filter  */
+    int32_t       length;                  /*!<  Filter length (the filter has 2 * length + 1 taps)  */
+    uint8_t       normalize;               /*!<  Set to use normalized convolution around null values  */
+  } GRID_FILTER;
+
+
+  /*!  Row reader and writer for grid_filter_stream.  Rows are read in order (0 through height - 1) and written
+       in order.  Return NVFalse to stop filtering.  */
+
+  typedef uint8_t (*GRID_FILTER_READ_FUNC) (int32_t row, float *data, void *arg);
+  typedef uint8_t (*GRID_FILTER_WRITE_FUNC) (int32_t row, const float *data, void *arg);
+
+
+  GRID_FILTER *create_grid_filter (double cutoff, double slope, int32_t length, int32_t type, uint8_t normalize);
+  uint8_t grid_filter (GRID_FILTER *gf, const float *in, float *out, int32_t width, int32_t height, float null_value);
+  uint8_t grid_filter_stream (GRID_FILTER *gf, int32_t width, int32_t height, float null_value,
+                              GRID_FILTER_READ_FUNC read_row, GRID_FILTER_WRITE_FUNC write_row, void *arg);
+  void free_grid_filter (GRID_FILTER *gf);
+
+
+#ifdef  __cplusplus
+}
+#endif
+
+#endif
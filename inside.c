@@ -37,77 +37,7 @@
 
 
 #include "inside.h"
-
-
-#ifndef M_PI
-  #define	M_PI		3.14159265358979323846	/* pi */
-#endif
-#ifndef M_PI_2
-  #define	M_PI_2		1.57079632679489661923	/* pi/2 */
-#endif
-
-
-
-
-/***************************************************************************/
-/*!
-
-  - Module Name:        angle
-
-  - Programmer(s):      Unknown
-
-  - Date Written:       Unknown
-
-  - Modified:           Jan C. Depner, ported to C.
-
-  - Date Modified:      August 1992
-
-  - Purpose:            Computes the angle between the three geographic
-                        points specified.
-
-  - Arguments:
-                        - x0       =   x position of point 0
-                        - y0       =   y position of point 0
-                        - x1       =   x position of point 1
-                        - y1       =   y position of point 1
-                        - x2       =   x position of point 2
-                        - y2       =   y position of point 2
-
-  - Return Value:       double =   angle
-
-  - Method:             Computes the cross and dot products of the two
-                        vectors.  The cross product divided by the dot
-                        product gives the tangent of the angle.  Then the
-                        arc tangent is taken to get the angle.
-
-****************************************************************************/
-
-static double angle (double x0, double y0, double x1, double y1, 
-                         double x2, double y2)
-{
-  double              xx1, yy1, xx2, yy2, cross, dot, local_angle;
-
-    xx1 = x1 - x0;
-    yy1 = y1 - y0;
-    xx2 = x2 - x0;
-    yy2 = y2 - y0;
-    cross = xx1 * yy2 - xx2 * yy1;
-    dot = xx1 * xx2 + yy1 * yy2;
-
-    if (fabs (dot) <= 1.0e-30)
-    {
-        local_angle = M_PI_2;
-    }
-    else
-    {
-        local_angle = atan (fabs (cross / dot));
-        if (dot < 0.0) local_angle = M_PI - local_angle;
-    }
-
-    if (cross < 0.0) local_angle = -local_angle;
-
-    return (local_angle);
-}
+#include "inside_polygon.h"
 
 
 
@@ -122,7 +52,7 @@ static double angle (double x0, double y0, double x1, double y1,
 
   - Modified:           Jan C. Depner, ported to C.
 
-  - Date Modified:      August 1992
+  - Date Modified:      October 2026
 
   - Purpose:            Checks a point to see if it falls within the
                         specified polygon.
@@ -136,9 +66,14 @@ static double angle (double x0, double y0, double x1, double y1,
 
   - Return Value:       int32_t    =   1 if inside, 0 if not
 
-  - Method:             Sums all of the angles between the point and each
-                        pair of polygon vertices.  If the sum is greater
-                        than PI, the point is inside the polygon.
+  - Method:             This used to sum the angles (using atan) between the
+                        point and each pair of polygon vertices.  It now
+                        calls inside_polygon2 (crossing number test).  The
+                        only differences are for points lying exactly on the
+                        polygon boundary and for self-intersecting polygons.
+                        If you are testing many points against the same
+                        polygon use inside_polygon_batch or
+                        prepare_polygon2 instead.
 
   - Restrictions:       The vertices of the polygon must be in order around
                         the polygon.
@@ -147,26 +82,10 @@ static double angle (double x0, double y0, double x1, double y1,
 
 int32_t inside (double *ax, double *ay, int32_t count, double x, double y)
 {
-  double              angle_sum;
-  int32_t             i;
-
-
   /*  There have to be at least three points in the polygon.          */
 
-  if (count > 2)
-    {
-      angle_sum = 0.0;
+  if (count > 2) return (inside_polygon2 (ax, ay, count, x, y));
 
-      for (i = 1 ; i < count ; i++)
-        {
-          angle_sum += angle (x, y, ax[i], ay[i], ax[i - 1], ay[i - 1]);
-        }
-        
-      angle_sum += angle (x, y, ax[0], ay[0], ax[count - 1], ay[count - 1]);
-
-      if (fabs (angle_sum) > M_PI) return (1);
-    }
-    
   return (0);
 }
 
@@ -175,26 +94,10 @@ int32_t inside (double *ax, double *ay, int32_t count, double x, double y)
 
 int32_t inside_coord2 (NV_F64_COORD2 *xy, int32_t count, double x, double y)
 {
-  double              angle_sum;
-  int32_t             i;
-
-
   /*  There have to be at least three points in the polygon.          */
 
-  if (count > 2)
-    {
-      angle_sum = 0.0;
+  if (count > 2) return (inside_polygon (xy, count, x, y));
 
-      for (i = 1 ; i < count ; i++)
-        {
-          angle_sum += angle (x, y, xy[i].x, xy[i].y, xy[i - 1].x, xy[i - 1].y);
-        }
-        
-      angle_sum += angle (x, y, xy[0].x, xy[0].y, xy[count - 1].x, xy[count - 1].y);
-
-      if (fabs (angle_sum) > M_PI) return (1);
-    }
-    
   return (0);
 }
 
@@ -203,27 +106,7 @@ int32_t inside_coord2 (NV_F64_COORD2 *xy, int32_t count, double x, double y)
 
 int32_t inside_area (AREA area, double x, double y)
 {
-    double              angle_sum;
-    int32_t             i;
-
-
-    /*  There have to be at least three points in the polygon.          */
-
-    if (area.points > 2)
-    {
-        angle_sum = 0.0;
-
-        for (i = 1 ; i < area.points ; i++)
-        {
-            angle_sum += angle (x, y, area.lon[i], area.lat[i], area.lon[i - 1], area.lat[i - 1]);
-        }
-        
-        angle_sum += angle (x, y, area.lon[0], area.lat[0], area.lon[area.points - 1], area.lat[area.points - 1]);
-
-        if (fabs (angle_sum) > M_PI) return (1);
-    }
-    
-    return (0);
+  return (inside (area.lon, area.lat, area.points, x, y));
 }
 
 
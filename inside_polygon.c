@@ -36,8 +36,23 @@
 
 
 
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include "nvdef.h"
+#include "parallel_for.h"
 #include "inside_polygon.h"
 
+
+/*  Runtime selected AVX2 kernel for inside_polygon_batch.  This is only built with GCC compatible compilers on
+    x86 since it relies on the target attribute and __builtin_cpu_supports.  */
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+  #define INSIDE_POLYGON_SIMD
+  #include <immintrin.h>
+#endif
+
 /***************************************************************************/
 /*!
   - Module Name:        inside_polygon
@@ -175,3 +190,576 @@ int32_t inside_polygon3 (int32_t *xs, int32_t *ys, int32_t npol, int32_t x, int3
 
   return (inside_flag);
 }
+
+
+
+/*  Crossing test (the same one inside_polygon2 uses) limited to the edges that overlap grid row "row".  Every
+    edge that can change the crossing count for a point in that row (i.e. min y < y <= max y) is in the row's
+    list so the result is identical to inside_polygon2.  */
+
+static int32_t prepared_row_test (PREPARED_POLYGON *pp, int32_t row, double x, double y)
+{
+  int32_t    k, i, j, yflag0, yflag1, inside_flag;
+
+  inside_flag = 0;
+
+  for (k = pp->row_start[row] ; k < pp->row_start[row + 1] ; k++)
+    {
+      i = pp->row_edge[k];
+      j = i ? i - 1 : pp->npol - 1;
+
+      yflag0 = (pp->y[j] >= y);
+      yflag1 = (pp->y[i] >= y);
+
+      if (yflag0 != yflag1)
+        {
+          if (((pp->y[i] - y) * (pp->x[j] - pp->x[i]) >= (pp->x[i] - x) * (pp->y[j] - pp->y[i])) == yflag1)
+            {
+              inside_flag = !inside_flag;
+            }
+        }
+    }
+
+  return (inside_flag);
+}
+
+
+
+static int32_t prepared_col (PREPARED_POLYGON *pp, double x)
+{
+  int32_t    c;
+
+  c = (int32_t) ((x - pp->mbr.min_x) * pp->x_scale);
+  if (c < 0) return (0);
+  if (c >= pp->cols) return (pp->cols - 1);
+
+  return (c);
+}
+
+
+
+static int32_t prepared_row (PREPARED_POLYGON *pp, double y)
+{
+  int32_t    r;
+
+  r = (int32_t) ((y - pp->mbr.min_y) * pp->y_scale);
+  if (r < 0) return (0);
+  if (r >= pp->rows) return (pp->rows - 1);
+
+  return (r);
+}
+
+
+
+/***************************************************************************/
+/*!
+  - Module Name:        prepare_polygon2
+
+  - Date Written:       October 2026
+
+  - Purpose:            Builds a PREPARED_POLYGON for repeated point in
+                        polygon tests against the same polygon.  The
+                        polygon MBR is split into a uniform grid (about four
+                        cells per vertex, shaped to the MBR).  Each grid row
+                        gets a list of the edges that overlap it and every
+                        cell that an edge touches is marked as an edge cell.
+                        The remaining cells are wholly inside or outside so
+                        we classify them once, by their centers.  A test
+                        then costs one table lookup for most points and a
+                        crossing test over one row's edges for points in
+                        edge cells.  Results are identical to
+                        inside_polygon2 (and inside_polygon).
+
+  - Arguments (prepare_polygon):
+                        - poly     =   Array of NV_F64_COORD2 structures holding
+                                       the polygon points
+                        - npol     =   Number of points in the polygon
+
+  - Arguments (prepare_polygon2):
+                        - poly_x   =   Array containing the X coordinates of the 
+                                       polygon's vertices
+                        - poly_y   =   Array containing the Y coordinates of the 
+                                       polygon's vertices
+                        - npol     =   Number of points in the polygon
+
+  - Arguments (prepare_polygon_area):
+                        - area     =   AREA structure (lon is X, lat is Y)
+
+  - Return Value:       Pointer to the PREPARED_POLYGON or NULL on memory
+                        allocation failure or if npol is less than 1.  Free
+                        it with free_prepared_polygon.
+
+  - Caveats:            Like inside_polygon2 (and inside, inside_coord2,
+                        and inside_area, which use the same test) this uses
+                        the crossing number rule, so a point that lies
+                        exactly on the polygon boundary may be classified as
+                        inside or outside depending on which edge it lies on.
+
+****************************************************************************/
+
+PREPARED_POLYGON *prepare_polygon2 (double *poly_x, double *poly_y, int32_t npol)
+{
+  PREPARED_POLYGON *pp;
+  int32_t          i, j, r, c, r0, r1, c0, c1, total, *fill;
+  double           width, height, pad_x, pad_y, ylo, yhi, xlo, xhi, ry0, ry1, xa, xb, t, cx, cy;
+
+
+  if (npol < 1) return (NULL);
+
+  pp = (PREPARED_POLYGON *) calloc (1, sizeof (PREPARED_POLYGON));
+  if (pp == NULL)
+    {
+      perror ("Allocating PREPARED_POLYGON in prepare_polygon2");
+      return (NULL);
+    }
+
+  pp->npol = npol;
+  pp->x = (double *) malloc (npol * sizeof (double));
+  pp->y = (double *) malloc (npol * sizeof (double));
+  if (pp->x == NULL || pp->y == NULL)
+    {
+      perror ("Allocating polygon memory in prepare_polygon2");
+      free_prepared_polygon (pp);
+      return (NULL);
+    }
+
+  memcpy (pp->x, poly_x, npol * sizeof (double));
+  memcpy (pp->y, poly_y, npol * sizeof (double));
+
+  pp->mbr.min_x = pp->mbr.max_x = poly_x[0];
+  pp->mbr.min_y = pp->mbr.max_y = poly_y[0];
+  for (i = 1 ; i < npol ; i++)
+    {
+      pp->mbr.min_x = MIN (pp->mbr.min_x, poly_x[i]);
+      pp->mbr.max_x = MAX (pp->mbr.max_x, poly_x[i]);
+      pp->mbr.min_y = MIN (pp->mbr.min_y, poly_y[i]);
+      pp->mbr.max_y = MAX (pp->mbr.max_y, poly_y[i]);
+    }
+
+
+  /*  Size the grid to about four cells per vertex with roughly square cells.  */
+
+  width = pp->mbr.max_x - pp->mbr.min_x;
+  height = pp->mbr.max_y - pp->mbr.min_y;
+  total = MIN (MAX (4 * npol, 16), 4194304);
+
+  if (width > 0.0 && height > 0.0)
+    {
+      pp->cols = (int32_t) ceil (sqrt ((double) total * width / height));
+      pp->cols = MIN (MAX (pp->cols, 1), 4096);
+      pp->rows = MIN (MAX ((total + pp->cols - 1) / pp->cols, 1), 4096);
+    }
+  else
+    {
+      pp->cols = width > 0.0 ? MIN (total, 4096) : 1;
+      pp->rows = height > 0.0 ? MIN (total, 4096) : 1;
+    }
+
+  pp->x_scale = width > 0.0 ? (double) pp->cols / width : 0.0;
+  pp->y_scale = height > 0.0 ? (double) pp->rows / height : 0.0;
+
+
+  /*  Pad the edge extents so that a point sitting on an edge always lands in a cell that is marked as an edge
+      cell regardless of rounding.  */
+
+  pad_x = width * 1.0e-9;
+  pad_y = height * 1.0e-9;
+
+  pp->cell = (uint8_t *) calloc ((int64_t) pp->cols * pp->rows, sizeof (uint8_t));
+  pp->row_start = (int32_t *) calloc (pp->rows + 1, sizeof (int32_t));
+  fill = (int32_t *) calloc (pp->rows + 1, sizeof (int32_t));
+  if (pp->cell == NULL || pp->row_start == NULL || fill == NULL)
+    {
+      perror ("Allocating grid memory in prepare_polygon2");
+      free (fill);
+      free_prepared_polygon (pp);
+      return (NULL);
+    }
+
+
+  /*  Count the edges in each row, then fill the row lists.  */
+
+  for (i = 0 ; i < npol ; i++)
+    {
+      j = i ? i - 1 : npol - 1;
+
+      r0 = prepared_row (pp, MIN (poly_y[i], poly_y[j]) - pad_y);
+      r1 = prepared_row (pp, MAX (poly_y[i], poly_y[j]) + pad_y);
+
+      for (r = r0 ; r <= r1 ; r++) pp->row_start[r + 1]++;
+    }
+
+  for (r = 0 ; r < pp->rows ; r++) pp->row_start[r + 1] += pp->row_start[r];
+
+  pp->row_edge = (int32_t *) malloc (MAX (pp->row_start[pp->rows], 1) * sizeof (int32_t));
+  if (pp->row_edge == NULL)
+    {
+      perror ("Allocating edge memory in prepare_polygon2");
+      free (fill);
+      free_prepared_polygon (pp);
+      return (NULL);
+    }
+
+  for (i = 0 ; i < npol ; i++)
+    {
+      j = i ? i - 1 : npol - 1;
+
+      ylo = MIN (poly_y[i], poly_y[j]);
+      yhi = MAX (poly_y[i], poly_y[j]);
+
+      r0 = prepared_row (pp, ylo - pad_y);
+      r1 = prepared_row (pp, yhi + pad_y);
+
+      for (r = r0 ; r <= r1 ; r++)
+        {
+          pp->row_edge[pp->row_start[r] + fill[r]++] = i;
+
+
+          /*  Mark the cells that the part of the edge inside this row passes through.  */
+
+          if (yhi > ylo && pp->y_scale > 0.0)
+            {
+              ry0 = MAX (ylo, pp->mbr.min_y + (double) r / pp->y_scale);
+              ry1 = MIN (yhi, pp->mbr.min_y + (double) (r + 1) / pp->y_scale);
+
+              t = (ry0 - poly_y[j]) / (poly_y[i] - poly_y[j]);
+              xa = poly_x[j] + t * (poly_x[i] - poly_x[j]);
+              t = (ry1 - poly_y[j]) / (poly_y[i] - poly_y[j]);
+              xb = poly_x[j] + t * (poly_x[i] - poly_x[j]);
+
+              xlo = MIN (xa, xb);
+              xhi = MAX (xa, xb);
+            }
+          else
+            {
+              xlo = MIN (poly_x[i], poly_x[j]);
+              xhi = MAX (poly_x[i], poly_x[j]);
+            }
+
+          c0 = prepared_col (pp, xlo - pad_x);
+          c1 = prepared_col (pp, xhi + pad_x);
+
+          for (c = c0 ; c <= c1 ; c++) pp->cell[(int64_t) r * pp->cols + c] = PREPARED_POLYGON_EDGE;
+        }
+    }
+
+  free (fill);
+
+
+  /*  Any cell that no edge touches is entirely inside or entirely outside.  */
+
+  for (r = 0 ; r < pp->rows ; r++)
+    {
+      cy = pp->y_scale > 0.0 ? pp->mbr.min_y + ((double) r + 0.5) / pp->y_scale : pp->mbr.min_y;
+
+      for (c = 0 ; c < pp->cols ; c++)
+        {
+          if (pp->cell[(int64_t) r * pp->cols + c] != PREPARED_POLYGON_EDGE)
+            {
+              cx = pp->x_scale > 0.0 ? pp->mbr.min_x + ((double) c + 0.5) / pp->x_scale : pp->mbr.min_x;
+
+              pp->cell[(int64_t) r * pp->cols + c] = prepared_row_test (pp, r, cx, cy) ? PREPARED_POLYGON_IN :
+                PREPARED_POLYGON_OUT;
+            }
+        }
+    }
+
+  return (pp);
+}
+
+
+
+PREPARED_POLYGON *prepare_polygon (NV_F64_COORD2 *poly, int32_t npol)
+{
+  PREPARED_POLYGON *pp;
+  double           *x, *y;
+  int32_t          i;
+
+
+  if (npol < 1) return (NULL);
+
+  x = (double *) malloc (npol * sizeof (double));
+  y = (double *) malloc (npol * sizeof (double));
+  if (x == NULL || y == NULL)
+    {
+      perror ("Allocating polygon memory in prepare_polygon");
+      free (x);
+      free (y);
+      return (NULL);
+    }
+
+  for (i = 0 ; i < npol ; i++)
+    {
+      x[i] = poly[i].x;
+      y[i] = poly[i].y;
+    }
+
+  pp = prepare_polygon2 (x, y, npol);
+
+  free (x);
+  free (y);
+
+  return (pp);
+}
+
+
+
+PREPARED_POLYGON *prepare_polygon_area (AREA *area)
+{
+  return (prepare_polygon2 (area->lon, area->lat, area->points));
+}
+
+
+
+/***************************************************************************/
+/*!
+  - Module Name:        inside_prepared_polygon
+
+  - Date Written:       October 2026
+
+  - Purpose:            Point in polygon test against a PREPARED_POLYGON.
+
+  - Arguments:
+                        - pp       =   Prepared polygon from prepare_polygon2
+                        - x        =   X value of point to be tested
+                        - y        =   Y value of point to be tested
+
+  - Return Value:       1 if point is inside polygon, 0 if outside
+
+****************************************************************************/
+
+int32_t inside_prepared_polygon (PREPARED_POLYGON *pp, double x, double y)
+{
+  int32_t    r, c;
+
+
+  if (x < pp->mbr.min_x || x > pp->mbr.max_x || y < pp->mbr.min_y || y > pp->mbr.max_y) return (0);
+
+  r = prepared_row (pp, y);
+  c = prepared_col (pp, x);
+
+  switch (pp->cell[(int64_t) r * pp->cols + c])
+    {
+    case PREPARED_POLYGON_IN:
+      return (1);
+
+    case PREPARED_POLYGON_OUT:
+      return (0);
+    }
+
+  return (prepared_row_test (pp, r, x, y));
+}
+
+
+
+void free_prepared_polygon (PREPARED_POLYGON *pp)
+{
+  if (pp == NULL) return;
+
+  free (pp->x);
+  free (pp->y);
+  free (pp->cell);
+  free (pp->row_start);
+  free (pp->row_edge);
+  free (pp);
+}
+
+
+
+typedef struct
+{
+  const double     *poly_x;
+  const double     *poly_y;
+  int32_t          npol;
+  NV_F64_XYMBR     mbr;
+  PREPARED_POLYGON *pp;
+  const double     *x;
+  const double     *y;
+  uint8_t          *out;
+  int32_t          avx2;
+} INSIDE_POLYGON_BATCH;
+
+
+#ifdef INSIDE_POLYGON_SIMD
+
+/*  The inside_polygon2 crossing test for four points at a time.  Each edge's constants are broadcast once and
+    the comparisons become lane masks so the inside flags are toggled with an XOR.  The arithmetic is the same
+    (no fused multiply-add) so the results are identical to inside_polygon2.  Returns the number of points
+    done (a multiple of 4).  */
+
+__attribute__ ((target ("avx2")))
+static int64_t inside_polygon_avx2 (INSIDE_POLYGON_BATCH *batch, int64_t start, int64_t end)
+{
+  const double *px = batch->poly_x, *py = batch->poly_y;
+  int64_t       k;
+  int32_t       i, j, m, mask;
+  __m256d       vx, vy, inside, yflag0, yflag1, ge, toggle, out_mbr;
+
+
+  for (k = start ; k + 4 <= end ; k += 4)
+    {
+      vx = _mm256_loadu_pd (batch->x + k);
+      vy = _mm256_loadu_pd (batch->y + k);
+
+
+      /*  Skip the edges if all four points are outside of the polygon MBR.  */
+
+      out_mbr = _mm256_or_pd (_mm256_or_pd (_mm256_cmp_pd (vx, _mm256_set1_pd (batch->mbr.min_x), _CMP_LT_OQ),
+                                            _mm256_cmp_pd (vx, _mm256_set1_pd (batch->mbr.max_x), _CMP_GT_OQ)),
+                              _mm256_or_pd (_mm256_cmp_pd (vy, _mm256_set1_pd (batch->mbr.min_y), _CMP_LT_OQ),
+                                            _mm256_cmp_pd (vy, _mm256_set1_pd (batch->mbr.max_y), _CMP_GT_OQ)));
+
+      if (_mm256_movemask_pd (out_mbr) == 15)
+        {
+          for (m = 0 ; m < 4 ; m++) batch->out[k + m] = 0;
+          continue;
+        }
+
+      inside = _mm256_setzero_pd ();
+
+      j = batch->npol - 1;
+      yflag0 = _mm256_cmp_pd (_mm256_set1_pd (py[j]), vy, _CMP_GE_OQ);
+
+      for (i = 0 ; i < batch->npol ; i++)
+        {
+          yflag1 = _mm256_cmp_pd (_mm256_set1_pd (py[i]), vy, _CMP_GE_OQ);
+
+          ge = _mm256_cmp_pd (_mm256_mul_pd (_mm256_sub_pd (_mm256_set1_pd (py[i]), vy), _mm256_set1_pd (px[j] - px[i])),
+                              _mm256_mul_pd (_mm256_sub_pd (_mm256_set1_pd (px[i]), vx), _mm256_set1_pd (py[j] - py[i])),
+                              _CMP_GE_OQ);
+
+          toggle = _mm256_andnot_pd (_mm256_xor_pd (ge, yflag1), _mm256_xor_pd (yflag0, yflag1));
+          inside = _mm256_xor_pd (inside, toggle);
+
+          yflag0 = yflag1;
+          j = i;
+        }
+
+      mask = _mm256_movemask_pd (inside);
+      for (m = 0 ; m < 4 ; m++) batch->out[k + m] = (mask >> m) & 1;
+    }
+
+  return (k);
+}
+
+#endif
+
+
+
+static void inside_polygon_batch_chunk (int64_t start, int64_t end, void *arg)
+{
+  INSIDE_POLYGON_BATCH *batch = (INSIDE_POLYGON_BATCH *) arg;
+  int64_t              k;
+
+
+  if (batch->pp != NULL)
+    {
+      for (k = start ; k < end ; k++) batch->out[k] = inside_prepared_polygon (batch->pp, batch->x[k], batch->y[k]);
+      return;
+    }
+
+#ifdef INSIDE_POLYGON_SIMD
+  if (batch->avx2) start = inside_polygon_avx2 (batch, start, end);
+#endif
+
+  for (k = start ; k < end ; k++)
+    {
+      if (batch->x[k] < batch->mbr.min_x || batch->x[k] > batch->mbr.max_x || batch->y[k] < batch->mbr.min_y ||
+          batch->y[k] > batch->mbr.max_y)
+        {
+          batch->out[k] = 0;
+        }
+      else
+        {
+          batch->out[k] = inside_polygon2 ((double *) batch->poly_x, (double *) batch->poly_y, batch->npol, batch->x[k],
+                                           batch->y[k]);
+        }
+    }
+}
+
+
+
+/***************************************************************************/
+/*!
+  - Module Name:        inside_polygon_batch
+
+  - Date Written:       October 2026
+
+  - Purpose:            Runs the inside_polygon2 test on an array of points.
+                        Points outside of the polygon MBR are rejected
+                        without looking at the edges.  When there are a lot
+                        of points relative to the number of vertices the
+                        polygon is prepared (see prepare_polygon2) and each
+                        point is a table lookup.  Otherwise, on x86
+                        processors with AVX2 (checked at run time), four
+                        points are tested per pass over the edges.  Large
+                        arrays are split across threads with parallel_for.
+                        The results are identical to calling inside_polygon2
+                        for each point.
+
+  - Arguments:
+                        - poly_x   =   Array containing the X coordinates of the 
+                                       polygon's vertices
+                        - poly_y   =   Array containing the Y coordinates of the 
+                                       polygon's vertices
+                        - npol     =   Number of points in the polygon
+                        - x        =   X values of the points to be tested
+                        - y        =   Y values of the points to be tested
+                        - n        =   Number of points to be tested
+                        - out      =   1 if the point is inside the polygon,
+                                       0 if outside
+
+****************************************************************************/
+
+void inside_polygon_batch (const double *poly_x, const double *poly_y, int32_t npol, const double *x, const double *y,
+                           int32_t n, uint8_t *out)
+{
+  INSIDE_POLYGON_BATCH batch;
+  int32_t              i;
+
+
+  if (n <= 0) return;
+
+  if (npol < 1)
+    {
+      memset (out, 0, n);
+      return;
+    }
+
+  batch.poly_x = poly_x;
+  batch.poly_y = poly_y;
+  batch.npol = npol;
+  batch.x = x;
+  batch.y = y;
+  batch.out = out;
+  batch.pp = NULL;
+
+  batch.mbr.min_x = batch.mbr.max_x = poly_x[0];
+  batch.mbr.min_y = batch.mbr.max_y = poly_y[0];
+  for (i = 1 ; i < npol ; i++)
+    {
+      batch.mbr.min_x = MIN (batch.mbr.min_x, poly_x[i]);
+      batch.mbr.max_x = MAX (batch.mbr.max_x, poly_x[i]);
+      batch.mbr.min_y = MIN (batch.mbr.min_y, poly_y[i]);
+      batch.mbr.max_y = MAX (batch.mbr.max_y, poly_y[i]);
+    }
+
+#ifdef INSIDE_POLYGON_SIMD
+  batch.avx2 = __builtin_cpu_supports ("avx2");
+#else
+  batch.avx2 = 0;
+#endif
+
+
+  /*  Preparing the polygon costs about as much as testing a few points per vertex.  If it fails we just fall
+      back to testing the edges.  */
+
+  if (npol >= 16 && n >= 4 * npol) batch.pp = prepare_polygon2 ((double *) poly_x, (double *) poly_y, npol);
+
+
+  /*  Keep each thread's share worth at least a few million edge tests (or lookups).  */
+
+  parallel_for (n, batch.pp != NULL ? 262144 : MAX (4194304 / npol, 256), inside_polygon_batch_chunk, &batch);
+
+  free_prepared_polygon (batch.pp);
+}
@@ -9,11 +9,44 @@ extern "C" {
 
 #include <stdio.h>
 #include "pfm_nvtypes.h"
+#include "area.h"
+
+
+  /*!  Cell classifications for PREPARED_POLYGON.  */
+
+#define PREPARED_POLYGON_OUT    0
+#define PREPARED_POLYGON_IN     1
+#define PREPARED_POLYGON_EDGE   2
+
+
+  /*!  A polygon prepared for repeated point in polygon tests.  See prepare_polygon2 in inside_polygon.c.  */
+
+  typedef struct
+  {
+    int32_t       npol;         /*!<  Number of polygon vertices  */
+    double        *x;           /*!<  Copy of the polygon X coordinates  */
+    double        *y;           /*!<  Copy of the polygon Y coordinates  */
+    NV_F64_XYMBR  mbr;          /*!<  Polygon MBR  */
+    int32_t       cols;         /*!<  Number of grid columns  */
+    int32_t       rows;         /*!<  Number of grid rows (horizontal slabs)  */
+    double        x_scale;      /*!<  Grid columns per X unit  */
+    double        y_scale;      /*!<  Grid rows per Y unit  */
+    uint8_t       *cell;        /*!<  PREPARED_POLYGON_OUT, _IN, or _EDGE for each grid cell (row major)  */
+    int32_t       *row_start;   /*!<  Start of each row's edges in row_edge (rows + 1 entries)  */
+    int32_t       *row_edge;    /*!<  Edges overlapping each row.  Edge i runs from vertex i - 1 (or npol - 1) to i.  */
+  } PREPARED_POLYGON;
 
 
   int32_t inside_polygon (NV_F64_COORD2 *poly, int32_t npol, double x, double y);
   int32_t inside_polygon2 (double *poly_x, double *poly_y, int32_t npol, double x, double y);
   int32_t inside_polygon3 (int32_t *xs, int32_t *ys, int32_t npol, int32_t x, int32_t y);
+  PREPARED_POLYGON *prepare_polygon (NV_F64_COORD2 *poly, int32_t npol);
+  PREPARED_POLYGON *prepare_polygon2 (double *poly_x, double *poly_y, int32_t npol);
+  PREPARED_POLYGON *prepare_polygon_area (AREA *area);
+  int32_t inside_prepared_polygon (PREPARED_POLYGON *pp, double x, double y);
+  void free_prepared_polygon (PREPARED_POLYGON *pp);
+  void inside_polygon_batch (const double *poly_x, const double *poly_y, int32_t npol, const double *x, const double *y,
+                             int32_t n, uint8_t *out);
 
 
 #ifdef  __cplusplus
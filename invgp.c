@@ -37,6 +37,77 @@
 
 
 #include "invgp.h"
+#include "parallel_for.h"
+
+
+/*  Runtime selected AVX2 kernel for invgp_batch (see simd_trig.inc).  */
+
+#include "simd_trig.inc"
+
+#ifdef SIMD_TRIG
+  #define INVGP_SIMD
+#endif
+
+
+#define INVGP_PI            3.141592653589793
+#define INVGP_TWOPI         6.283185307179586
+#define INVGP_RAD_TO_DEG    57.2957795147195
+#define INVGP_TINY          .0000000000000000000000000000001
+
+
+typedef struct
+{
+  GEODESIC         *geo;
+  const double     *rlat1;
+  const double     *rlon1;
+  const double     *rlat2;
+  const double     *rlon2;
+  double           *dist;
+  double           *az;
+  int32_t          avx2;
+} INVGP_BATCH;
+
+
+
+/***************************************************************************/
+/*!
+
+  - Module Name:        init_geodesic
+
+  - Date Written:       October 2026
+
+  - Purpose:            Computes the ellipsoid dependent constants used by
+                        invgp and newgp_geodesic so that they only need to
+                        be computed once per ellipsoid (see invgp_geodesic,
+                        invgp_batch, and newgp_batch).
+
+  - Arguments:
+                        - geo      =   GEODESIC structure to fill in
+                        - a0       =   semi-major axis in meters
+                        - b0       =   semi-minor axis in meters
+
+  - Return Value:       None
+
+****************************************************************************/
+
+void init_geodesic (GEODESIC *geo, double a0, double b0)
+{
+  geo->a0 = a0;
+  geo->b0 = b0;
+  geo->flat = 1.0l - (b0 / a0);
+  geo->flat2 = geo->flat * geo->flat;
+  geo->f1 = geo->flat2 * 1.25;
+  geo->f2 = geo->flat2 * 0.5;
+  geo->f3 = geo->flat2 * 0.25;
+  geo->f4 = geo->flat2 * 0.125;
+  geo->f5 = geo->flat2 * 0.0625;
+  geo->f6 = geo->flat + geo->flat2;
+  geo->f7 = geo->f6 + 1.0;
+  geo->f8 = geo->f6 * 0.5;
+  geo->ep2 = (a0 * a0 - b0 * b0) / (b0 * b0);
+}
+
+
 
 /***************************************************************************/
 /*!
@@ -52,6 +123,15 @@
 
   - Date:               September, 1992
 
+  - Modified:           The flattening terms used to be computed on the
+                       first call only so any later call with a different
+                       a0 and b0 got the wrong answer.  They now live in a
+                       GEODESIC structure (see init_geodesic) and invgp
+                       computes them on every call.  Use invgp_geodesic or
+                       invgp_batch to reuse them.
+
+  - Date:               October, 2026
+
   - Purpose:            Given the semi-major axis, semi-minor axis, and
                        two geographic positions this routine will compute
                        the distance between the two gp's and the azimuth
@@ -74,6 +154,19 @@
 
 void invgp (double a0, double b0, double rlat1, double rlon1, double rlat2,
 double rlon2, double *dist, double *az)
+{
+    GEODESIC            geo;
+
+    init_geodesic (&geo, a0, b0);
+
+    invgp_geodesic (&geo, rlat1, rlon1, rlat2, rlon2, dist, az);
+}
+
+
+
+/*  Same as invgp but using the precomputed constants in geo.  */
+
+void invgp_geodesic (GEODESIC *geo, double rlat1, double rlon1, double rlat2, double rlon2, double *dist, double *az)
 {
     double              drlat1, drlat2, drlon1, drlon2, dell, beta1, sbeta1,
                         cbeta1, beta2, sbeta2, cbeta2, adell, sidel, codel, a,
@@ -81,37 +174,18 @@ double rlon2, double *dist, double *az)
                         ctphi, psyco, term1, term2, term3, term4, term5, term6,
                         xlam1, tan;
     int32_t             n;
-    static int32_t      first = 1;
-    static double       pi = 3.141592653589793, twopi = 6.283185307179586,
-                        rad_to_deg = 57.2957795147195,
-                        tiny = .0000000000000000000000000000001, flat, flat2, f1,
-                        f2, f3, f4, f5, f6, f7, f8;
+    static double       pi = INVGP_PI, twopi = INVGP_TWOPI, rad_to_deg = INVGP_RAD_TO_DEG, tiny = INVGP_TINY;
 
-    if (first)
-    {
-        flat = 1.0l - (b0 / a0);
-        flat2 = flat * flat;
-        f1 = flat2 * 1.25;
-        f2 = flat2 * 0.5;
-        f3 = flat2 * 0.25;
-        f4 = flat2 * 0.125;
-        f5 = flat2 * 0.0625;
-        f6 = flat + flat2;
-        f7 = f6 + 1.0;
-        f8 = f6 * 0.5;
-
-        first = 0;
-    }
 
     drlat1 = rlat1 / rad_to_deg;
     drlat2 = rlat2 / rad_to_deg;
     drlon1 = rlon1 / rad_to_deg;
     drlon2 = rlon2 / rad_to_deg;
 
-    beta1 = atan ((1.0 - flat) * sin (drlat1) / cos (drlat1));
+    beta1 = atan ((1.0 - geo->flat) * sin (drlat1) / cos (drlat1));
     sbeta1 = sin (beta1);
     cbeta1 = cos (beta1);
-    beta2 = atan ((1.0 - flat) * sin (drlat2) / cos (drlat2));
+    beta2 = atan ((1.0 - geo->flat) * sin (drlat2) / cos (drlat2));
     sbeta2 = sin (beta2);
     cbeta2 = cos (beta2);
 
@@ -156,20 +230,20 @@ double rlon2, double *dist, double *az)
 
     /*  Compute distance.                                               */
 
-    term1 = f7 * phi;
-    term2 = a * (f6 * siphi - f2 * phisq * csphi);
-    term3 = em * (f2 * phisq * ctphi - f8 * (phi + psyco));
-    term4 = a * a * f2 * psyco;
-    term5 = em * em * (f5 * (phi + psyco) - f2 * phisq * ctphi - f4 * psyco *
+    term1 = geo->f7 * phi;
+    term2 = a * (geo->f6 * siphi - geo->f2 * phisq * csphi);
+    term3 = em * (geo->f2 * phisq * ctphi - geo->f8 * (phi + psyco));
+    term4 = a * a * geo->f2 * psyco;
+    term5 = em * em * (geo->f5 * (phi + psyco) - geo->f2 * phisq * ctphi - geo->f4 * psyco *
         cophi * cophi);
-    term6 = a * em * f2 * (phisq * csphi + psyco * cophi);
-    *dist = b0 * (term1 + term2 + term3 - term4 + term5 + term6);
+    term6 = a * em * geo->f2 * (phisq * csphi + psyco * cophi);
+    *dist = geo->b0 * (term1 + term2 + term3 - term4 + term5 + term6);
 
     /*  Compute azimuth.                                                */
 
-    term1 = f6 * phi;
-    term2 = a * (f2 * siphi + flat2 * phisq * csphi);
-    term3 = em * (f3 * psyco + flat2 * phisq * ctphi - f1 * phi);
+    term1 = geo->f6 * phi;
+    term2 = a * (geo->f2 * siphi + geo->flat2 * phisq * csphi);
+    term3 = em * (geo->f3 * psyco + geo->flat2 * phisq * ctphi - geo->f1 * phi);
     xlam1 = c * (term1 - term2 + term3) + adell;
     q1 = sbeta2 * cbeta1 - cos (xlam1) * sbeta1 * cbeta2;
     q2 = sin (xlam1) * cbeta2;
@@ -188,3 +262,230 @@ double rlon2, double *dist, double *az)
     if (n >= 3) q1 = (q2 - 2.0) * pi + *az;
     *az = q1 * rad_to_deg;
 }
+
+
+
+#ifdef INVGP_SIMD
+
+/*  invgp_geodesic for four pairs at a time.  The only difference from the scalar code is that sin (atan (t)) and
+    cos (atan (t)) for the reduced latitudes are computed directly as t / sqrt (1 + t * t) and 1 / sqrt (1 + t * t).
+    Returns the index of the first pair that wasn't done.  */
+
+__attribute__ ((target ("avx2")))
+static int64_t invgp_avx2 (INVGP_BATCH *batch, int64_t start, int64_t end)
+{
+  GEODESIC         *geo = batch->geo;
+  __m256d          rad_to_deg, pi, twopi, one, zero, tiny, sign_bit, lat1, lon1, lat2, lon2, s, c, t, sbeta1,
+                   cbeta1, sbeta2, cbeta2, dell, adell, adell2, dell2, sidel, codel, a, b, cophi, q1, q2, siphi,
+                   cc, em, phi, phisq, csphi, ctphi, psyco, term1, term2, term3, term4, term5, term6, dist,
+                   xlam1, tn, az, n, f1, f2, f3, f4, f5, f6, f7, f8, flat2, m;
+  int64_t          k;
+
+
+  rad_to_deg = _mm256_set1_pd (INVGP_RAD_TO_DEG);
+  pi = _mm256_set1_pd (INVGP_PI);
+  twopi = _mm256_set1_pd (INVGP_TWOPI);
+  one = _mm256_set1_pd (1.0);
+  zero = _mm256_setzero_pd ();
+  tiny = _mm256_set1_pd (INVGP_TINY);
+  sign_bit = _mm256_set1_pd (-0.0);
+  flat2 = _mm256_set1_pd (geo->flat2);
+  f1 = _mm256_set1_pd (geo->f1);
+  f2 = _mm256_set1_pd (geo->f2);
+  f3 = _mm256_set1_pd (geo->f3);
+  f4 = _mm256_set1_pd (geo->f4);
+  f5 = _mm256_set1_pd (geo->f5);
+  f6 = _mm256_set1_pd (geo->f6);
+  f7 = _mm256_set1_pd (geo->f7);
+  f8 = _mm256_set1_pd (geo->f8);
+
+  for (k = start ; k + 4 <= end ; k += 4)
+    {
+      lat1 = _mm256_div_pd (_mm256_loadu_pd (&batch->rlat1[k]), rad_to_deg);
+      lon1 = _mm256_div_pd (_mm256_loadu_pd (&batch->rlon1[k]), rad_to_deg);
+      lat2 = _mm256_div_pd (_mm256_loadu_pd (&batch->rlat2[k]), rad_to_deg);
+      lon2 = _mm256_div_pd (_mm256_loadu_pd (&batch->rlon2[k]), rad_to_deg);
+
+
+      /*  Reduced latitudes.  */
+
+      simd_sincos_avx2 (lat1, &s, &c);
+      t = _mm256_div_pd (_mm256_mul_pd (_mm256_set1_pd (1.0 - geo->flat), s), c);
+      cbeta1 = _mm256_div_pd (one, _mm256_sqrt_pd (_mm256_add_pd (one, _mm256_mul_pd (t, t))));
+      sbeta1 = _mm256_mul_pd (t, cbeta1);
+
+      simd_sincos_avx2 (lat2, &s, &c);
+      t = _mm256_div_pd (_mm256_mul_pd (_mm256_set1_pd (1.0 - geo->flat), s), c);
+      cbeta2 = _mm256_div_pd (one, _mm256_sqrt_pd (_mm256_add_pd (one, _mm256_mul_pd (t, t))));
+      sbeta2 = _mm256_mul_pd (t, cbeta2);
+
+
+      /*  Longitude difference (the same branches as the scalar code done with blends).  */
+
+      dell = _mm256_sub_pd (lon1, lon2);
+      adell = _mm256_andnot_pd (sign_bit, dell);
+
+      adell2 = _mm256_add_pd (_mm256_andnot_pd (sign_bit, lon1), _mm256_andnot_pd (sign_bit, lon2));
+      dell2 = _mm256_blendv_pd (adell2, _mm256_xor_pd (adell2, sign_bit), _mm256_cmp_pd (lon1, zero, _CMP_LT_OQ));
+      m = _mm256_cmp_pd (adell2, pi, _CMP_GT_OQ);
+      adell2 = _mm256_blendv_pd (adell2, _mm256_sub_pd (twopi, adell2), m);
+      dell2 = _mm256_blendv_pd (dell2, _mm256_blendv_pd (adell2, _mm256_xor_pd (adell2, sign_bit),
+                                                         _mm256_cmp_pd (lon1, zero, _CMP_GT_OQ)), m);
+
+      m = _mm256_cmp_pd (_mm256_mul_pd (lon1, lon2), zero, _CMP_LT_OQ);
+      adell = _mm256_blendv_pd (adell, adell2, m);
+      dell = _mm256_blendv_pd (dell, dell2, m);
+
+      adell = _mm256_sub_pd (twopi, adell);
+      simd_sincos_avx2 (adell, &sidel, &codel);
+
+      a = _mm256_mul_pd (sbeta1, sbeta2);
+      b = _mm256_mul_pd (cbeta1, cbeta2);
+      cophi = _mm256_add_pd (a, _mm256_mul_pd (b, codel));
+      q1 = _mm256_mul_pd (sidel, cbeta2);
+      q1 = _mm256_mul_pd (q1, q1);
+      q2 = _mm256_sub_pd (_mm256_mul_pd (sbeta2, cbeta1), _mm256_mul_pd (_mm256_mul_pd (sbeta1, cbeta2), codel));
+      q2 = _mm256_mul_pd (q2, q2);
+      siphi = _mm256_sqrt_pd (_mm256_add_pd (q1, q2));
+      cc = _mm256_div_pd (_mm256_mul_pd (b, sidel), siphi);
+      em = _mm256_sub_pd (one, _mm256_mul_pd (cc, cc));
+
+      phi = simd_atan_avx2 (_mm256_div_pd (siphi, _mm256_add_pd (_mm256_sqrt_pd (_mm256_sub_pd (one, _mm256_mul_pd (siphi, siphi))),
+                                                                  tiny)));
+      phi = _mm256_blendv_pd (phi, _mm256_sub_pd (pi, phi), _mm256_cmp_pd (cophi, zero, _CMP_LT_OQ));
+      phisq = _mm256_mul_pd (phi, phi);
+      csphi = _mm256_div_pd (one, siphi);
+      ctphi = _mm256_div_pd (cophi, siphi);
+      psyco = _mm256_div_pd (siphi, cophi);
+
+
+      /*  Distance.  */
+
+      term1 = _mm256_mul_pd (f7, phi);
+      term2 = _mm256_mul_pd (a, _mm256_sub_pd (_mm256_mul_pd (f6, siphi), _mm256_mul_pd (_mm256_mul_pd (f2, phisq), csphi)));
+      term3 = _mm256_mul_pd (em, _mm256_sub_pd (_mm256_mul_pd (_mm256_mul_pd (f2, phisq), ctphi),
+                                                _mm256_mul_pd (f8, _mm256_add_pd (phi, psyco))));
+      term4 = _mm256_mul_pd (_mm256_mul_pd (_mm256_mul_pd (a, a), f2), psyco);
+      term5 = _mm256_sub_pd (_mm256_sub_pd (_mm256_mul_pd (f5, _mm256_add_pd (phi, psyco)),
+                                            _mm256_mul_pd (_mm256_mul_pd (f2, phisq), ctphi)),
+                             _mm256_mul_pd (_mm256_mul_pd (_mm256_mul_pd (f4, psyco), cophi), cophi));
+      term5 = _mm256_mul_pd (_mm256_mul_pd (em, em), term5);
+      term6 = _mm256_mul_pd (_mm256_mul_pd (_mm256_mul_pd (a, em), f2),
+                             _mm256_add_pd (_mm256_mul_pd (phisq, csphi), _mm256_mul_pd (psyco, cophi)));
+      dist = _mm256_add_pd (_mm256_sub_pd (_mm256_add_pd (_mm256_add_pd (term1, term2), term3), term4), _mm256_add_pd (term5, term6));
+      _mm256_storeu_pd (&batch->dist[k], _mm256_mul_pd (_mm256_set1_pd (geo->b0), dist));
+
+      if (batch->az == NULL) continue;
+
+
+      /*  Azimuth.  */
+
+      term1 = _mm256_mul_pd (f6, phi);
+      term2 = _mm256_mul_pd (a, _mm256_add_pd (_mm256_mul_pd (f2, siphi), _mm256_mul_pd (_mm256_mul_pd (flat2, phisq), csphi)));
+      term3 = _mm256_mul_pd (em, _mm256_sub_pd (_mm256_add_pd (_mm256_mul_pd (f3, psyco),
+                                                               _mm256_mul_pd (_mm256_mul_pd (flat2, phisq), ctphi)),
+                                                _mm256_mul_pd (f1, phi)));
+      xlam1 = _mm256_add_pd (_mm256_mul_pd (cc, _mm256_add_pd (_mm256_sub_pd (term1, term2), term3)), adell);
+      simd_sincos_avx2 (xlam1, &s, &c);
+      q1 = _mm256_sub_pd (_mm256_mul_pd (sbeta2, cbeta1), _mm256_mul_pd (_mm256_mul_pd (c, sbeta1), cbeta2));
+      q2 = _mm256_mul_pd (s, cbeta2);
+      q1 = _mm256_blendv_pd (q1, tiny, _mm256_cmp_pd (q1, zero, _CMP_EQ_OQ));
+      tn = _mm256_div_pd (q2, q1);
+      az = simd_atan_avx2 (tn);
+
+
+      /*  Quadrant.  */
+
+      n = _mm256_blendv_pd (_mm256_set1_pd (3.0), _mm256_set1_pd (4.0), _mm256_cmp_pd (_mm256_mul_pd (dell, tn), zero, _CMP_LT_OQ));
+      n = _mm256_blendv_pd (n, _mm256_sub_pd (n, _mm256_set1_pd (2.0)), _mm256_cmp_pd (dell, zero, _CMP_LT_OQ));
+      n = _mm256_blendv_pd (n, one, _mm256_and_pd (_mm256_cmp_pd (q1, zero, _CMP_GT_OQ), _mm256_cmp_pd (dell, zero, _CMP_EQ_OQ)));
+
+      q1 = _mm256_blendv_pd (_mm256_sub_pd (_mm256_sub_pd (_mm256_mul_pd (n, pi), pi), az),
+                             _mm256_add_pd (_mm256_mul_pd (_mm256_sub_pd (n, _mm256_set1_pd (2.0)), pi), az),
+                             _mm256_cmp_pd (n, _mm256_set1_pd (3.0), _CMP_GE_OQ));
+      _mm256_storeu_pd (&batch->az[k], _mm256_mul_pd (q1, rad_to_deg));
+    }
+
+  return (k);
+}
+
+#endif
+
+
+
+static void invgp_batch_chunk (int64_t start, int64_t end, void *arg)
+{
+  INVGP_BATCH      *batch = (INVGP_BATCH *) arg;
+  double           az;
+  int64_t          k;
+
+
+#ifdef INVGP_SIMD
+  if (batch->avx2) start = invgp_avx2 (batch, start, end);
+#endif
+
+  for (k = start ; k < end ; k++)
+    {
+      invgp_geodesic (batch->geo, batch->rlat1[k], batch->rlon1[k], batch->rlat2[k], batch->rlon2[k], &batch->dist[k], &az);
+      if (batch->az != NULL) batch->az[k] = az;
+    }
+}
+
+
+
+/***************************************************************************/
+/*!
+
+  - Module Name:        invgp_batch
+
+  - Date Written:       October 2026
+
+  - Purpose:            Computes invgp for arrays of position pairs.  On
+                        CPUs that support AVX2 four pairs are done at a
+                        time using vectorized trig functions, and large
+                        batches are split across threads (see
+                        parallel_for).  The results agree with invgp to
+                        a few nanometers for short lines.  For lines
+                        approaching a quarter of the way around the earth
+                        they can differ by up to about a centimeter,
+                        which is less than invgp itself changes for a one
+                        bit change in the input latitude.
+
+  - Arguments:
+                        - geo      =   GEODESIC structure from init_geodesic
+                        - rlat1    =   start latitudes in degrees
+                        - rlon1    =   start longitudes in degrees
+                        - rlat2    =   end latitudes in degrees
+                        - rlon2    =   end longitudes in degrees
+                        - n        =   number of pairs
+                        - dist     =   returned distances in meters
+                        - az       =   returned azimuths in degrees (may be
+                                       NULL if they aren't needed)
+
+  - Return Value:       None
+
+****************************************************************************/
+
+void invgp_batch (GEODESIC *geo, const double *rlat1, const double *rlon1, const double *rlat2, const double *rlon2,
+                  int64_t n, double *dist, double *az)
+{
+  INVGP_BATCH      batch;
+
+
+  if (n <= 0) return;
+
+  batch.geo = geo;
+  batch.rlat1 = rlat1;
+  batch.rlon1 = rlon1;
+  batch.rlat2 = rlat2;
+  batch.rlon2 = rlon2;
+  batch.dist = dist;
+  batch.az = az;
+  batch.avx2 = 0;
+
+#ifdef INVGP_SIMD
+  batch.avx2 = __builtin_cpu_supports ("avx2");
+#endif
+
+  parallel_for (n, 16384, invgp_batch_chunk, &batch);
+}
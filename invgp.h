@@ -51,8 +51,32 @@ extern "C" {
 #include "nvdef.h"
 
 
+  /*!  Ellipsoid constants used by invgp.  Fill it in with init_geodesic.  */
+
+  typedef struct
+  {
+    double        a0;           /*!<  Semi-major axis in meters  */
+    double        b0;           /*!<  Semi-minor axis in meters  */
+    double        flat;         /*!<  Flattening  */
+    double        flat2;        /*!<  Flattening squared  */
+    double        f1;           /*!<  Series terms derived from the flattening  */
+    double        f2;
+    double        f3;
+    double        f4;
+    double        f5;
+    double        f6;
+    double        f7;
+    double        f8;
+    double        ep2;          /*!<  Second eccentricity squared ((a0^2 - b0^2) / b0^2)  */
+  } GEODESIC;
+
+
   void invgp (double a0, double b0, double rlat1, double rlon1, double rlat2,
               double rlon2, double *dist, double *az);
+  void init_geodesic (GEODESIC *geo, double a0, double b0);
+  void invgp_geodesic (GEODESIC *geo, double rlat1, double rlon1, double rlat2, double rlon2, double *dist, double *az);
+  void invgp_batch (GEODESIC *geo, const double *rlat1, const double *rlon1, const double *rlat2, const double *rlon2,
+                    int64_t n, double *dist, double *az);
 
 
 #ifdef  __cplusplus
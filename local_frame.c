@@ -0,0 +1,546 @@
+
+/*********************************************************************************************
+
+    This is public domain software that was developed by or for the U.S. Naval Oceanographic
+    Office and/or the U.S. Army Corps of Engineers.
+
+    This is a work of the U.S. Government. In accordance with 17 USC 105, copyright protection
+    is not available for any work of the U.S. Government.
+
+    Neither the United States Government, nor any employees of the United States Government,
+    nor the author, makes any warranty, express or implied, without even the implied warranty
+    of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE, or assumes any liability or
+    responsibility for the accuracy, completeness, or usefulness of any information,
+    apparatus, product, or process disclosed, or represents that its use would not infringe
+    privately-owned rights. Reference herein to any specific commercial products, process,
+    or service by trade name, trademark, manufacturer, or otherwise, does not necessarily
+    constitute or imply its endorsement, recommendation, or favoring by the United States
+    Government. The views and opinions of authors expressed herein do not necessarily state
+    or reflect those of the United States Government, and shall not be used for advertising
+    or product endorsement purposes.
+*********************************************************************************************/
+
+
+/****************************************  IMPORTANT NOTE  **********************************
+
+    Comments in this file that start with / * ! are being used by Doxygen to document the
+    software.  Dashes in these comment blocks are used to create bullet lists.  The lack of
+    blank lines after a block of dash preceeded comments means that the next block of dash
+    preceeded comments is a new, indented bullet list.  I've tried to keep the Doxygen
+    formatting to a minimum but there are some other items (like <br> and <pre>) that need
+    to be left alone.  If you see a comment that starts with / * ! and there is something
+    that looks a bit weird it is probably due to some arcane Doxygen syntax.  Be very
+    careful modifying blocks of Doxygen comments.
+
+*****************************************  IMPORTANT NOTE  **********************************/
+
+
+
+#include <string.h>
+#include <math.h>
+
+#include "nvdef.h"
+#include "parallel_for.h"
+#include "local_frame.h"
+
+
+/*  Runtime selected AVX2 kernels for the batch conversions (see simd_trig.inc).  */
+
+#include "simd_trig.inc"
+
+#ifdef SIMD_TRIG
+  #define LOCAL_FRAME_SIMD
+#endif
+
+
+/*  NV_DEG_TO_RAD is only good to about 8 digits which is far too coarse here.  */
+
+#define LOCAL_FRAME_DEG_TO_RAD  0.017453292519943295
+#define LOCAL_FRAME_RAD_TO_DEG  57.29577951308232
+
+
+/*  Number of samples along each side of the AOI used to compute the accuracy bounds.  */
+
+#define LOCAL_FRAME_SAMPLES     7
+
+
+typedef struct
+{
+  LOCAL_FRAME      *lf;
+  const double     *in0;
+  const double     *in1;
+  const double     *in2;
+  double           *out0;
+  double           *out1;
+  double           *out2;
+  int32_t          avx2;
+} LOCAL_FRAME_BATCH;
+
+
+
+static double local_frame_wrap (double dl)
+{
+  if (dl > 180.0) dl -= 360.0;
+  if (dl < -180.0) dl += 360.0;
+
+  return (dl);
+}
+
+
+
+/*  Geodetic to ECEF (in the plane of the origin's meridian) and then rotated into the origin's east, north, up
+    axes.  */
+
+static void local_frame_to_enu (LOCAL_FRAME *lf, double lat, double lon, double h, double *e, double *n, double *u)
+{
+  double           phi, dl, sp, cp, sl, cl, rn, x, z, dx, dz;
+
+
+  phi = lat * LOCAL_FRAME_DEG_TO_RAD;
+  dl = local_frame_wrap (lon - lf->lon0) * LOCAL_FRAME_DEG_TO_RAD;
+
+  sp = sin (phi);
+  cp = cos (phi);
+  sl = sin (dl);
+  cl = cos (dl);
+
+  rn = lf->geo.a0 / sqrt (1.0 - lf->e2 * sp * sp);
+
+  x = (rn + h) * cp * cl;
+  z = (rn * (1.0 - lf->e2) + h) * sp;
+
+  dx = x - lf->x0;
+  dz = z - lf->z0;
+
+  *e = (rn + h) * cp * sl;
+  *n = -lf->sin_lat0 * dx + lf->cos_lat0 * dz;
+  *u = lf->cos_lat0 * dx + lf->sin_lat0 * dz;
+}
+
+
+
+/*  The reverse of local_frame_to_enu.  Latitude and height come from Bowring's method with two iterations, which
+    is good to well under a millimeter for anything near the surface of the earth.  */
+
+static void local_frame_to_geodetic (LOCAL_FRAME *lf, double e, double n, double u, double *lat, double *lon, double *h)
+{
+  double           dx, dz, x, z, p, t, tp = 0.0, cb, sb, cp, sp;
+  int32_t          i;
+
+
+  dx = -lf->sin_lat0 * n + lf->cos_lat0 * u;
+  dz = lf->cos_lat0 * n + lf->sin_lat0 * u;
+
+  x = lf->x0 + dx;
+  z = lf->z0 + dz;
+
+  p = sqrt (x * x + e * e);
+
+  *lon = local_frame_wrap (lf->lon0 + atan2 (e, x) * LOCAL_FRAME_RAD_TO_DEG);
+
+  t = (lf->geo.a0 * z) / (lf->geo.b0 * p);
+
+  for (i = 0 ; i < 2 ; i++)
+    {
+      cb = 1.0 / sqrt (1.0 + t * t);
+      sb = t * cb;
+      tp = (z + lf->geo.ep2 * lf->geo.b0 * sb * sb * sb) / (p - lf->e2 * lf->geo.a0 * cb * cb * cb);
+      t = (lf->geo.b0 / lf->geo.a0) * tp;
+    }
+
+  cp = 1.0 / sqrt (1.0 + tp * tp);
+  sp = tp * cp;
+
+  *lat = atan (tp) * LOCAL_FRAME_RAD_TO_DEG;
+  *h = p * cp + z * sp - lf->geo.a0 * sqrt (1.0 - lf->e2 * sp * sp);
+}
+
+
+
+/***************************************************************************/
+/*!
+
+  - Module Name:        init_local_frame
+
+  - Date Written:       October 2026
+
+  - Purpose:            Sets up a local east-north-up (tangent plane) frame
+                        at an origin so that positions inside an area of
+                        interest can be converted to meters (see
+                        geodetic_to_enu and enu_to_geodetic) and distance,
+                        azimuth, and offset computations can be done with
+                        plain 2D vector math on the east and north values.
+
+                        The conversions themselves are exact (they go
+                        through earth centered coordinates) but treating
+                        east and north as a flat plane is not.  If an AOI
+                        is given we compare 2D ENU distances and azimuths
+                        against invgp over a grid of positions covering the
+                        AOI and store the largest errors in the frame
+                        (max_distance_error, max_relative_error, and
+                        max_azimuth_error) so the caller can decide whether
+                        the frame is good enough for the job.
+
+  - Arguments:
+                        - lf       =   LOCAL_FRAME structure to fill in
+                        - a0       =   semi-major axis in meters
+                        - b0       =   semi-minor axis in meters
+                        - lat0     =   origin latitude in degrees
+                        - lon0     =   origin longitude in degrees
+                        - h0       =   origin ellipsoid height in meters
+                        - aoi      =   area of interest (X is longitude, Y is
+                                       latitude) or NULL to skip computing
+                                       the accuracy bounds (they'll be 0.0)
+
+  - Return Value:       None
+
+****************************************************************************/
+
+void init_local_frame (LOCAL_FRAME *lf, double a0, double b0, double lat0, double lon0, double h0, NV_F64_XYMBR *aoi)
+{
+  double           rn, lat[LOCAL_FRAME_SAMPLES * LOCAL_FRAME_SAMPLES], lon[LOCAL_FRAME_SAMPLES * LOCAL_FRAME_SAMPLES],
+                   e[LOCAL_FRAME_SAMPLES * LOCAL_FRAME_SAMPLES], n[LOCAL_FRAME_SAMPLES * LOCAL_FRAME_SAMPLES], u, dist,
+                   az, enu_dist, enu_az, err;
+  int32_t          i, j, count;
+
+
+  memset (lf, 0, sizeof (LOCAL_FRAME));
+
+  init_geodesic (&lf->geo, a0, b0);
+
+  lf->e2 = (a0 * a0 - b0 * b0) / (a0 * a0);
+  lf->lat0 = lat0;
+  lf->lon0 = lon0;
+  lf->h0 = h0;
+  lf->sin_lat0 = sin (lat0 * LOCAL_FRAME_DEG_TO_RAD);
+  lf->cos_lat0 = cos (lat0 * LOCAL_FRAME_DEG_TO_RAD);
+
+  rn = a0 / sqrt (1.0 - lf->e2 * lf->sin_lat0 * lf->sin_lat0);
+  lf->x0 = (rn + h0) * lf->cos_lat0;
+  lf->z0 = (rn * (1.0 - lf->e2) + h0) * lf->sin_lat0;
+
+  if (aoi == NULL) return;
+
+
+  /*  Sample the AOI and compare against invgp.  */
+
+  count = 0;
+  for (i = 0 ; i < LOCAL_FRAME_SAMPLES ; i++)
+    {
+      for (j = 0 ; j < LOCAL_FRAME_SAMPLES ; j++)
+        {
+          lat[count] = aoi->min_y + (aoi->max_y - aoi->min_y) * (double) i / (double) (LOCAL_FRAME_SAMPLES - 1);
+          lon[count] = aoi->min_x + (aoi->max_x - aoi->min_x) * (double) j / (double) (LOCAL_FRAME_SAMPLES - 1);
+
+          local_frame_to_enu (lf, lat[count], lon[count], 0.0, &e[count], &n[count], &u);
+
+          invgp_geodesic (&lf->geo, lat0, lon0, lat[count], lon[count], &dist, &az);
+          lf->radius = MAX (lf->radius, dist);
+
+          count++;
+        }
+    }
+
+  for (i = 0 ; i < count ; i++)
+    {
+      for (j = i + 1 ; j < count ; j++)
+        {
+          invgp_geodesic (&lf->geo, lat[i], lon[i], lat[j], lon[j], &dist, &az);
+
+          enu_dist = sqrt ((e[j] - e[i]) * (e[j] - e[i]) + (n[j] - n[i]) * (n[j] - n[i]));
+          err = fabs (enu_dist - dist);
+
+          lf->max_distance_error = MAX (lf->max_distance_error, err);
+          if (dist > 1.0) lf->max_relative_error = MAX (lf->max_relative_error, err / dist);
+
+
+          /*  Azimuths of very short lines are meaningless.  */
+
+          if (dist > 1.0)
+            {
+              enu_az = atan2 (e[j] - e[i], n[j] - n[i]) * LOCAL_FRAME_RAD_TO_DEG;
+              err = fabs (local_frame_wrap (enu_az - az));
+              lf->max_azimuth_error = MAX (lf->max_azimuth_error, err);
+            }
+        }
+    }
+}
+
+
+
+#ifdef LOCAL_FRAME_SIMD
+
+__attribute__ ((target ("avx2")))
+static inline __m256d local_frame_wrap_avx2 (__m256d dl)
+{
+  dl = _mm256_blendv_pd (dl, _mm256_sub_pd (dl, _mm256_set1_pd (360.0)), _mm256_cmp_pd (dl, _mm256_set1_pd (180.0), _CMP_GT_OQ));
+  dl = _mm256_blendv_pd (dl, _mm256_add_pd (dl, _mm256_set1_pd (360.0)), _mm256_cmp_pd (dl, _mm256_set1_pd (-180.0), _CMP_LT_OQ));
+
+  return (dl);
+}
+
+
+
+/*  local_frame_to_enu four positions at a time.  Returns the index of the first position that wasn't done.  */
+
+__attribute__ ((target ("avx2")))
+static int64_t local_frame_to_enu_avx2 (LOCAL_FRAME_BATCH *batch, int64_t start, int64_t end)
+{
+  LOCAL_FRAME      *lf = batch->lf;
+  __m256d          one, d2r, lon0, e2, a0, x0, z0, s0, c0, phi, dl, h, sp, cp, sl, cl, rn, rh, x, z, dx, dz;
+  int64_t          k;
+
+
+  one = _mm256_set1_pd (1.0);
+  d2r = _mm256_set1_pd (LOCAL_FRAME_DEG_TO_RAD);
+  lon0 = _mm256_set1_pd (lf->lon0);
+  e2 = _mm256_set1_pd (lf->e2);
+  a0 = _mm256_set1_pd (lf->geo.a0);
+  x0 = _mm256_set1_pd (lf->x0);
+  z0 = _mm256_set1_pd (lf->z0);
+  s0 = _mm256_set1_pd (lf->sin_lat0);
+  c0 = _mm256_set1_pd (lf->cos_lat0);
+  h = _mm256_setzero_pd ();
+
+  for (k = start ; k + 4 <= end ; k += 4)
+    {
+      phi = _mm256_mul_pd (_mm256_loadu_pd (&batch->in0[k]), d2r);
+      dl = _mm256_mul_pd (local_frame_wrap_avx2 (_mm256_sub_pd (_mm256_loadu_pd (&batch->in1[k]), lon0)), d2r);
+      if (batch->in2 != NULL) h = _mm256_loadu_pd (&batch->in2[k]);
+
+      simd_sincos_avx2 (phi, &sp, &cp);
+      simd_sincos_avx2 (dl, &sl, &cl);
+
+      rn = _mm256_div_pd (a0, _mm256_sqrt_pd (_mm256_sub_pd (one, _mm256_mul_pd (_mm256_mul_pd (e2, sp), sp))));
+      rh = _mm256_mul_pd (_mm256_add_pd (rn, h), cp);
+
+      x = _mm256_mul_pd (rh, cl);
+      z = _mm256_mul_pd (_mm256_add_pd (_mm256_mul_pd (rn, _mm256_sub_pd (one, e2)), h), sp);
+
+      dx = _mm256_sub_pd (x, x0);
+      dz = _mm256_sub_pd (z, z0);
+
+      _mm256_storeu_pd (&batch->out0[k], _mm256_mul_pd (rh, sl));
+      _mm256_storeu_pd (&batch->out1[k], _mm256_sub_pd (_mm256_mul_pd (c0, dz), _mm256_mul_pd (s0, dx)));
+      if (batch->out2 != NULL) _mm256_storeu_pd (&batch->out2[k], _mm256_add_pd (_mm256_mul_pd (c0, dx), _mm256_mul_pd (s0, dz)));
+    }
+
+  return (k);
+}
+
+
+
+/*  local_frame_to_geodetic four positions at a time.  Returns the index of the first position that wasn't
+    done.  */
+
+__attribute__ ((target ("avx2")))
+static int64_t local_frame_to_geodetic_avx2 (LOCAL_FRAME_BATCH *batch, int64_t start, int64_t end)
+{
+  LOCAL_FRAME      *lf = batch->lf;
+  __m256d          one, r2d, lon0, e2, a0, b0, ep2b, e2a, ba, x0, z0, s0, c0, e, n, u, dx, dz, x, z, p, t, tp, cb,
+                   sb, cp, sp;
+  int64_t          k;
+  int32_t          i;
+
+
+  one = _mm256_set1_pd (1.0);
+  r2d = _mm256_set1_pd (LOCAL_FRAME_RAD_TO_DEG);
+  lon0 = _mm256_set1_pd (lf->lon0);
+  e2 = _mm256_set1_pd (lf->e2);
+  a0 = _mm256_set1_pd (lf->geo.a0);
+  b0 = _mm256_set1_pd (lf->geo.b0);
+  ep2b = _mm256_set1_pd (lf->geo.ep2 * lf->geo.b0);
+  e2a = _mm256_set1_pd (lf->e2 * lf->geo.a0);
+  ba = _mm256_set1_pd (lf->geo.b0 / lf->geo.a0);
+  x0 = _mm256_set1_pd (lf->x0);
+  z0 = _mm256_set1_pd (lf->z0);
+  s0 = _mm256_set1_pd (lf->sin_lat0);
+  c0 = _mm256_set1_pd (lf->cos_lat0);
+  u = _mm256_setzero_pd ();
+
+  for (k = start ; k + 4 <= end ; k += 4)
+    {
+      e = _mm256_loadu_pd (&batch->in0[k]);
+      n = _mm256_loadu_pd (&batch->in1[k]);
+      if (batch->in2 != NULL) u = _mm256_loadu_pd (&batch->in2[k]);
+
+      dx = _mm256_sub_pd (_mm256_mul_pd (c0, u), _mm256_mul_pd (s0, n));
+      dz = _mm256_add_pd (_mm256_mul_pd (c0, n), _mm256_mul_pd (s0, u));
+
+      x = _mm256_add_pd (x0, dx);
+      z = _mm256_add_pd (z0, dz);
+
+      p = _mm256_sqrt_pd (_mm256_add_pd (_mm256_mul_pd (x, x), _mm256_mul_pd (e, e)));
+
+      _mm256_storeu_pd (&batch->out1[k], local_frame_wrap_avx2 (_mm256_add_pd (lon0, _mm256_mul_pd (simd_atan2_avx2 (e, x), r2d))));
+
+      t = _mm256_div_pd (_mm256_mul_pd (a0, z), _mm256_mul_pd (b0, p));
+      tp = t;
+
+      for (i = 0 ; i < 2 ; i++)
+        {
+          cb = _mm256_div_pd (one, _mm256_sqrt_pd (_mm256_add_pd (one, _mm256_mul_pd (t, t))));
+          sb = _mm256_mul_pd (t, cb);
+          tp = _mm256_div_pd (_mm256_add_pd (z, _mm256_mul_pd (ep2b, _mm256_mul_pd (_mm256_mul_pd (sb, sb), sb))),
+                              _mm256_sub_pd (p, _mm256_mul_pd (e2a, _mm256_mul_pd (_mm256_mul_pd (cb, cb), cb))));
+          t = _mm256_mul_pd (ba, tp);
+        }
+
+      cp = _mm256_div_pd (one, _mm256_sqrt_pd (_mm256_add_pd (one, _mm256_mul_pd (tp, tp))));
+      sp = _mm256_mul_pd (tp, cp);
+
+      _mm256_storeu_pd (&batch->out0[k], _mm256_mul_pd (simd_atan_avx2 (tp), r2d));
+
+      if (batch->out2 != NULL)
+        {
+          _mm256_storeu_pd (&batch->out2[k],
+                            _mm256_sub_pd (_mm256_add_pd (_mm256_mul_pd (p, cp), _mm256_mul_pd (z, sp)),
+                                           _mm256_mul_pd (a0, _mm256_sqrt_pd (_mm256_sub_pd (one, _mm256_mul_pd (_mm256_mul_pd (e2, sp), sp))))));
+        }
+    }
+
+  return (k);
+}
+
+#endif
+
+
+
+static void local_frame_to_enu_chunk (int64_t start, int64_t end, void *arg)
+{
+  LOCAL_FRAME_BATCH *batch = (LOCAL_FRAME_BATCH *) arg;
+  double            u;
+  int64_t           k;
+
+
+#ifdef LOCAL_FRAME_SIMD
+  if (batch->avx2) start = local_frame_to_enu_avx2 (batch, start, end);
+#endif
+
+  for (k = start ; k < end ; k++)
+    {
+      local_frame_to_enu (batch->lf, batch->in0[k], batch->in1[k], batch->in2 != NULL ? batch->in2[k] : 0.0,
+                          &batch->out0[k], &batch->out1[k], &u);
+      if (batch->out2 != NULL) batch->out2[k] = u;
+    }
+}
+
+
+
+static void local_frame_to_geodetic_chunk (int64_t start, int64_t end, void *arg)
+{
+  LOCAL_FRAME_BATCH *batch = (LOCAL_FRAME_BATCH *) arg;
+  double            h;
+  int64_t           k;
+
+
+#ifdef LOCAL_FRAME_SIMD
+  if (batch->avx2) start = local_frame_to_geodetic_avx2 (batch, start, end);
+#endif
+
+  for (k = start ; k < end ; k++)
+    {
+      local_frame_to_geodetic (batch->lf, batch->in0[k], batch->in1[k], batch->in2 != NULL ? batch->in2[k] : 0.0,
+                               &batch->out0[k], &batch->out1[k], &h);
+      if (batch->out2 != NULL) batch->out2[k] = h;
+    }
+}
+
+
+
+static void local_frame_run (LOCAL_FRAME *lf, const double *in0, const double *in1, const double *in2, int64_t n,
+                             double *out0, double *out1, double *out2, PARALLEL_FOR_FUNC func)
+{
+  LOCAL_FRAME_BATCH batch;
+
+
+  if (n <= 0) return;
+
+  batch.lf = lf;
+  batch.in0 = in0;
+  batch.in1 = in1;
+  batch.in2 = in2;
+  batch.out0 = out0;
+  batch.out1 = out1;
+  batch.out2 = out2;
+  batch.avx2 = 0;
+
+#ifdef LOCAL_FRAME_SIMD
+  batch.avx2 = __builtin_cpu_supports ("avx2");
+#endif
+
+  parallel_for (n, 16384, func, &batch);
+}
+
+
+
+/***************************************************************************/
+/*!
+
+  - Module Name:        geodetic_to_enu
+
+  - Date Written:       October 2026
+
+  - Purpose:            Converts arrays of geodetic positions to east,
+                        north, and up meters in a LOCAL_FRAME.  On CPUs
+                        that support AVX2 four positions are done at a time
+                        and large batches are split across threads (see
+                        parallel_for).
+
+  - Arguments:
+                        - lf       =   LOCAL_FRAME from init_local_frame
+                        - lat      =   latitudes in degrees
+                        - lon      =   longitudes in degrees
+                        - h        =   ellipsoid heights in meters (NULL for
+                                       0.0)
+                        - n        =   number of positions
+                        - e        =   returned east values in meters
+                        - nn       =   returned north values in meters
+                        - u        =   returned up values in meters (may be
+                                       NULL)
+
+  - Return Value:       None
+
+****************************************************************************/
+
+void geodetic_to_enu (LOCAL_FRAME *lf, const double *lat, const double *lon, const double *h, int64_t n, double *e,
+                      double *nn, double *u)
+{
+  local_frame_run (lf, lat, lon, h, n, e, nn, u, local_frame_to_enu_chunk);
+}
+
+
+
+/***************************************************************************/
+/*!
+
+  - Module Name:        enu_to_geodetic
+
+  - Date Written:       October 2026
+
+  - Purpose:            Converts arrays of east, north, and up meters in a
+                        LOCAL_FRAME back to geodetic positions.  This is
+                        the reverse of geodetic_to_enu.  Positions within
+                        a few tens of kilometers of the ellipsoid round trip
+                        to well under a millimeter.
+
+  - Arguments:
+                        - lf       =   LOCAL_FRAME from init_local_frame
+                        - e        =   east values in meters
+                        - nn       =   north values in meters
+                        - u        =   up values in meters (NULL for 0.0)
+                        - n        =   number of positions
+                        - lat      =   returned latitudes in degrees
+                        - lon      =   returned longitudes in degrees
+                        - h        =   returned ellipsoid heights in meters
+                                       (may be NULL)
+
+  - Return Value:       None
+
+****************************************************************************/
+
+void enu_to_geodetic (LOCAL_FRAME *lf, const double *e, const double *nn, const double *u, int64_t n, double *lat,
+                      double *lon, double *h)
+{
+  local_frame_run (lf, e, nn, u, n, lat, lon, h, local_frame_to_geodetic_chunk);
+}
@@ -0,0 +1,84 @@
+
+/*********************************************************************************************
+
+    This is public domain software that was developed by or for the U.S. Naval Oceanographic
+    Office and/or the U.S. Army Corps of Engineers.
+
+    This is a work of the U.S. Government. In accordance with 17 USC 105, copyright protection
+    is not available for any work of the U.S. Government.
+
+    Neither the United States Government, nor any employees of the United States Government,
+    nor the author, makes any warranty, express or implied, without even the implied warranty
+    of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE, or assumes any liability or
+    responsibility for the accuracy, completeness, or usefulness of any information,
+    apparatus, product, or process disclosed, or represents that its use would not infringe
+    privately-owned rights. Reference herein to any specific commercial products, process,
+    or service by trade name, trademark, manufacturer, or otherwise, does not necessarily
+    constitute or imply its endorsement, recommendation, or favoring by the United States
+    Government. The views and opinions of authors expressed herein do not necessarily state
+    or reflect those of the United States Government, and shall not be used for advertising
+    or product endorsement purposes.
+*********************************************************************************************/
+
+
+/****************************************  IMPORTANT NOTE  **********************************
+
+    Comments in this file that start with / * ! are being used by Doxygen to document the
+    software.  Dashes in these comment blocks are used to create bullet lists.  The lack of
+    blank lines after a block of dash preceeded comments means that the next block of dash
+    preceeded comments is a new, indented bullet list.  I've tried to keep the Doxygen
+    formatting to a minimum but there are some other items (like <br> and <pre>) that need
+    to be left alone.  If you see a comment that starts with / * ! and there is something
+    that looks a bit weird it is probably due to some arcane Doxygen syntax.  Be very
+    careful modifying blocks of Doxygen comments.
+
+*****************************************  IMPORTANT NOTE  **********************************/
+
+
+
+#ifndef _LOCAL_FRAME_H_
+#define _LOCAL_FRAME_H_
+
+#ifdef  __cplusplus
+extern "C" {
+#endif
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "pfm_nvtypes.h"
+#include "invgp.h"
+
+
+  /*!  Local east-north-up frame.  Fill it in with init_local_frame.  */
+
+  typedef struct
+  {
+    GEODESIC      geo;                  /*!<  Ellipsoid  */
+    double        e2;                   /*!<  First eccentricity squared  */
+    double        lat0;                 /*!<  Origin latitude (degrees)  */
+    double        lon0;                 /*!<  Origin longitude (degrees)  */
+    double        h0;                   /*!<  Origin ellipsoid height (meters)  */
+    double        sin_lat0;             /*!<  Sine of the origin latitude  */
+    double        cos_lat0;             /*!<  Cosine of the origin latitude  */
+    double        x0;                   /*!<  Origin X in the frame's meridian plane (meters)  */
+    double        z0;                   /*!<  Origin Z (meters)  */
+    double        radius;               /*!<  Largest distance from the origin to the AOI (meters)  */
+    double        max_distance_error;   /*!<  Largest difference between 2D ENU and invgp distances in the AOI (meters)  */
+    double        max_relative_error;   /*!<  Largest 2D ENU distance error as a fraction of the distance  */
+    double        max_azimuth_error;    /*!<  Largest difference between 2D ENU and invgp azimuths in the AOI (degrees)  */
+  } LOCAL_FRAME;
+
+
+  void init_local_frame (LOCAL_FRAME *lf, double a0, double b0, double lat0, double lon0, double h0, NV_F64_XYMBR *aoi);
+  void geodetic_to_enu (LOCAL_FRAME *lf, const double *lat, const double *lon, const double *h, int64_t n, double *e,
+                        double *nn, double *u);
+  void enu_to_geodetic (LOCAL_FRAME *lf, const double *e, const double *nn, const double *u, int64_t n, double *lat,
+                        double *lon, double *h);
+
+
+#ifdef  __cplusplus
+}
+#endif
+
+#endif
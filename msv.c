@@ -60,9 +60,24 @@
 
 */
 
+#include <stdlib.h>
+#include <string.h>
+
+#include "nvdef.h"
+#include "parallel_for.h"
 #include "msv.h"
 #include "linterp.h" /* get proto. for ptslope */
 
+
+/* work description for msv_batch */
+
+typedef struct
+{
+  MSV_PROFILE    *profile;
+  const double   *z;
+  double         *out;
+} MSV_BATCH;
+
 /******************************************************************************/
 
 int32_t prephmc (int32_t nin, double *zin, double *cin, double *z, double *c, double *t, double *h)
@@ -247,3 +262,224 @@ double amsv (int32_t n, double *z, double *c, double *t, double *a, double z1)
   return (z1/t1);
 } /* amsv */
 #endif
+
+
+
+/******************************************************************************/
+/*!
+
+  - create_msv_profile
+
+  - purpose:  prepare a profile (from prephmc/makhmc or makamc) for
+              msv_profile and msv_batch.  the layer holding a depth is
+              found with a uniform depth lookup table and a binary search
+              of the (usually one or two) layers in the bin instead of a
+              scan from the surface.  the arrays are copied so the caller
+              can free them.
+
+  - arguments:
+              - n           =   number of points in the profile
+              - z, c, t, h  =   profile from prephmc/makhmc or makamc
+              - arithmetic  =   set if t and h came from makamc
+
+  - returns:  profile (free with free_msv_profile) or NULL on error
+
+*/
+
+MSV_PROFILE *create_msv_profile (int32_t n, double *z, double *c, double *t, double *h, uint8_t arithmetic)
+{
+  MSV_PROFILE *profile;
+  int32_t i, b;
+  double zb;
+
+  if (n < 2) return (NULL);
+
+  if ((profile = (MSV_PROFILE *) calloc (1, sizeof (MSV_PROFILE))) == NULL)
+    {
+      perror ("Allocating MSV_PROFILE in create_msv_profile");
+      return (NULL);
+    }
+
+  profile->n = n;
+  profile->arithmetic = arithmetic;
+  profile->z = (double *) malloc (4 * n * sizeof (double));
+
+  if (profile->z == NULL)
+    {
+      perror ("Allocating profile memory in create_msv_profile");
+      free (profile);
+      return (NULL);
+    }
+
+  profile->c = &profile->z[n];
+  profile->t = &profile->z[2 * n];
+  profile->h = &profile->z[3 * n];
+
+  memcpy (profile->z, z, n * sizeof (double));
+  memcpy (profile->c, c, n * sizeof (double));
+  memcpy (profile->t, t, n * sizeof (double));
+  memcpy (profile->h, h, n * sizeof (double));
+
+
+  /* lookup table - about four bins per layer.  if we can't get the memory we just binary search the whole profile */
+
+  profile->lut_size = MIN (MAX (4 * n, 256), 65536);
+  profile->lut_dz = (z[n - 1] - z[0]) / profile->lut_size;
+
+  if (!(profile->lut_dz > 0.0) || (profile->lut = (int32_t *) malloc ((profile->lut_size + 1) * sizeof (int32_t))) == NULL)
+    {
+      profile->lut_size = 0;
+      return (profile);
+    }
+
+  for (b = 0, i = 0 ; b <= profile->lut_size ; b++)
+    {
+      zb = z[0] + b * profile->lut_dz;
+      while (i < n - 1 && z[i] < zb) i++;
+      profile->lut[b] = i;
+    }
+
+  return (profile);
+} /* create_msv_profile */
+
+
+
+/******************************************************************************/
+/*!
+
+  - msv_profile
+
+  - purpose:  same as msv (or amsv if the profile came from makamc) for
+              a prepared profile.  the results are identical.
+
+  - returns:  mean sounding velocity at depth z1 or -1000000.0 if z1 is
+              out of range
+
+*/
+
+double msv_profile (MSV_PROFILE *profile, double z1)
+{
+  int32_t lo, hi, mid, b, j;
+  double *z = profile->z, *c = profile->c, *t = profile->t, dz, gradient, t1, c1;
+
+  /* written this way so that NaN depths are out of range */
+
+  if (!(z1 >= z[0] && z1 <= z[profile->n - 1])) return (-1000000.0);
+
+  if (z1 == z[0]) return (c[0]);
+
+
+  /* find the first point at or below z1, starting with the points in z1's lookup table bin */
+
+  lo = 0;
+  hi = profile->n - 1;
+
+  if (profile->lut_size)
+    {
+      b = (int32_t) ((z1 - z[0]) / profile->lut_dz);
+      if (b < 0) b = 0;
+      if (b >= profile->lut_size) b = profile->lut_size - 1;
+
+      if ((profile->lut[b] == 0 || z[profile->lut[b] - 1] < z1) && z[profile->lut[b + 1]] >= z1)
+        {
+          lo = profile->lut[b];
+          hi = profile->lut[b + 1];
+        }
+    }
+
+  while (lo < hi)
+    {
+      mid = (lo + hi) / 2;
+      if (z[mid] < z1)
+        {
+          lo = mid + 1;
+        }
+      else
+        {
+          hi = mid;
+        }
+    }
+
+  if (z1 == z[lo]) return (profile->h[lo]);
+
+  j = lo - 1;
+
+  dz = z1 - z[j];
+  c1 = ptslope (z[j], c[j], z[j + 1], c[j + 1], z1);
+  if (c1 == LINTERP_NODATA) return (-1000000.0);
+
+  if (profile->arithmetic)
+    {
+      t1 = t[j] + dz / (c[j] + 0.5 * (c1 - c[j]));
+    }
+  else
+    {
+      gradient = (c1 - c[j]) / dz;
+      if (gradient == 0) /* layer of constant sound speed */
+        {
+          t1 = t[j] + dz / c[j];
+        }
+      else /* for a linearly changing sound speed b/w layers */
+        {
+          t1 = t[j] + log (c1 / c[j]) / gradient;
+        }
+    }
+
+  return (z1/t1);
+} /* msv_profile */
+
+
+
+static void msv_batch_chunk (int64_t start, int64_t end, void *arg)
+{
+  MSV_BATCH *batch = (MSV_BATCH *) arg;
+  int64_t i;
+
+  for (i = start ; i < end ; i++) batch->out[i] = msv_profile (batch->profile, batch->z[i]);
+} /* msv_batch_chunk */
+
+
+
+/******************************************************************************/
+/*!
+
+  - msv_batch
+
+  - purpose:  msv_profile for an array of depths (e.g. all of the beams
+              of a swath file).  large batches are split across threads
+              (see parallel_for).
+
+  - arguments:
+              - profile     =   from create_msv_profile
+              - z           =   depths
+              - n           =   number of depths
+              - out         =   returned mean sounding velocities
+                                (-1000000.0 for depths out of range)
+
+*/
+
+void msv_batch (MSV_PROFILE *profile, const double *z, int64_t n, double *out)
+{
+  MSV_BATCH batch;
+
+  if (n <= 0) return;
+
+  batch.profile = profile;
+  batch.z = z;
+  batch.out = out;
+
+  parallel_for (n, 65536, msv_batch_chunk, &batch);
+} /* msv_batch */
+
+
+
+/******************************************************************************/
+
+void free_msv_profile (MSV_PROFILE *profile)
+{
+  if (profile == NULL) return;
+
+  free (profile->z);
+  free (profile->lut);
+  free (profile);
+} /* free_msv_profile */
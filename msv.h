@@ -77,9 +77,30 @@ typedef struct
   double         *h;
 } MSV;
 
+
+/*! Prepared sound velocity profile for msv_profile and msv_batch (see create_msv_profile). */
+
+typedef struct
+{
+  int32_t        n;             /*!< number of points in the profile */
+  double         *z;            /*!< depths */
+  double         *c;            /*!< sound speeds */
+  double         *t;            /*!< one way travel times from makhmc or makamc */
+  double         *h;            /*!< mean sounding velocities from makhmc or makamc */
+  uint8_t        arithmetic;    /*!< set if t and h came from makamc (amsv) instead of makhmc (msv) */
+  int32_t        lut_size;      /*!< number of uniform depth bins in lut (0 if there is no lut) */
+  double         lut_dz;        /*!< depth bin size */
+  int32_t        *lut;          /*!< index of the first point at or below the top of each bin (lut_size + 1 of them) */
+} MSV_PROFILE;
+
+
 int32_t prephmc (int32_t nin, double *zin, double *cin, double *z, double *c, double *t, double *h);
 void makhmc (int32_t n, double *z, double *c, double *t, double *h);
 double msv (int32_t n, double *z, double *c, double *t, double *h, double z1);
+MSV_PROFILE *create_msv_profile (int32_t n, double *z, double *c, double *t, double *h, uint8_t arithmetic);
+double msv_profile (MSV_PROFILE *profile, double z1);
+void msv_batch (MSV_PROFILE *profile, const double *z, int64_t n, double *out);
+void free_msv_profile (MSV_PROFILE *profile);
 
 #if defined (ARITHMETIC_VS_HARMONIC)
 
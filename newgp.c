@@ -38,8 +38,57 @@
 
 /* newgp.c */
 
+#include <math.h>
+
+#include "nvdef.h"
+#include "parallel_for.h"
 #include "newgp.h"
 
+
+/*  Runtime selected AVX2 kernel for newgp_batch (see simd_trig.inc).  */
+
+#include "simd_trig.inc"
+
+#ifdef SIMD_TRIG
+  #define NEWGP_SIMD
+#endif
+
+
+/*  Constants from direct.c.  */
+
+#define NEWGP_AXIS          6378137.0
+#define NEWGP_ESQ           6.69438002292318e-3
+#define NEWGP_Z2            0.1104825480468667
+#define NEWGP_Z3            21.25880271589918
+#define NEWGP_Z4            5048.250737106752
+#define NEWGP_Z1            6367449.145771138
+#define NEWGP_W2            0.23832988623869
+#define NEWGP_W3            29.36926254762117
+#define NEWGP_W4            5022.894084128594
+#define NEWGP_W1            0.1570487611454482e-6
+#define NEWGP_ARC1          0.484813681110e-5
+
+
+/*  NV_DEG_TO_RAD is only good to about 8 digits which is far too coarse for newgp_geodesic.  */
+
+#define NEWGP_DEG_TO_RAD    0.017453292519943295
+#define NEWGP_RAD_TO_DEG    57.29577951308232
+
+
+typedef struct
+{
+  GEODESIC         *geo;
+  const double     *latobs;
+  const double     *lonobs;
+  int32_t          origin_step;
+  const double     *az;
+  const double     *dist;
+  double           *lat;
+  double           *lon;
+  int32_t          avx2;
+} NEWGP_BATCH;
+
+
 /******************************************************************************/
 /*!
 
@@ -94,3 +143,373 @@ double azNtoS(double azFromNorth)
 	return azFromSouth;
 
 } /* azNtoS */
+
+
+
+/***************************************************************************/
+/*!
+
+  - Module Name:        newgp_geodesic
+
+  - Date Written:       October 2026
+
+  - Purpose:            Same as newgp but using Vincenty's direct solution
+                        on the ellipsoid in "geo" (see init_geodesic).
+                        Unlike direct (which newgp uses) this works for any
+                        ellipsoid and any distance.
+
+  - Arguments:
+                        - geo      =   GEODESIC structure from init_geodesic
+                        - latobs   =   latitude of the observed position
+                                       (degrees)
+                        - lonobs   =   longitude of the observed position
+                                       (degrees)
+                        - az       =   azimuth from north (degrees)
+                        - dist     =   distance in meters
+                        - lat      =   returned latitude (degrees)
+                        - lon      =   returned longitude (degrees)
+
+  - Return Value:       None
+
+****************************************************************************/
+
+void newgp_geodesic (GEODESIC *geo, double latobs, double lonobs, double az, double dist, double *lat, double *lon)
+{
+  double           alpha1, sin_alpha1, cos_alpha1, tan_u1, cos_u1, sin_u1, sigma1, sin_alpha, cos_sq_alpha, u_sq,
+                   a, b, sigma, sigma_p, cos_2sigma_m = 0.0, sin_sigma = 0.0, cos_sigma = 1.0, delta_sigma, tmp, c,
+                   l;
+  int32_t          i;
+
+
+  if (dist == 0.0)
+    {
+      *lat = latobs;
+      *lon = lonobs;
+      return;
+    }
+
+  alpha1 = az * NEWGP_DEG_TO_RAD;
+  sin_alpha1 = sin (alpha1);
+  cos_alpha1 = cos (alpha1);
+
+  tan_u1 = (1.0 - geo->flat) * tan (latobs * NEWGP_DEG_TO_RAD);
+  cos_u1 = 1.0 / sqrt (1.0 + tan_u1 * tan_u1);
+  sin_u1 = tan_u1 * cos_u1;
+
+  sigma1 = atan2 (tan_u1, cos_alpha1);
+  sin_alpha = cos_u1 * sin_alpha1;
+  cos_sq_alpha = 1.0 - sin_alpha * sin_alpha;
+  u_sq = cos_sq_alpha * geo->ep2;
+  a = 1.0 + u_sq / 16384.0 * (4096.0 + u_sq * (-768.0 + u_sq * (320.0 - 175.0 * u_sq)));
+  b = u_sq / 1024.0 * (256.0 + u_sq * (-128.0 + u_sq * (74.0 - 47.0 * u_sq)));
+
+
+  /*  Iterate until the change in sigma is negligible (it usually takes two or three passes).  */
+
+  sigma = dist / (geo->b0 * a);
+
+  for (i = 0 ; i < 100 ; i++)
+    {
+      cos_2sigma_m = cos (2.0 * sigma1 + sigma);
+      sin_sigma = sin (sigma);
+      cos_sigma = cos (sigma);
+      delta_sigma = b * sin_sigma * (cos_2sigma_m + b / 4.0 * (cos_sigma * (-1.0 + 2.0 * cos_2sigma_m * cos_2sigma_m) -
+                                                               b / 6.0 * cos_2sigma_m * (-3.0 + 4.0 * sin_sigma * sin_sigma) *
+                                                               (-3.0 + 4.0 * cos_2sigma_m * cos_2sigma_m)));
+      sigma_p = sigma;
+      sigma = dist / (geo->b0 * a) + delta_sigma;
+
+      if (fabs (sigma - sigma_p) < 1.0e-12) break;
+    }
+
+  cos_2sigma_m = cos (2.0 * sigma1 + sigma);
+  sin_sigma = sin (sigma);
+  cos_sigma = cos (sigma);
+
+  tmp = sin_u1 * sin_sigma - cos_u1 * cos_sigma * cos_alpha1;
+  *lat = atan2 (sin_u1 * cos_sigma + cos_u1 * sin_sigma * cos_alpha1,
+                (1.0 - geo->flat) * sqrt (sin_alpha * sin_alpha + tmp * tmp)) * NEWGP_RAD_TO_DEG;
+
+  l = atan2 (sin_sigma * sin_alpha1, cos_u1 * cos_sigma - sin_u1 * sin_sigma * cos_alpha1);
+  c = geo->flat / 16.0 * cos_sq_alpha * (4.0 + geo->flat * (4.0 - 3.0 * cos_sq_alpha));
+  l -= (1.0 - c) * geo->flat * sin_alpha *
+    (sigma + c * sin_sigma * (cos_2sigma_m + c * cos_sigma * (-1.0 + 2.0 * cos_2sigma_m * cos_2sigma_m)));
+
+  *lon = lonobs + l * NEWGP_RAD_TO_DEG;
+
+  if (*lon > 180.0) *lon -= 360.0;
+  if (*lon < -180.0) *lon += 360.0;
+}
+
+
+
+#ifdef NEWGP_SIMD
+
+/*  direct_angle from direct.h.  */
+
+__attribute__ ((target ("avx2")))
+static inline __m256d newgp_angle_avx2 (__m256d omg, __m256d sn, __m256d cs, double c4, __m256d css, double c3, double c2)
+{
+  __m256d          t;
+
+  t = _mm256_add_pd (_mm256_set1_pd (c3), _mm256_mul_pd (_mm256_set1_pd (c2), css));
+  t = _mm256_add_pd (_mm256_set1_pd (c4), _mm256_mul_pd (css, t));
+
+  return (_mm256_add_pd (omg, _mm256_mul_pd (_mm256_mul_pd (_mm256_mul_pd (sn, cs), _mm256_set1_pd (1.0e-6)), t)));
+}
+
+
+
+/*  newgp (i.e. direct) for four positions at a time.  This is the same arithmetic, in the same order, as newgp,
+    azNtoS, and direct so the only differences come from the trig functions.  Returns the index of the first
+    position that wasn't done.  */
+
+__attribute__ ((target ("avx2")))
+static int64_t newgp_avx2 (NEWGP_BATCH *batch, int64_t start, int64_t end)
+{
+  __m256d          one, zero, sign_bit, tiny, latobs, lonobs, az, s, fazj, sn, cs, x, y, b, phj, sina, cosa, u, ef,
+                   xcor, xpri, a, ycor, ypri, cssq, y0, y1, omega, sin1, cos1, css1, phi1, faca, v, va, y2, tn, facb,
+                   facc, cay, y3, omegb, sin2, cos2, css2, phipri, h, applam, asinco, dellam, alampr, m;
+  int64_t          k, o;
+
+
+  one = _mm256_set1_pd (1.0);
+  zero = _mm256_setzero_pd ();
+  sign_bit = _mm256_set1_pd (-0.0);
+  tiny = _mm256_set1_pd (1.0e-3);
+
+  for (k = start ; k + 4 <= end ; k += 4)
+    {
+      o = k * batch->origin_step;
+
+      if (batch->origin_step)
+        {
+          latobs = _mm256_loadu_pd (&batch->latobs[o]);
+          lonobs = _mm256_loadu_pd (&batch->lonobs[o]);
+        }
+      else
+        {
+          latobs = _mm256_set1_pd (batch->latobs[0]);
+          lonobs = _mm256_set1_pd (batch->lonobs[0]);
+        }
+
+      az = _mm256_loadu_pd (&batch->az[k]);
+      s = _mm256_loadu_pd (&batch->dist[k]);
+
+
+      /*  newgp's fix for going east or west on the equator.  */
+
+      m = _mm256_and_pd (_mm256_cmp_pd (latobs, zero, _CMP_EQ_OQ),
+                         _mm256_or_pd (_mm256_cmp_pd (az, _mm256_set1_pd (90.0), _CMP_EQ_OQ),
+                                       _mm256_cmp_pd (az, _mm256_set1_pd (270.0), _CMP_EQ_OQ)));
+      latobs = _mm256_blendv_pd (latobs, _mm256_add_pd (latobs, _mm256_set1_pd (1.0e-37)), m);
+
+
+      /*  azNtoS.  */
+
+      az = _mm256_add_pd (az, _mm256_set1_pd (180.0));
+      az = _mm256_blendv_pd (az, _mm256_sub_pd (az, _mm256_set1_pd (360.0)),
+                             _mm256_cmp_pd (az, _mm256_set1_pd (360.0), _CMP_GT_OQ));
+
+
+      /*  direct.  */
+
+      fazj = _mm256_mul_pd (_mm256_mul_pd (_mm256_set1_pd (3600.0), az), _mm256_set1_pd (NEWGP_ARC1));
+      simd_sincos_avx2 (fazj, &sn, &cs);
+
+      x = _mm256_mul_pd (s, sn);
+      x = _mm256_blendv_pd (x, tiny, _mm256_cmp_pd (_mm256_andnot_pd (sign_bit, x), tiny, _CMP_LT_OQ));
+      y = _mm256_mul_pd (_mm256_xor_pd (s, sign_bit), cs);
+      y = _mm256_blendv_pd (y, tiny, _mm256_cmp_pd (_mm256_andnot_pd (sign_bit, y), tiny, _CMP_LT_OQ));
+
+      b = _mm256_div_pd (y, _mm256_set1_pd (10000.0));
+      b = _mm256_mul_pd (b, b);
+
+      phj = _mm256_mul_pd (_mm256_mul_pd (_mm256_set1_pd (3600.0), latobs), _mm256_set1_pd (NEWGP_ARC1));
+      simd_sincos_avx2 (phj, &sina, &cosa);
+
+      u = _mm256_sub_pd (one, _mm256_mul_pd (_mm256_mul_pd (_mm256_set1_pd (NEWGP_ESQ), sina), sina));
+      ef = _mm256_div_pd (_mm256_mul_pd (_mm256_mul_pd (u, u), _mm256_set1_pd (1.0e15)),
+                          _mm256_set1_pd (3.0 * NEWGP_AXIS * NEWGP_AXIS * (1.0 - NEWGP_ESQ)));
+      xcor = _mm256_div_pd (_mm256_mul_pd (b, ef), _mm256_set1_pd (2.0));
+      xpri = _mm256_sub_pd (x, _mm256_mul_pd (_mm256_mul_pd (xcor, x), _mm256_set1_pd (1.0e-7)));
+      a = _mm256_div_pd (xpri, _mm256_set1_pd (10000.0));
+      a = _mm256_mul_pd (a, a);
+      ycor = _mm256_mul_pd (ef, a);
+      ypri = _mm256_add_pd (y, _mm256_mul_pd (_mm256_mul_pd (ycor, y), _mm256_set1_pd (1.0e-7)));
+      cssq = _mm256_mul_pd (cosa, cosa);
+      y0 = _mm256_mul_pd (_mm256_set1_pd (NEWGP_Z1), newgp_angle_avx2 (phj, sina, cosa, -NEWGP_Z4, cssq, NEWGP_Z3, -NEWGP_Z2));
+      y1 = _mm256_add_pd (y0, ypri);
+      omega = _mm256_mul_pd (_mm256_set1_pd (NEWGP_W1), y1);
+      simd_sincos_avx2 (omega, &sin1, &cos1);
+      css1 = _mm256_mul_pd (cos1, cos1);
+      phi1 = newgp_angle_avx2 (omega, sin1, cos1, NEWGP_W4, css1, NEWGP_W3, NEWGP_W2);
+      simd_sincos_avx2 (phi1, &sin1, &cos1);
+      faca = _mm256_div_pd (_mm256_sqrt_pd (_mm256_sub_pd (one, _mm256_mul_pd (_mm256_mul_pd (_mm256_set1_pd (NEWGP_ESQ), sin1), sin1))),
+                            _mm256_set1_pd (2.0 * NEWGP_AXIS));
+      tn = _mm256_div_pd (sin1, cos1);
+      v = _mm256_mul_pd (_mm256_mul_pd (tn, faca), _mm256_set1_pd (1.0e8));
+      va = _mm256_mul_pd (v, a);
+      y2 = _mm256_sub_pd (y1, va);
+      facb = _mm256_add_pd (one, _mm256_mul_pd (_mm256_set1_pd (3.0), _mm256_div_pd (_mm256_mul_pd (sin1, sin1), _mm256_mul_pd (cos1, cos1))));
+      facb = _mm256_div_pd (facb, _mm256_mul_pd (_mm256_set1_pd (3.0), tn));
+      facc = _mm256_div_pd (_mm256_mul_pd (_mm256_mul_pd (_mm256_set1_pd (3.0 * NEWGP_ESQ), sin1), cos1), _mm256_set1_pd (1.0 - NEWGP_ESQ));
+      cay = _mm256_mul_pd (_mm256_mul_pd (faca, _mm256_sub_pd (facb, facc)), _mm256_set1_pd (1.0e6));
+      y3 = _mm256_div_pd (va, _mm256_set1_pd (1000.0));
+      y3 = _mm256_add_pd (y2, _mm256_mul_pd (cay, _mm256_mul_pd (y3, y3)));
+      omegb = _mm256_mul_pd (_mm256_set1_pd (NEWGP_W1), y3);
+      simd_sincos_avx2 (omegb, &sin2, &cos2);
+      css2 = _mm256_mul_pd (cos2, cos2);
+      phipri = newgp_angle_avx2 (omegb, sin2, cos2, NEWGP_W4, css2, NEWGP_W3, NEWGP_W2);
+
+      simd_sincos_avx2 (phipri, &sin2, &cos2);
+      h = _mm256_div_pd (_mm256_sqrt_pd (_mm256_sub_pd (one, _mm256_mul_pd (_mm256_set1_pd (NEWGP_ESQ), _mm256_mul_pd (sin2, sin2)))),
+                         _mm256_mul_pd (_mm256_mul_pd (_mm256_set1_pd (NEWGP_AXIS), cos2), _mm256_set1_pd (NEWGP_ARC1)));
+      applam = _mm256_mul_pd (h, xpri);
+      asinco = _mm256_div_pd (_mm256_mul_pd (v, va), _mm256_set1_pd (15.0));
+      dellam = _mm256_add_pd (applam, _mm256_mul_pd (_mm256_mul_pd (applam, asinco), _mm256_set1_pd (1.0e-7)));
+      alampr = _mm256_sub_pd (_mm256_mul_pd (_mm256_set1_pd (3600.0), lonobs), dellam);
+
+      phipri = _mm256_div_pd (phipri, _mm256_set1_pd (NEWGP_ARC1));
+
+      m = _mm256_cmp_pd (_mm256_andnot_pd (sign_bit, alampr), _mm256_set1_pd (648000.0), _CMP_GT_OQ);
+      alampr = _mm256_blendv_pd (alampr, _mm256_sub_pd (alampr, _mm256_set1_pd (1296000.0)),
+                                 _mm256_and_pd (m, _mm256_cmp_pd (alampr, zero, _CMP_GT_OQ)));
+      alampr = _mm256_blendv_pd (alampr, _mm256_add_pd (alampr, _mm256_set1_pd (1296000.0)),
+                                 _mm256_and_pd (m, _mm256_cmp_pd (alampr, zero, _CMP_LT_OQ)));
+
+      _mm256_storeu_pd (&batch->lat[k], _mm256_div_pd (phipri, _mm256_set1_pd (3600.0)));
+      _mm256_storeu_pd (&batch->lon[k], _mm256_div_pd (alampr, _mm256_set1_pd (3600.0)));
+    }
+
+  return (k);
+}
+
+#endif
+
+
+
+static void newgp_batch_chunk (int64_t start, int64_t end, void *arg)
+{
+  NEWGP_BATCH      *batch = (NEWGP_BATCH *) arg;
+  int64_t          k, o;
+
+
+  if (batch->geo != NULL)
+    {
+      for (k = start ; k < end ; k++)
+        {
+          o = k * batch->origin_step;
+          newgp_geodesic (batch->geo, batch->latobs[o], batch->lonobs[o], batch->az[k], batch->dist[k], &batch->lat[k],
+                          &batch->lon[k]);
+        }
+      return;
+    }
+
+#ifdef NEWGP_SIMD
+  if (batch->avx2) start = newgp_avx2 (batch, start, end);
+#endif
+
+  for (k = start ; k < end ; k++)
+    {
+      o = k * batch->origin_step;
+      newgp (batch->latobs[o], batch->lonobs[o], batch->az[k], batch->dist[k], &batch->lat[k], &batch->lon[k]);
+    }
+}
+
+
+
+static void newgp_batch_run (NEWGP_BATCH *batch, int64_t n)
+{
+  batch->avx2 = 0;
+
+#ifdef NEWGP_SIMD
+  batch->avx2 = __builtin_cpu_supports ("avx2");
+#endif
+
+  parallel_for (n, batch->geo != NULL ? 4096 : 16384, newgp_batch_chunk, batch);
+}
+
+
+
+/***************************************************************************/
+/*!
+
+  - Module Name:        newgp_batch
+
+  - Date Written:       October 2026
+
+  - Purpose:            Computes newgp for arrays of azimuths and
+                        distances from one position (e.g. beam or return
+                        footprints from a vessel position).
+                        newgp_batch_origins does the same with a separate
+                        origin for each azimuth and distance.  Large
+                        batches are split across threads (see
+                        parallel_for).
+
+                        If geo is NULL the short range series in direct
+                        (the one newgp uses, valid to about 600 miles) is
+                        used.  On CPUs that support AVX2 four positions are
+                        done at a time with vectorized trig functions and
+                        the results agree with newgp to within a few
+                        nanometers.  If geo is not NULL newgp_geodesic
+                        (Vincenty) is used on that ellipsoid.
+
+  - Arguments:
+                        - geo      =   GEODESIC structure from init_geodesic
+                                       or NULL for the direct series
+                        - latobs   =   latitude(s) of the observed position
+                                       (degrees)
+                        - lonobs   =   longitude(s) of the observed position
+                                       (degrees)
+                        - az       =   azimuths from north (degrees, [0, 360))
+                        - dist     =   distances in meters
+                        - n        =   number of positions
+                        - lat      =   returned latitudes (degrees)
+                        - lon      =   returned longitudes (degrees)
+
+  - Return Value:       None
+
+****************************************************************************/
+
+void newgp_batch (GEODESIC *geo, double latobs, double lonobs, const double *az, const double *dist, int64_t n,
+                  double *lat, double *lon)
+{
+  NEWGP_BATCH      batch;
+
+
+  if (n <= 0) return;
+
+  batch.geo = geo;
+  batch.latobs = &latobs;
+  batch.lonobs = &lonobs;
+  batch.origin_step = 0;
+  batch.az = az;
+  batch.dist = dist;
+  batch.lat = lat;
+  batch.lon = lon;
+
+  newgp_batch_run (&batch, n);
+}
+
+
+
+void newgp_batch_origins (GEODESIC *geo, const double *latobs, const double *lonobs, const double *az,
+                          const double *dist, int64_t n, double *lat, double *lon)
+{
+  NEWGP_BATCH      batch;
+
+
+  if (n <= 0) return;
+
+  batch.geo = geo;
+  batch.latobs = latobs;
+  batch.lonobs = lonobs;
+  batch.origin_step = 1;
+  batch.az = az;
+  batch.dist = dist;
+  batch.lat = lat;
+  batch.lon = lon;
+
+  newgp_batch_run (&batch, n);
+}
@@ -46,9 +46,15 @@ extern "C" {
 
 #include <stdio.h>
 #include "pfm_nvtypes.h"
+#include "invgp.h"
 
 
   void newgp(double latobs, double lonobs, double az, double dist, double *lat, double *lon);
+  void newgp_geodesic (GEODESIC *geo, double latobs, double lonobs, double az, double dist, double *lat, double *lon);
+  void newgp_batch (GEODESIC *geo, double latobs, double lonobs, const double *az, const double *dist, int64_t n,
+                    double *lat, double *lon);
+  void newgp_batch_origins (GEODESIC *geo, const double *latobs, const double *lonobs, const double *az,
+                            const double *dist, int64_t n, double *lat, double *lon);
 
 
 #ifdef  __cplusplus
@@ -115,6 +115,7 @@ extern "C" {
 
 #include "ABE.h"
 #include "area.h"
+#include "area_index.h"
 #include "basename.h"
 #include "big_endian.h"
 #include "bit_pack.h"
@@ -132,6 +133,7 @@ extern "C" {
 #include "find_startup_name.h"
 #include "fixpos.h"
 #include "geo_distance.h"
+#include "geo_neighbor.h"
 #include "get_area_mbr.h"
 #include "get_egm08.h"
 #include "get_geoid03.h"
@@ -139,11 +141,13 @@ extern "C" {
 #include "get_geoid12a.h"
 #include "get_geoid12b.h"
 #include "get_string.h"
+#include "grid_filter.h"
 #include "inside.h"
 #include "inside_polygon.h"
 #include "invgp.h"
 #include "line_intersection.h"
 #include "linterp.h"
+#include "local_frame.h"
 #include "martin.h"
 #include "msv.h"
 #include "nav4word.h"
@@ -151,10 +155,13 @@ extern "C" {
 #include "ngets.h"
 #include "normtime.h"
 #include "nvutility_version.h"
+#include "parallel_for.h"
 #include "points.h"
 #include "polygon_collision.h"
 #include "polygon_intersection.h"
+#include "rasterize_polygon.h"
 #include "read_coast.h"
+#include "read_dted_topo.h"
 #include "read_shape_mask.h"
 #include "read_srtm1_topo.h"
 #include "read_srtm2_topo.h"
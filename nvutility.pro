@@ -21,6 +21,7 @@ HEADERS += ABE.h \
            ABE_register.hpp \
            acknowledgments.hpp \
            area.h \
+           area_index.h \
            basename.h \
            big_endian.h \
            bit_pack.h \
@@ -42,6 +43,7 @@ HEADERS += ABE.h \
            find_startup_name.h \
            fixpos.h \
            geo_distance.h \
+           geo_neighbor.h \
            get_area_mbr.h \
            get_egm08.h \
            get_geoid03.h \
@@ -51,6 +53,7 @@ HEADERS += ABE.h \
            get_string.h \
            getSystemInfo.hpp \
            globals.hpp \
+           grid_filter.h \
            inside.h \
            inside_polygon.h \
            interp.hpp \
@@ -58,6 +61,7 @@ HEADERS += ABE.h \
            invgp.h \
            line_intersection.h \
            linterp.h \
+           local_frame.h \
            martin.h \
            msv.h \
            nav4word.h \
@@ -72,11 +76,14 @@ HEADERS += ABE.h \
            nvutility.h \
            nvutility.hpp \
            nvutility_version.h \
+           parallel_for.h \
            points.h \
            polygon_collision.h \
            polygon_intersection.h \
            qPosfix.hpp \
+           rasterize_polygon.h \
            read_coast.h \
+           read_dted_topo.h \
            read_shape_mask.h \
            read_srtm1_topo.h \
            read_srtm2_topo.h \
@@ -101,7 +108,8 @@ HEADERS += ABE.h \
            unregisterABE.hpp \
            vec.h \
            windows_getuid.h
-SOURCES += area_list.c \
+SOURCES += area_index.c \
+           area_list.c \
            b_spline.cpp \
            basename.c \
            big_endian.c \
@@ -125,6 +133,7 @@ SOURCES += area_list.c \
            fixpos.c \
            follow.cpp \
            geo_distance.c \
+           geo_neighbor.c \
            get_area_mbr.c \
            get_coords.c \
            get_egm08.c \
@@ -137,6 +146,7 @@ SOURCES += area_list.c \
            get_survey.c \
            getexit.cpp \
            getSystemInfo.cpp \
+           grid_filter.c \
            inside.c \
            inside_polygon.c \
            interpolate.cpp \
@@ -144,6 +154,7 @@ SOURCES += area_list.c \
            line_intersection.c \
            linterp.c \
            load_verts.c \
+           local_frame.c \
            martin.c \
            msv.c \
            nav4word.c \
@@ -154,11 +165,14 @@ SOURCES += area_list.c \
            nvmap.cpp \
            nvMapGL.cpp \
            nvpic.cpp \
+           parallel_for.c \
            polygon_collision.c \
            polygon_intersection.c \
            print_time.c \
            qPosfix.cpp \
+           rasterize_polygon.c \
            read_coast.c \
+           read_dted_topo.c \
            read_shape_mask.c \
            read_srtm1_topo.c \
            read_srtm2_topo.c \
@@ -37,7 +37,7 @@
 
 #ifndef NVUTILITY_VERSION
 
-#define     NVUTILITY_VERSION     "PFM Software - nvutility library V2.2.44 - 01/22/20"
+#define     NVUTILITY_VERSION     "PFM Software - nvutility library V2.2.69 - 10/18/26"
 
 #endif
 
@@ -988,4 +988,236 @@
     - Defined a couple of integer variables in get_area_mbr.c because they were causing errors when not using
       the c99 option to the compiler.
 
+
+    Version 2.2.45
+    10/18/26
+
+    - chrtr.c now uses 64 bit file offsets and positional reads and writes (pread/pwrite, ReadFile/WriteFile with
+      an offset on Windows) so that files larger than 2GB work and multiple threads can read from the same handle.
+    - The CHRTR handle table now grows as needed instead of exiting when more than MAX_CHRTR_FILES are opened.
+
+
+    Version 2.2.46
+    10/18/26
+
+    - Added chrtr_map, chrtr_map_row, and chrtr_unmap to chrtr.c.  These memory map a CHRTR file so that row scans
+      are just memory reads.  Byte swapped files can be converted in memory (copy-on-write) when they are mapped.
+      read_chrtr and get_chrtr_value read from the map when a file is mapped.
+
+
+    Version 2.2.47
+    10/18/26
+
+    - Added get_chrtr_values to chrtr.c.  This samples a CHRTR file at many positions at once by sorting the
+      requests by row and reading each run of nearby cells with a single read.  It can optionally do bilinear
+      interpolation between cell centers.
+
+
+    Version 2.2.48
+    10/18/26
+
+    - write_chrtr now byte swaps the data to the file's byte order (read_chrtr always swapped but write_chrtr
+      never did).
+    - Added chrtr_writer_open, chrtr_writer_put_row, and chrtr_writer_close to chrtr.c.  These collect rows into
+      blocks of consecutive rows, swap them to the file's byte order, and write each block with a single write
+      from a background thread.  Memory use is limited to a fixed number of blocks and multiple threads can put
+      rows at the same time.
+
+
+    Version 2.2.49
+    10/18/26
+
+    - Added tiled CHRTR files (create_chrtr_tiled).  The grid is stored as square tiles (256 by 256 by default)
+      with a tile index after the header.  open_chrtr detects tiled files by their endian indicator and
+      read_chrtr, write_chrtr, get_chrtr_value, get_chrtr_values, and the CHRTR writer work on them transparently
+      through a per file LRU cache of decoded tiles.
+
+
+    Version 2.2.50
+    10/18/26
+
+    - Added dted_load_tile to dted.c.  This reads a whole DTED file with one read, checks the sentinel and
+      checksum of every data record, and decodes all of the posts into a row major grid (using SSE2 for the
+      checksum and the sign-magnitude decode when available).
+    - write_dted_data now takes a pointer to the DTED_DATA structure instead of copying the 7K structure on every
+      call.  Callers need to pass &dted_data.
+
+
+    Version 2.2.51
+    10/18/26
+
+    - Added read_dted_topo.c.  open_dted_topo indexes a directory tree of DTED level 0, 1, and 2 files by the
+      origin in their UHL records.  read_dted_topo, read_dted_topo_batch, read_dted_topo_area, and
+      read_dted_topo_one_degree then work like the SRTM readers using a size limited LRU cache of decoded tiles.
+
+
+    Version 2.2.52
+    10/18/26
+
+    - Added BIT_READER and BIT_WRITER buffered bit-stream objects to bit_pack.c.  These keep a 64 bit
+      accumulator so each field is a shift and a mask.  They produce the same streams as bit_pack,
+      bit_unpack, double_bit_pack, and double_bit_unpack so existing files still decode.
+    - The SRTM topo and mask readers now decode their cells with a BIT_READER.
+    - Fixed the double_bit_unpack prototype in bit_pack.h (it returns uint64_t).
+
+
+    Version 2.2.53
+    10/18/26
+
+    - Added bit_unpack_array and bit_pack_array to bit_pack.c.  On x86 processors with AVX2 or SSE4.1
+      (checked at run time) bit_unpack_array unpacks fields of up to 25 bits eight at a time.  Other
+      widths and processors use a BIT_READER.  bit_pack_array goes through a BIT_WRITER.
+    - The SRTM topo readers now unpack each row of deltas with bit_unpack_array.
+
+
+    Version 2.2.54
+    10/18/26
+
+    - Added swap_int32_array, swap_float_array, swap_double_array, and swap_int16_array to swap_bytes.c.
+      On x86 processors with AVX2 or SSSE3 (checked at run time) these swap 32 or 16 bytes per shuffle.
+    - chrtr.c, get_egm08.c, and the geoid readers now swap their grids with swap_float_array.  Removed
+      the private swap_float from get_egm08.c.
+
+
+    Version 2.2.55
+    10/18/26
+
+    - Added PREPARED_POLYGON to inside_polygon.c.  prepare_polygon, prepare_polygon2, and
+      prepare_polygon_area bucket the polygon edges into the rows of a uniform grid and classify every
+      grid cell that no edge touches as inside or outside.  inside_prepared_polygon is then a table
+      lookup for most points and a crossing test over one row's edges otherwise.  Results are
+      identical to inside_polygon2.
+
+
+    Version 2.2.56
+    10/18/26
+
+    - Added parallel_for.c.  parallel_for splits a range of work into contiguous chunks and runs them
+      on a set of pthreads.  set_parallel_for_threads limits the number of threads (the default is the
+      number of processors).
+    - Added inside_polygon_batch to inside_polygon.c.  It tests arrays of points with an MBR reject,
+      a PREPARED_POLYGON when there are many points per vertex, or an AVX2 kernel (four points per
+      pass over the edges, checked at run time) otherwise, and splits large arrays across threads.
+      Results are identical to inside_polygon2.
+    - inside, inside_coord2, and inside_area no longer sum atan angles.  They use the inside_polygon2
+      crossing test so they only differ from the old results for points exactly on the boundary or
+      for self-intersecting polygons.
+
+
+    Version 2.2.57
+    10/18/26
+
+    - Rewrote polygon_collision and polygon_collision2.  They now reject on the polygon MBRs, test
+      vertices against prepared polygons (for larger polygons), and find crossing edges by sorting the
+      edges that reach into the MBR overlap on X and sweeping them with an active list per polygon.
+      The answers are the same as the old vertex/every-edge-pair checks.
+    - polygon_intersection and polygon_intersection2 give the same answer as polygon_collision so they
+      now call it.
+    - Added polygon_collision_batch to check every polygon of one set against every polygon of
+      another using an MBR sorted candidate list and parallel_for.
+
+
+    Version 2.2.58
+    10/18/26
+
+    - Added area_index.c (AREA_INDEX) to find every polygon that contains a point or touches an MBR
+      using an STR packed R-tree over the polygon MBRs with prepared polygons at the leaves.  Includes
+      a threaded batch point query.
+
+
+    Version 2.2.59
+    10/18/26
+
+    - Added rasterize_polygon.c, a scanline polygon rasterizer that builds a packed bit mask of the
+      bins inside a polygon (even-odd or nonzero fill).  The even-odd result is identical to calling
+      inside_polygon2 at every bin center.
+
+
+    Version 2.2.60
+    10/18/26
+
+    - Fixed invgp ignoring a0 and b0 after the first call (the flattening terms were cached in statics).
+      Added the GEODESIC structure (init_geodesic), invgp_geodesic, and invgp_batch which uses an AVX2
+      kernel with vectorized trig functions and parallel_for.
+
+
+    Version 2.2.61
+    10/18/26
+
+    - Added GEO_DISTANCE contexts (geo_distance_create, geo_distance_ctx, geo_distance_batch, and
+      geo_distance_free) so that geo_distance can be used for more than one area at a time and from
+      threads.  init_geo_distance, geo_distance, and clean_geo_distance now wrap a default context.
+
+
+    Version 2.2.62
+    10/18/26
+
+    - Added geo_neighbor.c (GEO_NEIGHBOR), a fixed radius neighbor index over geographic points using
+      a spatial hash of geo_distance metric cells.  Includes radius and k nearest neighbor queries and
+      a threaded all pairs within radius join.
+
+
+    Version 2.2.63
+    10/18/26
+
+    - Added newgp_batch and newgp_batch_origins for computing many destination positions at once.  The
+      direct series path (GEODESIC NULL) uses an AVX2 kernel and parallel_for.  Added newgp_geodesic
+      (Vincenty) for other ellipsoids and long distances.  Moved the AVX2 trig functions from invgp.c
+      to simd_trig.inc (internal, not installed) so they can be shared.
+
+
+    Version 2.2.64
+    10/18/26
+
+    - Added local_frame.c/.h.  init_local_frame sets up a local east-north-up (tangent plane) frame at an origin
+      and, given an AOI, reports the worst 2D distance and azimuth errors of the frame against invgp.
+      geodetic_to_enu and enu_to_geodetic convert arrays of positions through earth centered coordinates using
+      AVX2 kernels (when available) split across threads with parallel_for.
+    - Added simd_atan2_avx2 to simd_trig.inc.
+
+
+    Version 2.2.65
+    10/18/26
+
+    - get_area_mbr, get_area_mbr2, get_area_ll_mbr, and get_area_ll_mbr2 now keep parsed area files in a process
+      wide cache keyed by path, size, and modification time.  The .ARE, .are, and .afs parsers read the whole
+      file in one shot and use a hand written number scanner (same results as before, about 5 times faster).
+      Added get_area_polygon (allocates the polygon arrays so there's no fixed size limit) and clear_area_cache.
+
+
+    Version 2.2.66
+    10/18/26
+
+    - Added CONVOLVE_FILTER (create_convolve_filter, convolve_filter, convolve_filter_f, free_convolve_filter) to
+      convolve.c.  The mirrored filter is built once and applied to single or multiple rows of double or float
+      data with AVX2/FMA kernels or, for filters with CONVOLVE_FFT_TAPS or more taps, overlap-save FFT convolution.
+      Work is split across threads with parallel_for.  convolve now uses the same code and no longer overruns its
+      filter array for lengths over 90.
+
+
+    Version 2.2.67
+    10/18/26
+
+    - Added grid_filter.c/.h.  create_grid_filter builds a separable 2D filter from a martin design.  grid_filter
+      filters an in memory grid (rows with convolve_filter_f, columns as weighted sums of rows in cache sized
+      column blocks, both split across threads) and grid_filter_stream does the same for grids that don't fit in
+      memory, reading and writing one row at a time.  Optional normalized convolution handles null values.
+
+
+    Version 2.2.68
+    10/18/26
+
+    - savgol coefficients are now cached by (nl, nr, ld, m) (see savgol_coefficients and clear_savgol_cache).
+      Added a streaming Savitzky-Golay filter (create_savgol_state, savgol_apply, savgol_flush,
+      reset_savgol_state, free_savgol_state) that handles the ends of the series with shrinking windows and uses
+      AVX2/FMA for the full window dot products.
+
+
+    Version 2.2.69
+    10/18/26
+
+    - Added MSV_PROFILE (create_msv_profile, msv_profile, msv_batch, free_msv_profile)
+      to msv.c.  The layer holding a depth is found with a uniform depth lookup table
+      instead of a scan from the surface.  Results are identical to msv and amsv.
+
 </pre>*/
@@ -0,0 +1,214 @@
+
+/*********************************************************************************************
+
+    This is public domain software that was developed by or for the U.S. Naval Oceanographic
+    Office and/or the U.S. Army Corps of Engineers.
+
+    This is a work of the U.S. Government. In accordance with 17 USC 105, copyright protection
+    is not available for any work of the U.S. Government.
+
+    Neither the United States Government, nor any employees of the United States Government,
+    nor the author, makes any warranty, express or implied, without even the implied warranty
+    of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE, or assumes any liability or
+    responsibility for the accuracy, completeness, or usefulness of any information,
+    apparatus, product, or process disclosed, or represents that its use would not infringe
+    privately-owned rights. Reference herein to any specific commercial products, process,
+    or service by trade name, trademark, manufacturer, or otherwise, does not necessarily
+    constitute or imply its endorsement, recommendation, or favoring by the United States
+    Government. The views and opinions of authors expressed herein do not necessarily state
+    or reflect those of the United States Government, and shall not be used for advertising
+    or product endorsement purposes.
+*********************************************************************************************/
+
+
+/****************************************  IMPORTANT NOTE  **********************************
+
+    Comments in this file that start with / * ! are being used by Doxygen to document the
+    software.  Dashes in these comment blocks are used to create bullet lists.  The lack of
+    blank lines after a block of dash preceeded comments means that the next block of dash
+    preceeded comments is a new, indented bullet list.  I've tried to keep the Doxygen
+    formatting to a minimum but there are some other items (like <br> and <pre>) that need
+    to be left alone.  If you see a comment that starts with / * ! and there is something
+    that looks a bit weird it is probably due to some arcane Doxygen syntax.  Be very
+    careful modifying blocks of Doxygen comments.
+
+*****************************************  IMPORTANT NOTE  **********************************/
+
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <pthread.h>
+
+#ifdef NVWIN3X
+  #include <windows.h>
+#else
+  #include <unistd.h>
+#endif
+
+#include "nvdef.h"
+#include "parallel_for.h"
+
+
+#define PARALLEL_FOR_MAX_THREADS 64
+
+
+/*  Zero means use the number of processors.  */
+
+static int32_t parallel_for_threads = 0;
+
+
+typedef struct
+{
+  PARALLEL_FOR_FUNC func;
+  void              *arg;
+  int64_t           start;
+  int64_t           end;
+} PARALLEL_FOR_CHUNK;
+
+
+
+static void *parallel_for_thread (void *arg)
+{
+  PARALLEL_FOR_CHUNK *chunk = (PARALLEL_FOR_CHUNK *) arg;
+
+  chunk->func (chunk->start, chunk->end, chunk->arg);
+
+  return (NULL);
+}
+
+
+
+/***************************************************************************/
+/*!
+
+  - Module Name:        get_parallel_for_threads
+
+  - Date Written:       October 2026
+
+  - Purpose:            Returns the maximum number of threads that
+                        parallel_for will use.  Unless it has been set with
+                        set_parallel_for_threads this is the number of
+                        online processors.
+
+  - Return Value:       Number of threads (at least 1)
+
+****************************************************************************/
+
+int32_t get_parallel_for_threads ()
+{
+  int32_t            threads = parallel_for_threads;
+
+
+  if (threads <= 0)
+    {
+#ifdef NVWIN3X
+      SYSTEM_INFO    info;
+
+      GetSystemInfo (&info);
+      threads = (int32_t) info.dwNumberOfProcessors;
+#else
+      threads = (int32_t) sysconf (_SC_NPROCESSORS_ONLN);
+#endif
+    }
+
+  return (MIN (MAX (threads, 1), PARALLEL_FOR_MAX_THREADS));
+}
+
+
+
+/***************************************************************************/
+/*!
+
+  - Module Name:        set_parallel_for_threads
+
+  - Date Written:       October 2026
+
+  - Purpose:            Sets the maximum number of threads that parallel_for
+                        will use.  Set it to 1 to run everything in the
+                        calling thread or 0 to go back to the number of
+                        online processors.
+
+  - Arguments:
+                        - threads  =   maximum number of threads
+
+****************************************************************************/
+
+void set_parallel_for_threads (int32_t threads)
+{
+  parallel_for_threads = threads;
+}
+
+
+
+/***************************************************************************/
+/*!
+
+  - Module Name:        parallel_for
+
+  - Date Written:       October 2026
+
+  - Purpose:            Splits items 0 through count - 1 into contiguous
+                        chunks of at least min_chunk items and runs func on
+                        each chunk in its own thread.  The calling thread
+                        does the first chunk and returns when all of them
+                        are finished.  If the work is too small to split, or
+                        a thread can't be started, the work is done in the
+                        calling thread.  func must not touch data shared
+                        with other chunks without its own locking.
+
+  - Arguments:
+                        - count     =   number of items
+                        - min_chunk =   minimum number of items per thread
+                        - func      =   work function
+                        - arg       =   argument passed through to func
+
+****************************************************************************/
+
+void parallel_for (int64_t count, int64_t min_chunk, PARALLEL_FOR_FUNC func, void *arg)
+{
+  PARALLEL_FOR_CHUNK chunk[PARALLEL_FOR_MAX_THREADS];
+  pthread_t          thread[PARALLEL_FOR_MAX_THREADS];
+  uint8_t            started[PARALLEL_FOR_MAX_THREADS];
+  int64_t            chunks, i;
+
+
+  if (count <= 0) return;
+
+  if (min_chunk < 1) min_chunk = 1;
+
+  chunks = MIN ((int64_t) get_parallel_for_threads (), (count + min_chunk - 1) / min_chunk);
+
+  if (chunks <= 1)
+    {
+      func (0, count, arg);
+      return;
+    }
+
+  for (i = 0 ; i < chunks ; i++)
+    {
+      chunk[i].func = func;
+      chunk[i].arg = arg;
+      chunk[i].start = count * i / chunks;
+      chunk[i].end = count * (i + 1) / chunks;
+    }
+
+  for (i = 1 ; i < chunks ; i++)
+    {
+      started[i] = !pthread_create (&thread[i], NULL, parallel_for_thread, &chunk[i]);
+    }
+
+  func (chunk[0].start, chunk[0].end, arg);
+
+  for (i = 1 ; i < chunks ; i++)
+    {
+      if (started[i])
+        {
+          pthread_join (thread[i], NULL);
+        }
+      else
+        {
+          func (chunk[i].start, chunk[i].end, arg);
+        }
+    }
+}
@@ -38,90 +38,147 @@
 *****************************************  IMPORTANT NOTE  **********************************/
 
 
+#include <stdlib.h>
+#include <string.h>
+
+#include "nvdef.h"
+#include "parallel_for.h"
 #include "polygon_collision.h"
 
 
-/***************************************************************************/
-/*!
+/*  A polygon as seen by the collision tests.  The coordinates may be separate X and Y arrays (stride 1) or the
+    x and y members of an NV_F64_COORD2 array (stride 2).  */
 
-  - Module Name:        polygon_collision
+typedef struct
+{
+  const double     *x;
+  const double     *y;
+  int32_t          stride;
+  int32_t          n;
+  NV_F64_XYMBR     mbr;
+  PREPARED_POLYGON *pp;
+} COLLISION_POLY;
 
-  - Programmer(s):      Jan C. Depner
 
-  - Date Written:       December 11, 2009
+/*  One polygon edge for the sweep.  Edge i runs from vertex i - 1 (or n - 1) to vertex i.  */
 
-  - Purpose:            Determines if two polygons intersect
+typedef struct
+{
+  double           min_x;
+  double           max_x;
+  double           min_y;
+  double           max_y;
+  int32_t          poly;
+  int32_t          i;
+} COLLISION_EDGE;
 
-  - Arguments:
-  - Return Value:       NVTrue if they intersect, otherwise NVFalse
 
-****************************************************************************/
+#define CPX(p,i) ((p)->x[(int64_t) (i) * (p)->stride])
+#define CPY(p,i) ((p)->y[(int64_t) (i) * (p)->stride])
 
-uint8_t polygon_collision (NV_F64_COORD2 *poly1, int32_t npol1, NV_F64_COORD2 *poly2, int32_t npol2)
+
+/*  Preparing a polygon pays for itself once it's going to be hit with more than a few vertex tests per edge.  */
+
+#define COLLISION_PREPARE_MIN   16
+
+
+
+static void collision_poly_init (COLLISION_POLY *p, const double *x, const double *y, int32_t stride, int32_t n)
 {
-  int32_t i, j;
-  double x, y;
+  int32_t          i;
 
 
-  /*  Easy check first.  If any vertex of one polygon lies inside of the other then they intersect.  */
+  p->x = x;
+  p->y = y;
+  p->stride = stride;
+  p->n = n;
+  p->pp = NULL;
 
-  for (i = 0 ; i < npol1 ; i++)
+  p->mbr.min_x = p->mbr.max_x = CPX (p, 0);
+  p->mbr.min_y = p->mbr.max_y = CPY (p, 0);
+  for (i = 1 ; i < n ; i++)
     {
-      /*  First check to see if this vertex of polygon 1 lies inside polygon 2.  */
+      p->mbr.min_x = MIN (p->mbr.min_x, CPX (p, i));
+      p->mbr.max_x = MAX (p->mbr.max_x, CPX (p, i));
+      p->mbr.min_y = MIN (p->mbr.min_y, CPY (p, i));
+      p->mbr.max_y = MAX (p->mbr.max_y, CPY (p, i));
+    }
+}
 
-      if (inside_polygon (poly2, npol2, poly1[i].x, poly1[i].y)) return (NVTrue);
 
 
-      for (j = 0 ; j < npol2 ; j++)
-        {
-          /*  Check to see if this vertex of polygon 2 lies inside polygon 1.  */
+static void collision_poly_prepare (COLLISION_POLY *p)
+{
+  if (p->n < COLLISION_PREPARE_MIN || p->pp != NULL) return;
 
-          if (inside_polygon (poly1, npol1, poly2[j].x, poly2[j].y)) return (NVTrue);
-        }
+  if (p->stride == 1)
+    {
+      p->pp = prepare_polygon2 ((double *) p->x, (double *) p->y, p->n);
+    }
+  else
+    {
+      p->pp = prepare_polygon ((NV_F64_COORD2 *) p->x, p->n);
     }
+}
 
 
-  /*  If we got here then it's time to do the hard check.  If any two lines intersect then there is a collision.  */
 
-  for (i = 0 ; i < npol1 ; i++)
+static uint8_t collision_mbr_overlap (NV_F64_XYMBR *a, NV_F64_XYMBR *b)
+{
+  if (a->max_x < b->min_x || b->max_x < a->min_x || a->max_y < b->min_y || b->max_y < a->min_y) return (NVFalse);
+
+  return (NVTrue);
+}
+
+
+
+/*  The inside_polygon2 crossing test for a strided polygon.  */
+
+static int32_t collision_inside (COLLISION_POLY *p, double x, double y)
+{
+  int32_t    i, j, yflag0, yflag1, inside_flag;
+
+
+  if (p->pp != NULL) return (inside_prepared_polygon (p->pp, x, y));
+
+  if (x < p->mbr.min_x || x > p->mbr.max_x || y < p->mbr.min_y || y > p->mbr.max_y) return (0);
+
+  inside_flag = 0;
+
+  j = p->n - 1;
+  yflag0 = (CPY (p, j) >= y);
+
+  for (i = 0 ; i < p->n ; i++)
     {
-      for (j = 0 ; j < npol2 ; j++)
+      yflag1 = (CPY (p, i) >= y);
+
+      if (yflag0 != yflag1)
         {
-          if (i)
+          if (((CPY (p, i) - y) * (CPX (p, j) - CPX (p, i)) >= (CPX (p, i) - x) * (CPY (p, j) - CPY (p, i))) == yflag1)
             {
-              if (j)
-                {
-                  if (line_intersection (poly1[i - 1].x, poly1[i - 1].y, poly1[i].x, poly1[i].y,
-                                         poly2[j - 1].x, poly2[j - 1].y, poly2[j].x, poly2[j].y, &x, &y) == 2) return (NVTrue);
-                }
-              else
-                {
-                  /*  If j is 0 then we have to check the last to first point line segment.  */
-
-                  if (line_intersection (poly1[i - 1].x, poly1[i - 1].y, poly1[i].x, poly1[i].y,
-                                         poly2[npol2 - 1].x, poly2[npol2 - 1].y, poly2[j].x, poly2[j].y, &x, &y) == 2) return (NVTrue);
-                }
+              inside_flag = !inside_flag;
             }
+        }
 
+      yflag0 = yflag1;
+      j = i;
+    }
 
-          /*  If i is 0 then we have to check the last to first point line segment.  */
+  return (inside_flag);
+}
 
-          else
-            {
-              if (j)
-                {
-                  if (line_intersection (poly1[npol1 - 1].x, poly1[npol1 - 1].y, poly1[i].x, poly1[i].y,
-                                         poly2[j - 1].x, poly2[j - 1].y, poly2[j].x, poly2[j].y, &x, &y) == 2) return (NVTrue);
-                }
-              else
-                {
-                  /*  If j is 0 then we have to check the last to first point line segment.  */
-
-                  if (line_intersection (poly1[npol1 - 1].x, poly1[npol1 - 1].y, poly1[i].x, poly1[i].y,
-                                         poly2[npol2 - 1].x, poly2[npol2 - 1].y, poly2[j].x, poly2[j].y, &x, &y) == 2) return (NVTrue);
-                }
-            }
-        }
+
+
+/*  Returns NVTrue if any vertex of a lies inside b.  */
+
+static uint8_t collision_vertex_inside (COLLISION_POLY *a, COLLISION_POLY *b)
+{
+  int32_t    i;
+
+
+  for (i = 0 ; i < a->n ; i++)
+    {
+      if (collision_inside (b, CPX (a, i), CPY (a, i))) return (NVTrue);
     }
 
   return (NVFalse);
@@ -129,72 +186,450 @@ uint8_t polygon_collision (NV_F64_COORD2 *poly1, int32_t npol1, NV_F64_COORD2 *p
 
 
 
-uint8_t polygon_collision2 (double *poly1x, double *poly1y, int32_t npol1, double *poly2x, double *poly2y, int32_t npol2)
+static int32_t collision_edge_compare (const void *a, const void *b)
 {
-  int32_t i, j;
-  double x, y;
+  const COLLISION_EDGE *ea = (const COLLISION_EDGE *) a, *eb = (const COLLISION_EDGE *) b;
+
+  if (ea->min_x < eb->min_x) return (-1);
+  if (ea->min_x > eb->min_x) return (1);
+  return (0);
+}
 
 
-  /*  Easy check first.  If any vertex of one polygon lies inside of the other then they intersect.  */
 
-  for (i = 0 ; i < npol1 ; i++)
+static uint8_t collision_edge_pair (COLLISION_POLY *a, int32_t ia, COLLISION_POLY *b, int32_t ib)
+{
+  int32_t    ja, jb;
+  double     x, y;
+
+
+  ja = ia ? ia - 1 : a->n - 1;
+  jb = ib ? ib - 1 : b->n - 1;
+
+  return (line_intersection (CPX (a, ja), CPY (a, ja), CPX (a, ia), CPY (a, ia),
+                             CPX (b, jb), CPY (b, jb), CPX (b, ib), CPY (b, ib), &x, &y) == 2);
+}
+
+
+
+/*  Returns NVTrue if any edge of a intersects any edge of b.  Only the edges whose extents reach into the
+    overlap of the two MBRs can intersect.  Those are sorted on their minimum X and swept from west to east
+    keeping a list of the still open edges of each polygon, so an edge is only tested against the edges of the
+    other polygon that overlap it in X (and then only if they also overlap in Y).  */
+
+static uint8_t collision_edges (COLLISION_POLY *a, COLLISION_POLY *b)
+{
+  COLLISION_POLY   *poly[2];
+  COLLISION_EDGE   *edge;
+  NV_F64_XYMBR     overlap;
+  int32_t          *active[2], count[2], num_edges = 0, i, j, k, p, q, e, i0, i1;
+  uint8_t          hit = NVFalse;
+
+
+  poly[0] = a;
+  poly[1] = b;
+
+  overlap.min_x = MAX (a->mbr.min_x, b->mbr.min_x);
+  overlap.max_x = MIN (a->mbr.max_x, b->mbr.max_x);
+  overlap.min_y = MAX (a->mbr.min_y, b->mbr.min_y);
+  overlap.max_y = MIN (a->mbr.max_y, b->mbr.max_y);
+
+  edge = (COLLISION_EDGE *) malloc (((int64_t) a->n + b->n) * sizeof (COLLISION_EDGE));
+  active[0] = (int32_t *) malloc (((int64_t) a->n + 1) * sizeof (int32_t));
+  active[1] = (int32_t *) malloc (((int64_t) b->n + 1) * sizeof (int32_t));
+
+  if (edge == NULL || active[0] == NULL || active[1] == NULL)
     {
-      /*  First check to see if this vertex of polygon 1 lies inside polygon 2.  */
+      perror ("Allocating edge memory in polygon_collision");
+      free (edge);
+      free (active[0]);
+      free (active[1]);
+
 
-      if (inside_polygon2 (poly2x, poly2y, npol2, poly1x[i], poly1y[i])) return (NVTrue);
+      /*  Fall back to testing every pair.  */
+
+      for (i = 0 ; i < a->n ; i++)
+        {
+          for (j = 0 ; j < b->n ; j++)
+            {
+              if (collision_edge_pair (a, i, b, j)) return (NVTrue);
+            }
+        }
 
+      return (NVFalse);
+    }
 
-      for (j = 0 ; j < npol2 ; j++)
+  for (p = 0 ; p < 2 ; p++)
+    {
+      for (i = 0 ; i < poly[p]->n ; i++)
         {
-          /*  Check to see if this vertex of polygon 2 lies inside polygon 1.  */
+          j = i ? i - 1 : poly[p]->n - 1;
+
+          edge[num_edges].min_x = MIN (CPX (poly[p], i), CPX (poly[p], j));
+          edge[num_edges].max_x = MAX (CPX (poly[p], i), CPX (poly[p], j));
+          edge[num_edges].min_y = MIN (CPY (poly[p], i), CPY (poly[p], j));
+          edge[num_edges].max_y = MAX (CPY (poly[p], i), CPY (poly[p], j));
+          edge[num_edges].poly = p;
+          edge[num_edges].i = i;
 
-          if (inside_polygon2 (poly1x, poly1y, npol1, poly2x[j], poly2y[j])) return (NVTrue);
+          if (edge[num_edges].max_x >= overlap.min_x && edge[num_edges].min_x <= overlap.max_x &&
+              edge[num_edges].max_y >= overlap.min_y && edge[num_edges].min_y <= overlap.max_y) num_edges++;
         }
     }
 
+  qsort (edge, num_edges, sizeof (COLLISION_EDGE), collision_edge_compare);
 
-  /*  If we got here then it's time to do the hard check.  If any two lines intersect then there is a collision.  */
+  count[0] = count[1] = 0;
 
-  for (i = 0 ; i < npol1 ; i++)
+  for (e = 0 ; e < num_edges && !hit ; e++)
     {
-      for (j = 0 ; j < npol2 ; j++)
+      p = edge[e].poly;
+      q = !p;
+
+
+      /*  Drop the other polygon's edges that end before this one starts.  */
+
+      for (k = 0, j = 0 ; k < count[q] ; k++)
+        {
+          if (edge[active[q][k]].max_x >= edge[e].min_x) active[q][j++] = active[q][k];
+        }
+      count[q] = j;
+
+      for (k = 0 ; k < count[q] ; k++)
+        {
+          j = active[q][k];
+
+          if (edge[j].max_y < edge[e].min_y || edge[j].min_y > edge[e].max_y) continue;
+
+          i0 = p ? edge[j].i : edge[e].i;
+          i1 = p ? edge[e].i : edge[j].i;
+
+          if (collision_edge_pair (a, i0, b, i1))
+            {
+              hit = NVTrue;
+              break;
+            }
+        }
+
+      active[p][count[p]++] = e;
+
+
+      /*  Keep the list from growing past the polygon size by pruning it now and then.  */
+
+      if (count[p] > poly[p]->n)
         {
-          if (i)
+          for (k = 0, j = 0 ; k < count[p] ; k++)
             {
-              if (j)
-                {
-                  if (line_intersection (poly1x[i - 1], poly1y[i - 1], poly1x[i], poly1y[i],
-                                         poly2x[j - 1], poly2y[j - 1], poly2x[j], poly2y[j], &x, &y) == 2) return (NVTrue);
-                }
-              else
-                {
-                  /*  If j is 0 then we have to check the last to first point line segment.  */
-
-                  if (line_intersection (poly1x[i - 1], poly1y[i - 1], poly1x[i], poly1y[i],
-                                         poly2x[npol2 - 1], poly2y[npol2 - 1], poly2x[j], poly2y[j], &x, &y) == 2) return (NVTrue);
-                }
+              if (edge[active[p][k]].max_x >= edge[e].min_x) active[p][j++] = active[p][k];
             }
+          count[p] = j;
+        }
+    }
+
+  free (edge);
+  free (active[0]);
+  free (active[1]);
+
+  return (hit);
+}
+
+
+
+static uint8_t collision_test (COLLISION_POLY *a, COLLISION_POLY *b)
+{
+  if (a->n < 1 || b->n < 1) return (NVFalse);
+
+
+  /*  Nothing can touch if the MBRs don't.  */
+
+  if (!collision_mbr_overlap (&a->mbr, &b->mbr)) return (NVFalse);
+
+
+  /*  Easy check first.  If any vertex of one polygon lies inside of the other then they intersect.  */
+
+  if (collision_vertex_inside (a, b) || collision_vertex_inside (b, a)) return (NVTrue);
 
 
-          /*  If i is 0 then we have to check the last to first point line segment.  */
+  /*  If we got here then it's time to do the hard check.  If any two lines intersect then there is a collision.  */
+
+  return (collision_edges (a, b));
+}
+
+
+
+static uint8_t collision_pair (COLLISION_POLY *a, COLLISION_POLY *b)
+{
+  uint8_t          ret;
+
 
+  /*  Prepare the polygons if the vertex tests would otherwise be a lot of edge walking.  */
+
+  if (collision_mbr_overlap (&a->mbr, &b->mbr) && (int64_t) a->n * b->n > 4096)
+    {
+      collision_poly_prepare (a);
+      collision_poly_prepare (b);
+    }
+
+  ret = collision_test (a, b);
+
+  free_prepared_polygon (a->pp);
+  free_prepared_polygon (b->pp);
+
+  return (ret);
+}
+
+
+
+/***************************************************************************/
+/*!
+
+  - Module Name:        polygon_collision
+
+  - Programmer(s):      Jan C. Depner
+
+  - Date Written:       December 11, 2009
+
+  - Modified:           October 2026.  Rewritten to reject on the polygon
+                        MBRs, test vertices against prepared polygons (see
+                        prepare_polygon2), and find crossing edges with a
+                        sorted sweep instead of testing every pair of edges.
+                        The answer is the same as before: the polygons
+                        intersect if a vertex of either one is inside the
+                        other (inside_polygon2 rules) or if any pair of edges
+                        intersect (line_intersection returns 2).
+
+  - Purpose:            Determines if two polygons intersect
+
+  - Arguments:
+  - Return Value:       NVTrue if they intersect, otherwise NVFalse
+
+****************************************************************************/
+
+uint8_t polygon_collision (NV_F64_COORD2 *poly1, int32_t npol1, NV_F64_COORD2 *poly2, int32_t npol2)
+{
+  COLLISION_POLY   a, b;
+
+
+  if (npol1 < 1 || npol2 < 1) return (NVFalse);
+
+  collision_poly_init (&a, &poly1[0].x, &poly1[0].y, sizeof (NV_F64_COORD2) / sizeof (double), npol1);
+  collision_poly_init (&b, &poly2[0].x, &poly2[0].y, sizeof (NV_F64_COORD2) / sizeof (double), npol2);
+
+  return (collision_pair (&a, &b));
+}
+
+
+
+uint8_t polygon_collision2 (double *poly1x, double *poly1y, int32_t npol1, double *poly2x, double *poly2y, int32_t npol2)
+{
+  COLLISION_POLY   a, b;
+
+
+  if (npol1 < 1 || npol2 < 1) return (NVFalse);
+
+  collision_poly_init (&a, poly1x, poly1y, 1, npol1);
+  collision_poly_init (&b, poly2x, poly2y, 1, npol2);
+
+  return (collision_pair (&a, &b));
+}
+
+
+
+/*  Set 2 polygon index sorted on MBR west edge.  */
+
+typedef struct
+{
+  double           min_x;
+  int32_t          index;
+} COLLISION_ORDER;
+
+
+typedef struct
+{
+  COLLISION_POLY   *poly1;
+  int32_t          count1;
+  COLLISION_POLY   *poly2;
+  int32_t          count2;
+  COLLISION_ORDER  *order2;
+  uint8_t          *result;
+} COLLISION_BATCH;
+
+
+
+static int32_t collision_order_compare (const void *a, const void *b)
+{
+  const COLLISION_ORDER *oa = (const COLLISION_ORDER *) a, *ob = (const COLLISION_ORDER *) b;
+
+  if (oa->min_x < ob->min_x) return (-1);
+  if (oa->min_x > ob->min_x) return (1);
+  return (0);
+}
+
+
+
+static void collision_prepare_chunk (int64_t start, int64_t end, void *arg)
+{
+  COLLISION_POLY   *poly = (COLLISION_POLY *) arg;
+  int64_t          i;
+
+
+  for (i = start ; i < end ; i++) collision_poly_prepare (&poly[i]);
+}
+
+
+
+static void collision_batch_chunk (int64_t start, int64_t end, void *arg)
+{
+  COLLISION_BATCH  *batch = (COLLISION_BATCH *) arg;
+  COLLISION_POLY   *a, *b;
+  int64_t          i;
+  int32_t          k, lo, hi, mid;
+
+
+  for (i = start ; i < end ; i++)
+    {
+      a = &batch->poly1[i];
+
+
+      /*  Only the polygons of the second set whose MBRs start west of our east edge can touch us.  */
+
+      lo = 0;
+      hi = batch->count2;
+      while (lo < hi)
+        {
+          mid = (lo + hi) / 2;
+          if (batch->order2[mid].min_x <= a->mbr.max_x)
+            {
+              lo = mid + 1;
+            }
           else
             {
-              if (j)
-                {
-                  if (line_intersection (poly1x[npol1 - 1], poly1y[npol1 - 1], poly1x[i], poly1y[i],
-                                         poly2x[j - 1], poly2y[j - 1], poly2x[j], poly2y[j], &x, &y) == 2) return (NVTrue);
-                }
-              else
-                {
-                  /*  If j is 0 then we have to check the last to first point line segment.  */
-
-                  if (line_intersection (poly1x[npol1 - 1], poly1y[npol1 - 1], poly1x[i], poly1y[i],
-                                         poly2x[npol2 - 1], poly2y[npol2 - 1], poly2x[j], poly2y[j], &x, &y) == 2) return (NVTrue);
-                }
+              hi = mid;
             }
         }
+
+      for (k = 0 ; k < lo ; k++)
+        {
+          b = &batch->poly2[batch->order2[k].index];
+
+          batch->result[i * batch->count2 + batch->order2[k].index] = collision_test (a, b);
+        }
     }
+}
 
-  return (NVFalse);
+
+
+/***************************************************************************/
+/*!
+
+  - Module Name:        polygon_collision_batch
+
+  - Date Written:       October 2026
+
+  - Purpose:            Runs polygon_collision2 for every polygon of one set
+                        against every polygon of a second set.  Each polygon
+                        is set up (MBR and, if it's big enough, a prepared
+                        polygon) once instead of once per pair, the second
+                        set is sorted on MBR west edge so that each polygon
+                        of the first set only looks at the candidates that
+                        can reach it, and the first set is split across
+                        threads (see parallel_for).  To check a set against
+                        itself just pass it as both sets.
+
+  - Arguments:
+                        - poly1_x  =   Array of pointers to the X coordinates of
+                                       the polygons in set 1
+                        - poly1_y  =   Array of pointers to the Y coordinates of
+                                       the polygons in set 1
+                        - npol1    =   Number of vertices in each polygon of
+                                       set 1
+                        - count1   =   Number of polygons in set 1
+                        - poly2_x  =   Set 2 X coordinates
+                        - poly2_y  =   Set 2 Y coordinates
+                        - npol2    =   Number of vertices in each polygon of
+                                       set 2
+                        - count2   =   Number of polygons in set 2
+                        - result   =   count1 * count2 array.  result[i * count2
+                                       + j] is set to NVTrue if polygon i of
+                                       set 1 intersects polygon j of set 2.
+
+  - Return Value:       NVTrue on success, NVFalse on memory allocation
+                        failure
+
+****************************************************************************/
+
+uint8_t polygon_collision_batch (double **poly1_x, double **poly1_y, int32_t *npol1, int32_t count1, double **poly2_x,
+                                 double **poly2_y, int32_t *npol2, int32_t count2, uint8_t *result)
+{
+  COLLISION_BATCH  batch;
+  int32_t          i;
+
+
+  if (count1 <= 0 || count2 <= 0) return (NVTrue);
+
+  memset (result, 0, (int64_t) count1 * count2);
+
+  batch.count1 = count1;
+  batch.count2 = count2;
+  batch.result = result;
+  batch.poly1 = (COLLISION_POLY *) calloc (count1, sizeof (COLLISION_POLY));
+  batch.poly2 = (COLLISION_POLY *) calloc (count2, sizeof (COLLISION_POLY));
+  batch.order2 = (COLLISION_ORDER *) malloc (count2 * sizeof (COLLISION_ORDER));
+
+  if (batch.poly1 == NULL || batch.poly2 == NULL || batch.order2 == NULL)
+    {
+      perror ("Allocating memory in polygon_collision_batch");
+      free (batch.poly1);
+      free (batch.poly2);
+      free (batch.order2);
+      return (NVFalse);
+    }
+
+
+  /*  Empty polygons get an inverted MBR so that they never overlap anything.  */
+
+  for (i = 0 ; i < count1 ; i++)
+    {
+      if (npol1[i] > 0)
+        {
+          collision_poly_init (&batch.poly1[i], poly1_x[i], poly1_y[i], 1, npol1[i]);
+        }
+      else
+        {
+          batch.poly1[i].mbr.min_x = batch.poly1[i].mbr.min_y = 1.0;
+          batch.poly1[i].mbr.max_x = batch.poly1[i].mbr.max_y = -1.0;
+        }
+    }
+
+  for (i = 0 ; i < count2 ; i++)
+    {
+      if (npol2[i] > 0)
+        {
+          collision_poly_init (&batch.poly2[i], poly2_x[i], poly2_y[i], 1, npol2[i]);
+        }
+      else
+        {
+          batch.poly2[i].mbr.min_x = batch.poly2[i].mbr.min_y = 1.0;
+          batch.poly2[i].mbr.max_x = batch.poly2[i].mbr.max_y = -1.0;
+        }
+
+      batch.order2[i].min_x = batch.poly2[i].mbr.min_x;
+      batch.order2[i].index = i;
+    }
+
+  parallel_for (count1, 16, collision_prepare_chunk, batch.poly1);
+  parallel_for (count2, 16, collision_prepare_chunk, batch.poly2);
+
+  qsort (batch.order2, count2, sizeof (COLLISION_ORDER), collision_order_compare);
+
+  parallel_for (count1, 1, collision_batch_chunk, &batch);
+
+  for (i = 0 ; i < count1 ; i++) free_prepared_polygon (batch.poly1[i].pp);
+  for (i = 0 ; i < count2 ; i++) free_prepared_polygon (batch.poly2[i].pp);
+
+  free (batch.poly1);
+  free (batch.poly2);
+  free (batch.order2);
+
+  return (NVTrue);
 }
@@ -52,6 +52,8 @@ extern "C" {
 
   uint8_t polygon_collision (NV_F64_COORD2 *poly1, int32_t npol1, NV_F64_COORD2 *poly2, int32_t npol2);
   uint8_t polygon_collision2 (double *poly1x, double *poly1y, int32_t npol1, double *poly2x, double *poly2y, int32_t npol2);
+  uint8_t polygon_collision_batch (double **poly1_x, double **poly1_y, int32_t *npol1, int32_t count1, double **poly2_x,
+                                   double **poly2_y, int32_t *npol2, int32_t count2, uint8_t *result);
 
 
 #ifdef  __cplusplus
@@ -37,142 +37,27 @@
 
 
 #include "polygon_intersection.h"
-#include "line_intersection.h"
-#include "inside_polygon.h"
+#include "polygon_collision.h"
 
 
 /*!
 
-  - These functions just tell you whether the polygons intersect, not what the intersection is.  This is a brute force method and I'm sure there
-    are better implementations but I really don't need the speed here.
+  - These functions just tell you whether the polygons intersect, not what the intersection is.  They used to be
+    a brute force check of every vertex and every pair of edges.  They give the same answer as polygon_collision
+    (a vertex of either polygon inside the other or any two edges crossing) so they now just call it and get
+    its MBR rejection, prepared polygons, and edge sweep.
 */
 
 uint8_t polygon_intersection (NV_F64_COORD2 *poly1, int32_t poly1_count, NV_F64_COORD2 *poly2, int32_t poly2_count)
 {
-  int32_t              i, j;
-  double               x, y;
-
-
-  /*  Check each point of polygon 1 to see if any lie inside polygon 2.  */
-
-  for (i = 0 ; i < poly1_count ; i++)
-    {
-      if (inside_polygon (poly2, poly2_count, poly1[i].x, poly1[i].y)) return (NVTrue);
-    }
-
-
-  /*  Check each point of polygon 2 to see if any lie inside polygon 1.  */
-
-  for (i = 0 ; i < poly2_count ; i++)
-    {
-      if (inside_polygon (poly1, poly1_count, poly2[i].x, poly2[i].y)) return (NVTrue);
-    }
-
-
-  /*  Now we have to check for intersection of any of the lines of each polygon.  */
-
-  for (i = 1 ; i < poly1_count ; i++)
-    {
-      for (j = 1 ; j < poly2_count ; j++)
-        {
-          if (line_intersection (poly1[i - 1].x, poly1[i - 1].y, poly1[i].x, poly1[i].y, poly2[j - 1].x, poly2[j - 1].y, poly2[j].x, poly2[j].y, &x, &y) == 2)
-            return (NVTrue);
-        }
-    }
-
-
-  /*  Now we check the polygon 2 closing line segment against the polygon 1 segments (without the closing segment).  */
-
-  for (i = 1 ; i < poly1_count ; i++)
-    {
-      if (line_intersection (poly1[i - 1].x, poly1[i - 1].y, poly1[i].x, poly1[i].y, poly2[poly2_count - 1].x, poly2[poly2_count - 1].y,
-                             poly2[0].x, poly2[0].y, &x, &y) == 2) return (NVTrue);
-    }
-      
-
-  /*  Now we check the polygon 1 closing line segment against the polygon 2 segments (without the closing segment).  */
-
-  for (i = 1 ; i < poly2_count ; i++)
-    {
-      if (line_intersection (poly2[i - 1].x, poly2[i - 1].y, poly2[i].x, poly2[i].y, poly1[poly1_count - 1].x, poly1[poly1_count - 1].y,
-                             poly1[0].x, poly1[0].y, &x, &y) == 2) return (NVTrue);
-    }
-      
-
-  /*  Finally, we check the closing segments against each other.  */
-
-  if (line_intersection (poly2[poly2_count - 1].x, poly2[poly2_count - 1].y, poly2[0].x, poly2[0].y, poly1[poly1_count - 1].x, poly1[poly1_count - 1].y,
-                         poly1[0].x, poly1[0].y, &x, &y) == 2) return (NVTrue);
-
-
-  /*  If we got here there is no intersection.  */
-
-  return (NVFalse);
+  return (polygon_collision (poly1, poly1_count, poly2, poly2_count));
 }
 
 
 uint8_t polygon_intersection2 (double *poly1_x, double *poly1_y, int32_t poly1_count, double *poly2_x, double *poly2_y,
                                int32_t poly2_count)
 {
-  int32_t              i, j;
-  double               x, y;
-
-
-  /*  Check each point of polygon 1 to see if any lie inside polygon 2.  */
-
-  for (i = 0 ; i < poly1_count ; i++)
-    {
-      if (inside_polygon2 (poly2_x, poly2_y, poly2_count, poly1_x[i], poly1_y[i])) return (NVTrue);
-    }
-
-
-  /*  Check each point of polygon 2 to see if any lie inside polygon 1.  */
-
-  for (i = 0 ; i < poly2_count ; i++)
-    {
-      if (inside_polygon2 (poly1_x, poly1_y, poly1_count, poly2_x[i], poly2_y[i])) return (NVTrue);
-    }
-
-
-  /*  Now we have to check for intersection of any of the lines of each polygon.  */
-
-  for (i = 1 ; i < poly1_count ; i++)
-    {
-      for (j = 1 ; j < poly2_count ; j++)
-        {
-          if (line_intersection (poly1_x[i - 1], poly1_y[i - 1], poly1_x[i], poly1_y[i], poly2_x[j - 1], poly2_y[j - 1], poly2_x[j], poly2_y[j], &x, &y) == 2)
-            return (NVTrue);
-        }
-    }
-
-
-  /*  Now we check the polygon 2 closing line segment against the polygon 1 segments (without the closing segment).  */
-
-  for (i = 1 ; i < poly1_count ; i++)
-    {
-      if (line_intersection (poly1_x[i - 1], poly1_y[i - 1], poly1_x[i], poly1_y[i], poly2_x[poly2_count - 1], poly2_y[poly2_count - 1],
-                             poly2_x[0], poly2_y[0], &x, &y) == 2) return (NVTrue);
-    }
-      
-
-  /*  Now we check the polygon 1 closing line segment against the polygon 2 segments (without the closing segment).  */
-
-  for (i = 1 ; i < poly2_count ; i++)
-    {
-      if (line_intersection (poly2_x[i - 1], poly2_y[i - 1], poly2_x[i], poly2_y[i], poly1_x[poly1_count - 1], poly1_y[poly1_count - 1],
-                             poly1_x[0], poly1_y[0], &x, &y) == 2) return (NVTrue);
-    }
-      
-
-  /*  Finally, we check the closing segments against each other.  */
-
-  if (line_intersection (poly2_x[poly2_count - 1], poly2_y[poly2_count - 1], poly2_x[0], poly2_y[0], poly1_x[poly1_count - 1], poly1_y[poly1_count - 1],
-                         poly1_x[0], poly1_y[0], &x, &y) == 2) return (NVTrue);
-
-
-  /*  If we got here there is no intersection.  */
-
-  return (NVFalse);
+  return (polygon_collision2 (poly1_x, poly1_y, poly1_count, poly2_x, poly2_y, poly2_count));
 }
 
 
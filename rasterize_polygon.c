@@ -0,0 +1,377 @@
+
+/*********************************************************************************************
+
+    This is public domain software that was developed by or for the U.S. Naval Oceanographic
+    Office and/or the U.S. Army Corps of Engineers.
+
+    This is a work of the U.S. Government. In accordance with 17 USC 105, copyright protection
+    is not available for any work of the U.S. Government.
+
+    Neither the United States Government, nor any employees of the United States Government,
+    nor the author, makes any warranty, express or implied, without even the implied warranty
+    of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE, or assumes any liability or
+    responsibility for the accuracy, completeness, or usefulness of any information,
+    apparatus, product, or process disclosed, or represents that its use would not infringe
+    privately-owned rights. Reference herein to any specific commercial products, process,
+    or service by trade name, trademark, manufacturer, or otherwise, does not necessarily
+    constitute or imply its endorsement, recommendation, or favoring by the United States
+    Government. The views and opinions of authors expressed herein do not necessarily state
+    or reflect those of the United States Government, and shall not be used for advertising
+    or product endorsement purposes.
+*********************************************************************************************/
+
+
+/****************************************  IMPORTANT NOTE  **********************************
+
+    Comments in this file that start with / * ! are being used by Doxygen to document the
+    software.  Dashes in these comment blocks are used to create bullet lists.  The lack of
+    blank lines after a block of dash preceeded comments means that the next block of dash
+    preceeded comments is a new, indented bullet list.  I've tried to keep the Doxygen
+    formatting to a minimum but there are some other items (like <br> and <pre>) that need
+    to be left alone.  If you see a comment that starts with / * ! and there is something
+    that looks a bit weird it is probably due to some arcane Doxygen syntax.  Be very
+    careful modifying blocks of Doxygen comments.
+
+*****************************************  IMPORTANT NOTE  **********************************/
+
+
+
+#include <string.h>
+#include <math.h>
+
+#include "nvdef.h"
+#include "rasterize_polygon.h"
+
+
+/*  Polygon edge from vertex j (the previous vertex) to vertex i.  This is the same way inside_polygon2 walks the
+    polygon so the crossing test below is evaluated with exactly the same arithmetic.  */
+
+typedef struct
+{
+  double           xi;
+  double           yi;
+  double           xj;
+  double           yj;
+  int32_t          first_row;
+  int32_t          last_row;
+} RASTER_EDGE;
+
+
+/*  Where an edge crosses a row.  Every bin center to the left of column "col" sees the crossing.  */
+
+typedef struct
+{
+  int32_t          col;
+  int32_t          winding;
+} RASTER_CROSSING;
+
+
+
+/***************************************************************************/
+/*!
+
+  - Module Name:        rasterize_polygon_size
+
+  - Date Written:       October 2026
+
+  - Purpose:            Computes the dimensions of the bin mask that
+                        rasterize_polygon will build for an MBR and bin
+                        size.  The mask needs height * row_bytes bytes.
+
+  - Arguments:
+                        - mbr          =   MBR of the grid
+                        - x_bin_size   =   Bin size in X
+                        - y_bin_size   =   Bin size in Y
+                        - width        =   Returned number of columns
+                        - height       =   Returned number of rows
+                        - row_bytes    =   Returned number of bytes per row
+                                           of the mask
+
+  - Return Value:       None
+
+****************************************************************************/
+
+void rasterize_polygon_size (NV_F64_XYMBR mbr, double x_bin_size, double y_bin_size, int32_t *width, int32_t *height,
+                             int32_t *row_bytes)
+{
+  *width = MAX (NINT ((mbr.max_x - mbr.min_x) / x_bin_size), 0);
+  *height = MAX (NINT ((mbr.max_y - mbr.min_y) / y_bin_size), 0);
+  *row_bytes = (*width + 7) / 8;
+}
+
+
+
+/*  The inside_polygon2 crossing test for one edge.  Returns 1 if the edge toggles the inside flag for the point
+    (x, y).  The edge must straddle y.  For a given row this is true for every X left of the crossing and false
+    for every X right of it.  */
+
+static int32_t raster_toggles (RASTER_EDGE *e, double x, double y)
+{
+  int32_t          yflag1 = (e->yi >= y);
+
+  return (((e->yi - y) * (e->xj - e->xi) >= (e->xi - x) * (e->yj - e->yi)) == yflag1);
+}
+
+
+
+static int32_t raster_compare (const void *a, const void *b)
+{
+  const RASTER_CROSSING *ca = (const RASTER_CROSSING *) a, *cb = (const RASTER_CROSSING *) b;
+
+  return ((ca->col > cb->col) - (ca->col < cb->col));
+}
+
+
+
+/*  Clamp a floating point bin estimate to [lo, hi] before converting it (it may be huge or NaN).  */
+
+static int32_t raster_clamp (double v, int32_t lo, int32_t hi)
+{
+  if (!(v > lo)) return (lo);
+  if (v > hi) return (hi);
+
+  return ((int32_t) v);
+}
+
+
+
+/*  Set bits [start, end) in a mask row.  */
+
+static void raster_fill (uint8_t *row, int32_t start, int32_t end)
+{
+  int32_t          first_byte, last_byte;
+
+
+  if (start >= end) return;
+
+  first_byte = start >> 3;
+  last_byte = (end - 1) >> 3;
+
+  if (first_byte == last_byte)
+    {
+      row[first_byte] |= (uint8_t) ((0xff << (start & 7)) & (0xff >> (7 - ((end - 1) & 7))));
+      return;
+    }
+
+  row[first_byte] |= (uint8_t) (0xff << (start & 7));
+  if (last_byte - first_byte > 1) memset (&row[first_byte + 1], 0xff, last_byte - first_byte - 1);
+  row[last_byte] |= (uint8_t) (0xff >> (7 - ((end - 1) & 7)));
+}
+
+
+
+static uint8_t raster_core (const double *px, const double *py, int32_t stride, int32_t npol, NV_F64_XYMBR mbr,
+                            double x_bin_size, double y_bin_size, int32_t fill_rule, uint8_t *mask)
+{
+  RASTER_EDGE      *edge, *e;
+  RASTER_CROSSING  *cross;
+  int32_t          *row_start, *order, *active, width, height, row_bytes, num_edges, num_active, num_cross,
+                   i, j, k, r, c, prev, wind, keep;
+  double           lo, hi, x, y;
+
+
+  rasterize_polygon_size (mbr, x_bin_size, y_bin_size, &width, &height, &row_bytes);
+
+  if (!width || !height) return (NVTrue);
+
+  memset (mask, 0, (size_t) height * row_bytes);
+
+  if (npol < 3) return (NVTrue);
+
+
+  edge = (RASTER_EDGE *) malloc (npol * sizeof (RASTER_EDGE));
+  cross = (RASTER_CROSSING *) malloc (npol * sizeof (RASTER_CROSSING));
+  order = (int32_t *) malloc (npol * sizeof (int32_t));
+  active = (int32_t *) malloc (npol * sizeof (int32_t));
+  row_start = (int32_t *) calloc (height + 1, sizeof (int32_t));
+
+  if (edge == NULL || cross == NULL || order == NULL || active == NULL || row_start == NULL)
+    {
+      perror ("Allocating memory in rasterize_polygon");
+      free (edge);
+      free (cross);
+      free (order);
+      free (active);
+      free (row_start);
+      return (NVFalse);
+    }
+
+
+  /*  Build the edge table.  An edge can only change the inside flag for rows whose bin center Y is in
+      (min y, max y] (that's when the yflag test in inside_polygon2 differs for its two ends).  The row range is
+      estimated and then nudged using the exact bin center values so horizontal edges and edges that end on a
+      bin center are handled the same way inside_polygon2 would handle them.  */
+
+  num_edges = 0;
+  j = npol - 1;
+
+  for (i = 0 ; i < npol ; i++)
+    {
+      e = &edge[num_edges];
+      e->xi = px[(int64_t) i * stride];
+      e->yi = py[(int64_t) i * stride];
+      e->xj = px[(int64_t) j * stride];
+      e->yj = py[(int64_t) j * stride];
+      j = i;
+
+      lo = MIN (e->yi, e->yj);
+      hi = MAX (e->yi, e->yj);
+
+      r = raster_clamp (floor ((lo - mbr.min_y) / y_bin_size - 0.5), 0, height);
+      while (r > 0 && mbr.min_y + ((double) (r - 1) + 0.5) * y_bin_size > lo) r--;
+      while (r < height && mbr.min_y + ((double) r + 0.5) * y_bin_size <= lo) r++;
+      e->first_row = r;
+
+      r = raster_clamp (floor ((hi - mbr.min_y) / y_bin_size - 0.5), -1, height - 1);
+      while (r + 1 < height && mbr.min_y + ((double) (r + 1) + 0.5) * y_bin_size <= hi) r++;
+      while (r >= 0 && mbr.min_y + ((double) r + 0.5) * y_bin_size > hi) r--;
+      e->last_row = r;
+
+      if (e->first_row > e->last_row) continue;
+
+      row_start[e->first_row + 1]++;
+      num_edges++;
+    }
+
+
+  /*  Bucket the edges by the first row they hit.  */
+
+  for (r = 0 ; r < height ; r++) row_start[r + 1] += row_start[r];
+
+  for (k = 0 ; k < num_edges ; k++) order[row_start[edge[k].first_row]++] = k;
+
+  for (r = height ; r > 0 ; r--) row_start[r] = row_start[r - 1];
+  row_start[0] = 0;
+
+
+  /*  Sweep the rows.  For each row find the first column that each active edge doesn't toggle (all columns to
+      the left of that are toggled), sort those, and fill the spans between them.  */
+
+  num_active = 0;
+
+  for (r = 0 ; r < height ; r++)
+    {
+      y = mbr.min_y + ((double) r + 0.5) * y_bin_size;
+
+      keep = 0;
+      for (k = 0 ; k < num_active ; k++)
+        {
+          if (edge[active[k]].last_row >= r) active[keep++] = active[k];
+        }
+      num_active = keep;
+
+      for (k = row_start[r] ; k < row_start[r + 1] ; k++) active[num_active++] = order[k];
+
+      if (!num_active) continue;
+
+
+      num_cross = 0;
+      wind = 0;
+
+      for (k = 0 ; k < num_active ; k++)
+        {
+          e = &edge[active[k]];
+
+          x = e->xi + (y - e->yi) * (e->xj - e->xi) / (e->yj - e->yi);
+          c = raster_clamp (ceil ((x - mbr.min_x) / x_bin_size - 0.5), 0, width);
+
+          while (c < width && raster_toggles (e, mbr.min_x + ((double) c + 0.5) * x_bin_size, y)) c++;
+          while (c > 0 && !raster_toggles (e, mbr.min_x + ((double) (c - 1) + 0.5) * x_bin_size, y)) c--;
+
+          if (!c) continue;
+
+          cross[num_cross].col = c;
+          cross[num_cross].winding = (e->yi >= y) ? 1 : -1;
+          wind += cross[num_cross].winding;
+          num_cross++;
+        }
+
+      qsort (cross, num_cross, sizeof (RASTER_CROSSING), raster_compare);
+
+
+      /*  Left of the first crossing column every crossing is seen.  Each time we pass one it drops out.  */
+
+      prev = 0;
+      for (k = 0 ; k < num_cross ; k++)
+        {
+          if (fill_rule == RASTERIZE_NONZERO ? (wind != 0) : ((num_cross - k) & 1))
+            raster_fill (&mask[(int64_t) r * row_bytes], prev, cross[k].col);
+
+          prev = cross[k].col;
+          wind -= cross[k].winding;
+        }
+    }
+
+
+  free (edge);
+  free (cross);
+  free (order);
+  free (active);
+  free (row_start);
+
+  return (NVTrue);
+}
+
+
+
+/***************************************************************************/
+/*!
+
+  - Module Name:        rasterize_polygon
+
+  - Date Written:       October 2026
+
+  - Purpose:            Builds a packed bit mask of the bins of a grid whose
+                        centers are inside a polygon.  This is a scanline
+                        rasterizer so it costs O(bins + edges) instead of
+                        calling inside_polygon2 for every bin center.  With
+                        RASTERIZE_EVEN_ODD the result is identical to
+                        calling inside_polygon2 at every bin center.
+                        RASTERIZE_NONZERO uses the same crossings but
+                        counts windings instead (this only differs for self
+                        intersecting polygons).
+
+  - Arguments (rasterize_polygon):
+                        - poly         =   Array of NV_F64_COORD2 structures
+                                           holding the polygon points
+                        - npol         =   Number of points in the polygon
+                        - mbr          =   MBR of the grid
+                        - x_bin_size   =   Bin size in X
+                        - y_bin_size   =   Bin size in Y
+                        - fill_rule    =   RASTERIZE_EVEN_ODD or
+                                           RASTERIZE_NONZERO
+                        - mask         =   Mask to be filled (see
+                                           rasterize_polygon_size for the
+                                           dimensions)
+
+  - Arguments (rasterize_polygon2):
+                        - poly_x       =   Array containing the X coordinates
+                                           of the polygon's vertices
+                        - poly_y       =   Array containing the Y coordinates
+                                           of the polygon's vertices
+                        - (the rest are the same as rasterize_polygon)
+
+  - Return Value:       NVTrue, or NVFalse on memory allocation failure
+
+  - Caveats:            Row 0 of the mask is the southern (min_y) row and
+                        bit (col & 7) of byte (col >> 3) of each row is
+                        column col (see RASTERIZE_MASK_TEST).  The center
+                        of bin (row, col) is at
+                        mbr.min_x + (col + 0.5) * x_bin_size,
+                        mbr.min_y + (row + 0.5) * y_bin_size.
+
+****************************************************************************/
+
+uint8_t rasterize_polygon (NV_F64_COORD2 *poly, int32_t npol, NV_F64_XYMBR mbr, double x_bin_size, double y_bin_size,
+                           int32_t fill_rule, uint8_t *mask)
+{
+  return (raster_core (&poly[0].x, &poly[0].y, 2, npol, mbr, x_bin_size, y_bin_size, fill_rule, mask));
+}
+
+
+
+uint8_t rasterize_polygon2 (double *poly_x, double *poly_y, int32_t npol, NV_F64_XYMBR mbr, double x_bin_size,
+                            double y_bin_size, int32_t fill_rule, uint8_t *mask)
+{
+  return (raster_core (poly_x, poly_y, 1, npol, mbr, x_bin_size, y_bin_size, fill_rule, mask));
+}
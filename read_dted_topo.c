@@ -0,0 +1,718 @@
+
+/*********************************************************************************************
+
+    This is public domain software that was developed by or for the U.S. Naval Oceanographic
+    Office and/or the U.S. Army Corps of Engineers.
+
+    This is a work of the U.S. Government. In accordance with 17 USC 105, copyright protection
+    is not available for any work of the U.S. Government.
+
+    Neither the United States Government, nor any employees of the United States Government,
+    nor the author, makes any warranty, express or implied, without even the implied warranty
+    of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE, or assumes any liability or
+    responsibility for the accuracy, completeness, or usefulness of any information,
+    apparatus, product, or process disclosed, or represents that its use would not infringe
+    privately-owned rights. Reference herein to any specific commercial products, process,
+    or service by trade name, trademark, manufacturer, or otherwise, does not necessarily
+    constitute or imply its endorsement, recommendation, or favoring by the United States
+    Government. The views and opinions of authors expressed herein do not necessarily state
+    or reflect those of the United States Government, and shall not be used for advertising
+    or product endorsement purposes.
+*********************************************************************************************/
+
+
+/****************************************  IMPORTANT NOTE  **********************************
+
+    Comments in this file that start with / * ! are being used by Doxygen to document the
+    software.  Dashes in these comment blocks are used to create bullet lists.  The lack of
+    blank lines after a block of dash preceeded comments means that the next block of dash
+    preceeded comments is a new, indented bullet list.  I've tried to keep the Doxygen
+    formatting to a minimum but there are some other items (like <br> and <pre>) that need
+    to be left alone.  If you see a comment that starts with / * ! and there is something
+    that looks a bit weird it is probably due to some arcane Doxygen syntax.  Be very
+    careful modifying blocks of Doxygen comments.
+
+*****************************************  IMPORTANT NOTE  **********************************/
+
+
+
+#include <math.h>
+#include <pthread.h>
+
+#ifndef NVWIN3X
+  #include <dirent.h>
+#else
+  #include <windows.h>
+#endif
+
+#include "read_dted_topo.h"
+
+
+/*  One DTED file in the mosaic.  */
+
+typedef struct
+{
+  char          *path;                               /*  File name  */
+  UHL           uhl;                                 /*  User header label (origin, spacing, and size)  */
+  int16_t       *grid;                               /*  Decoded posts (row major, south to north) or NULL if not in the cache  */
+  int64_t       stamp;                               /*  Last time the tile was used  */
+  uint8_t       bad;                                 /*  Set if the file couldn't be decoded so we don't keep trying  */
+} DTED_TILE;
+
+
+static DTED_TILE *tile = NULL;
+static int32_t num_tiles = 0;
+static int32_t *tile_map = NULL;                     /*  180 by 360 one degree cells, tile number + 1 (0 for no tile)  */
+static int64_t cache_size = DTED_TOPO_CACHE_SIZE;
+static int64_t cache_used = 0;
+static int64_t stamp = 0;
+static pthread_mutex_t dted_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+
+
+/*  Return the one degree cell number containing the cell whose southwest corner is lat, lon.  Longitudes are
+    wrapped into -180 to 180.  Returns -1 if the latitude is out of range.  */
+
+static int32_t dted_cell (int32_t ilat, int32_t ilon)
+{
+  if (ilat < -90 || ilat > 89) return (-1);
+
+  while (ilon >= 180) ilon -= 360;
+  while (ilon < -180) ilon += 360;
+
+  return ((ilat + 90) * 360 + ilon + 180);
+}
+
+
+
+/*  Return the tile number covering a position or -1 if there isn't one.  */
+
+static int32_t dted_tile_at (double lat, double lon)
+{
+  int32_t            cell;
+
+
+  if (lat >= 90.0) lat = 89.999999999;
+
+  if (tile_map == NULL || (cell = dted_cell ((int32_t) floor (lat), (int32_t) floor (lon))) < 0) return (-1);
+
+  return (tile_map[cell] - 1);
+}
+
+
+
+/*  Check a file name for a .dt0, .dt1, or .dt2 extension.  */
+
+static uint8_t is_dted_file (const char *name)
+{
+  size_t             len = strlen (name);
+
+
+  if (len < 5 || name[len - 4] != '.' || (name[len - 3] != 'd' && name[len - 3] != 'D') ||
+      (name[len - 2] != 't' && name[len - 2] != 'T') || name[len - 1] < '0' || name[len - 1] > '2') return (NVFalse);
+
+  return (NVTrue);
+}
+
+
+
+/*  Add a DTED file to the index.  If we already have a file for the same cell we keep the one with the finer
+    post spacing.  */
+
+static void add_dted_file (const char *path)
+{
+  FILE               *fp;
+  UHL                uhl;
+  int32_t            cell, t;
+  DTED_TILE          *new_tile;
+
+
+  if ((fp = fopen (path, "rb")) == NULL) return;
+
+  if (read_uhl (fp, &uhl) || !uhl.num_lon_lines || !uhl.num_lat_points || uhl.lat_int <= 0.0 || uhl.lon_int <= 0.0)
+    {
+      fclose (fp);
+      return;
+    }
+
+  fclose (fp);
+
+
+  if ((cell = dted_cell ((int32_t) floor (uhl.ll_lat + 0.5 / 3600.0), (int32_t) floor (uhl.ll_lon + 0.5 / 3600.0))) < 0) return;
+
+
+  if (tile_map[cell])
+    {
+      t = tile_map[cell] - 1;
+
+      if (tile[t].uhl.lat_int <= uhl.lat_int) return;
+
+      free (tile[t].path);
+    }
+  else
+    {
+      new_tile = (DTED_TILE *) realloc (tile, (num_tiles + 1) * sizeof (DTED_TILE));
+      if (new_tile == NULL)
+        {
+          perror ("Allocating DTED tile memory");
+          return;
+        }
+
+      tile = new_tile;
+      t = num_tiles++;
+      tile_map[cell] = t + 1;
+    }
+
+
+  memset (&tile[t], 0, sizeof (DTED_TILE));
+  tile[t].uhl = uhl;
+  tile[t].path = (char *) malloc (strlen (path) + 1);
+  if (tile[t].path == NULL)
+    {
+      perror ("Allocating DTED path memory");
+      exit (-1);
+    }
+  strcpy (tile[t].path, path);
+}
+
+
+
+/*  Recursively scan a directory for DTED files (DTED is normally stored as DIR/eLLL/nLL.dt?).  */
+
+static void scan_dted_dir (const char *dir)
+{
+  char               path[2048];
+
+#ifndef NVWIN3X
+  struct dirent      *dp;
+  DIR                *directory;
+
+
+  if ((directory = opendir (dir)) == NULL) return;
+
+  while ((dp = readdir (directory)) != NULL)
+    {
+      if (dp->d_name[0] == '.') continue;
+
+      snprintf (path, sizeof (path), "%s%1c%s", dir, SEPARATOR, dp->d_name);
+
+      if (is_dted_file (dp->d_name))
+        {
+          add_dted_file (path);
+        }
+      else
+        {
+          scan_dted_dir (path);
+        }
+    }
+
+  closedir (directory);
+#else
+  WIN32_FIND_DATA    find_data;
+  HANDLE             handle;
+
+
+  snprintf (path, sizeof (path), "%s%1c*", dir, SEPARATOR);
+
+  if ((handle = FindFirstFile (path, &find_data)) == INVALID_HANDLE_VALUE) return;
+
+  do
+    {
+      if (find_data.cFileName[0] == '.') continue;
+
+      snprintf (path, sizeof (path), "%s%1c%s", dir, SEPARATOR, find_data.cFileName);
+
+      if (find_data.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY)
+        {
+          scan_dted_dir (path);
+        }
+      else if (is_dted_file (find_data.cFileName))
+        {
+          add_dted_file (path);
+        }
+    } while (FindNextFile (handle, &find_data));
+
+  FindClose (handle);
+#endif
+}
+
+
+
+/*  Free the decoded grid of a tile.  */
+
+static void dted_release (DTED_TILE *t)
+{
+  if (t->grid == NULL) return;
+
+  free (t->grid);
+  t->grid = NULL;
+  cache_used -= (int64_t) t->uhl.num_lon_lines * t->uhl.num_lat_points * sizeof (int16_t);
+}
+
+
+
+/*  Return the decoded grid for a tile, loading it (and dropping the least recently used tiles if we're over
+    the cache size) if needed.  Must be called with dted_mutex locked.  Returns NULL if the tile can't be
+    read.  */
+
+static int16_t *dted_grid (int32_t t)
+{
+  int32_t            i, lru;
+  int64_t            bytes;
+  UHL                uhl;
+
+
+  tile[t].stamp = ++stamp;
+
+  if (tile[t].grid != NULL) return (tile[t].grid);
+  if (tile[t].bad) return (NULL);
+
+
+  bytes = (int64_t) tile[t].uhl.num_lon_lines * tile[t].uhl.num_lat_points * sizeof (int16_t);
+
+
+  /*  Make room (we always keep at least the tile we're loading).  */
+
+  while (cache_used && cache_used + bytes > cache_size)
+    {
+      lru = -1;
+      for (i = 0 ; i < num_tiles ; i++)
+        {
+          if (tile[i].grid != NULL && (lru < 0 || tile[i].stamp < tile[lru].stamp)) lru = i;
+        }
+
+      if (lru < 0) break;
+
+      dted_release (&tile[lru]);
+    }
+
+
+  if (dted_load_tile (tile[t].path, &uhl, &tile[t].grid))
+    {
+      fprintf (stderr, "Unable to read DTED file %s\n", tile[t].path);
+      fflush (stderr);
+      tile[t].bad = NVTrue;
+      return (NULL);
+    }
+
+  cache_used += bytes;
+
+  return (tile[t].grid);
+}
+
+
+
+/*  Nearest post to lat, lon in a tile.  */
+
+static int16_t dted_post (int32_t t, int16_t *grid, double lat, double lon)
+{
+  int32_t            row, col;
+  UHL                *uhl = &tile[t].uhl;
+
+
+  while (lon - uhl->ll_lon >= 180.0) lon -= 360.0;
+  while (lon - uhl->ll_lon < -180.0) lon += 360.0;
+
+  row = NINT ((lat - uhl->ll_lat) * 3600.0 / uhl->lat_int);
+  col = NINT ((lon - uhl->ll_lon) * 3600.0 / uhl->lon_int);
+
+  row = MIN (MAX (row, 0), uhl->num_lat_points - 1);
+  col = MIN (MAX (col, 0), uhl->num_lon_lines - 1);
+
+  return (grid[row * uhl->num_lon_lines + col]);
+}
+
+
+
+/***************************************************************************/
+/*!
+
+  - Function:    open_dted_topo
+
+  - Purpose:     Build an index of all of the DTED level 0, 1, and 2
+                 files (*.dt0, *.dt1, *.dt2) in a directory tree by the
+                 origin in each file's UHL record.  If there is more than
+                 one file for a one degree cell the one with the finest
+                 post spacing is used.  Any previously opened directory
+                 is closed first.  Tiles are decoded (see dted_load_tile)
+                 the first time they are needed and kept in a least
+                 recently used cache (see set_dted_topo_cache_size).
+
+  - Date:        10/18/26
+
+  - Arguments:   dir            -    Top level DTED directory
+
+  - Returns:     int32_t        =    Number of DTED files indexed
+
+****************************************************************************/
+
+int32_t open_dted_topo (const char *dir)
+{
+  cleanup_dted_topo ();
+
+
+  pthread_mutex_lock (&dted_mutex);
+
+  tile_map = (int32_t *) calloc (180 * 360, sizeof (int32_t));
+  if (tile_map == NULL)
+    {
+      perror ("Allocating DTED tile map memory");
+      pthread_mutex_unlock (&dted_mutex);
+      return (0);
+    }
+
+  scan_dted_dir (dir);
+
+  pthread_mutex_unlock (&dted_mutex);
+
+  return (num_tiles);
+}
+
+
+
+/***************************************************************************/
+/*!
+
+  - Function:    set_dted_topo_cache_size
+
+  - Purpose:     Set the maximum amount of memory used for decoded DTED
+                 tiles.  A level 2 tile is about 26MB, a level 1 tile is
+                 about 2.6MB.  The default is DTED_TOPO_CACHE_SIZE.
+
+  - Date:        10/18/26
+
+  - Arguments:   bytes          -    Cache size in bytes
+
+  - Returns:     N/A
+
+****************************************************************************/
+
+void set_dted_topo_cache_size (int64_t bytes)
+{
+  pthread_mutex_lock (&dted_mutex);
+  cache_size = bytes;
+  pthread_mutex_unlock (&dted_mutex);
+}
+
+
+
+/***************************************************************************/
+/*!
+
+  - Function:    read_dted_topo_one_degree
+
+  - Purpose:     Return the decoded posts for the DTED file covering the
+                 one degree cell whose southwest corner is lat, lon.  The
+                 array is row major from the southwest corner (west to
+                 east, then south to north) with uhl->num_lon_lines
+                 columns and uhl->num_lat_points rows.  Note that this is
+                 flipped north to south from the SRTM one degree arrays.
+                 The array belongs to the tile cache and is only valid
+                 until the next call to any of the read_dted_topo
+                 functions.
+
+  - Date:        10/18/26
+
+  - Arguments:
+                 - lat            =    Degree of latitude, S negative
+                 - lon            =    Degree of longitude, W negative
+                 - uhl            =    Returned UHL record
+                 - array          =    Returned post array
+
+  - Returns:     int32_t          =    Number of longitude lines (width
+                                       of the array) or -1 if there is
+                                       no readable DTED file for the cell
+
+****************************************************************************/
+
+int32_t read_dted_topo_one_degree (int32_t lat, int32_t lon, UHL *uhl, int16_t **array)
+{
+  int32_t            t, cell;
+
+
+  pthread_mutex_lock (&dted_mutex);
+
+  if (tile_map == NULL || (cell = dted_cell (lat, lon)) < 0 || (t = tile_map[cell] - 1) < 0 || (*array = dted_grid (t)) == NULL)
+    {
+      pthread_mutex_unlock (&dted_mutex);
+      return (-1);
+    }
+
+  *uhl = tile[t].uhl;
+
+  pthread_mutex_unlock (&dted_mutex);
+
+  return (uhl->num_lon_lines);
+}
+
+
+
+/***************************************************************************/
+/*!
+
+  - Function:    read_dted_topo
+
+  - Purpose:     Return the elevation of the DTED post nearest to a
+                 position.
+
+  - Date:        10/18/26
+
+  - Arguments:
+                 - lat            =    Latitude degrees, S negative
+                 - lon            =    Longitude degrees, W negative
+
+  - Returns:     int16_t          =    Elevation in meters, DTED_TOPO_VOID
+                                       for a void post, or
+                                       DTED_TOPO_UNDEFINED if there is no
+                                       readable DTED file for the position
+
+****************************************************************************/
+
+int16_t read_dted_topo (double lat, double lon)
+{
+  int32_t            t;
+  int16_t            *grid, elev = DTED_TOPO_UNDEFINED;
+
+
+  pthread_mutex_lock (&dted_mutex);
+
+  if ((t = dted_tile_at (lat, lon)) >= 0 && (grid = dted_grid (t)) != NULL) elev = dted_post (t, grid, lat, lon);
+
+  pthread_mutex_unlock (&dted_mutex);
+
+  return (elev);
+}
+
+
+
+/*  Batch request (cell number and index into the caller's arrays).  */
+
+typedef struct
+{
+  int32_t       t;
+  int32_t       ndx;
+} DTED_REQUEST;
+
+
+static int dted_request_compare (const void *a, const void *b)
+{
+  const DTED_REQUEST *ra = (const DTED_REQUEST *) a, *rb = (const DTED_REQUEST *) b;
+
+  if (ra->t != rb->t) return (ra->t < rb->t ? -1 : 1);
+  return (ra->ndx < rb->ndx ? -1 : (ra->ndx > rb->ndx));
+}
+
+
+
+/***************************************************************************/
+/*!
+
+  - Function:    read_dted_topo_batch
+
+  - Purpose:     Batch version of read_dted_topo.  The positions are
+                 grouped by tile so that each tile is only looked up (and
+                 decoded if needed) once no matter what order the positions
+                 are in.
+
+  - Date:        10/18/26
+
+  - Arguments:
+                 - lat            =    Array of latitudes
+                 - lon            =    Array of longitudes
+                 - count          =    Number of positions
+                 - elev           =    Returned elevations (see
+                                       read_dted_topo)
+
+  - Returns:     N/A
+
+****************************************************************************/
+
+void read_dted_topo_batch (const double *lat, const double *lon, int32_t count, int16_t *elev)
+{
+  int32_t            i, j, n;
+  int16_t            *grid;
+  DTED_REQUEST       *req;
+
+
+  if (count <= 0) return;
+
+  req = (DTED_REQUEST *) malloc (count * sizeof (DTED_REQUEST));
+  if (req == NULL)
+    {
+      perror ("Allocating DTED request memory");
+      for (i = 0 ; i < count ; i++) elev[i] = read_dted_topo (lat[i], lon[i]);
+      return;
+    }
+
+
+  pthread_mutex_lock (&dted_mutex);
+
+  n = 0;
+  for (i = 0 ; i < count ; i++)
+    {
+      elev[i] = DTED_TOPO_UNDEFINED;
+
+      if ((req[n].t = dted_tile_at (lat[i], lon[i])) >= 0)
+        {
+          req[n].ndx = i;
+          n++;
+        }
+    }
+
+  qsort (req, n, sizeof (DTED_REQUEST), dted_request_compare);
+
+  for (i = 0 ; i < n ; i = j)
+    {
+      grid = dted_grid (req[i].t);
+
+      for (j = i ; j < n && req[j].t == req[i].t ; j++)
+        {
+          if (grid != NULL) elev[req[j].ndx] = dted_post (req[j].t, grid, lat[req[j].ndx], lon[req[j].ndx]);
+        }
+    }
+
+  pthread_mutex_unlock (&dted_mutex);
+
+  free (req);
+}
+
+
+
+/***************************************************************************/
+/*!
+
+  - Function:    read_dted_topo_area
+
+  - Purpose:     Extract a regular grid of elevations covering an MBR.
+                 Each grid point gets the value of the nearest DTED post.
+                 The work is done one degree cell at a time so each tile
+                 is only decoded once.  The MBR may cross the dateline
+                 (wlon > elon).
+
+  - Date:        10/18/26
+
+  - Arguments:
+                 - mbr            =    Area to extract
+                 - lat_inc        =    Grid spacing in latitude (degrees)
+                 - lon_inc        =    Grid spacing in longitude (degrees)
+                 - rows           =    Returned number of rows
+                 - cols           =    Returned number of columns
+                 - grid           =    Returned grid, row major from the
+                                       southwest corner (west to east,
+                                       then south to north).  Positions not
+                                       covered by DTED are set to
+                                       DTED_TOPO_UNDEFINED.  This is
+                                       allocated here and must be freed by
+                                       the caller.
+
+  - Returns:     int32_t          =    Number of grid points covered by
+                                       DTED or -1 on error
+
+****************************************************************************/
+
+int32_t read_dted_topo_area (NV_F64_MBR mbr, double lat_inc, double lon_inc, int32_t *rows, int32_t *cols, int16_t **grid)
+{
+  int32_t            i, j, ilat, ilon, t, cell, r_start, r_end, c_start, c_end, covered = 0;
+  int16_t            *posts, *out;
+  double             elon;
+
+
+  *grid = NULL;
+  *rows = *cols = 0;
+
+  if (lat_inc <= 0.0 || lon_inc <= 0.0 || mbr.nlat < mbr.slat) return (-1);
+
+  elon = mbr.elon;
+  if (elon < mbr.wlon) elon += 360.0;
+
+  *rows = (int32_t) ((mbr.nlat - mbr.slat) / lat_inc + 1.0e-9) + 1;
+  *cols = (int32_t) ((elon - mbr.wlon) / lon_inc + 1.0e-9) + 1;
+
+
+  out = (int16_t *) malloc ((int64_t) *rows * *cols * sizeof (int16_t));
+  if (out == NULL)
+    {
+      perror ("Allocating DTED area memory");
+      *rows = *cols = 0;
+      return (-1);
+    }
+
+  for (i = 0 ; i < *rows * *cols ; i++) out[i] = DTED_TOPO_UNDEFINED;
+
+
+  pthread_mutex_lock (&dted_mutex);
+
+  if (tile_map != NULL)
+    {
+      for (ilat = (int32_t) floor (mbr.slat) ; ilat <= (int32_t) floor (mbr.slat + (*rows - 1) * lat_inc) ; ilat++)
+        {
+          /*  Rows whose latitude falls in this one degree band.  */
+
+          r_start = MAX (0, (int32_t) ceil ((ilat - mbr.slat) / lat_inc));
+          r_end = MIN (*rows - 1, (int32_t) ceil ((ilat + 1 - mbr.slat) / lat_inc) - 1);
+
+          for (ilon = (int32_t) floor (mbr.wlon) ; ilon <= (int32_t) floor (mbr.wlon + (*cols - 1) * lon_inc) ; ilon++)
+            {
+              if ((cell = dted_cell (ilat, ilon)) < 0 || (t = tile_map[cell] - 1) < 0 || (posts = dted_grid (t)) == NULL) continue;
+
+              c_start = MAX (0, (int32_t) ceil ((ilon - mbr.wlon) / lon_inc));
+              c_end = MIN (*cols - 1, (int32_t) ceil ((ilon + 1 - mbr.wlon) / lon_inc) - 1);
+
+              for (i = r_start ; i <= r_end ; i++)
+                {
+                  for (j = c_start ; j <= c_end ; j++)
+                    {
+                      out[(int64_t) i * *cols + j] = dted_post (t, posts, mbr.slat + i * lat_inc, mbr.wlon + j * lon_inc);
+                      covered++;
+                    }
+                }
+            }
+        }
+    }
+
+  pthread_mutex_unlock (&dted_mutex);
+
+  *grid = out;
+
+  return (covered);
+}
+
+
+
+/***************************************************************************/
+/*!
+
+  - Function:    cleanup_dted_topo
+
+  - Purpose:     Free the DTED index and tile cache.
+
+  - Date:        10/18/26
+
+  - Arguments:   None
+
+  - Returns:     N/A
+
+****************************************************************************/
+
+void cleanup_dted_topo ()
+{
+  int32_t            i;
+
+
+  pthread_mutex_lock (&dted_mutex);
+
+  for (i = 0 ; i < num_tiles ; i++)
+    {
+      dted_release (&tile[i]);
+      free (tile[i].path);
+    }
+
+  free (tile);
+  free (tile_map);
+  tile = NULL;
+  tile_map = NULL;
+  num_tiles = 0;
+  cache_used = 0;
+
+  pthread_mutex_unlock (&dted_mutex);
+}
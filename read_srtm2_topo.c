@@ -301,10 +301,12 @@ int32_t read_srtm2_topo_one_degree (int32_t lat, int32_t lon, int16_t **array)
   FILE                   *block_fp;
   char                   varin[1024], info[1024], header_block[HEADER_SIZE];
   uint8_t                *buf, *bit_box = NULL, head[84];
+  uint32_t               *row;
   int32_t                i, j, shift_lat, shift_lon, resolution, pos, wsize = 0, hsize = 0, status, ndx, block;
   uint32_t               mpos;
   uLong                  csize;
   uLongf                 bsize;
+  BIT_READER             br;
   int64_t                address;
   int16_t                start_val, bias, null_val, num_bits, temp, last_val;
 
@@ -560,10 +562,11 @@ int32_t read_srtm2_topo_one_degree (int32_t lat, int32_t lon, int16_t **array)
 
       /*  Unpack the internal header.  */
 
-      pos = 0;
-      start_val = bit_unpack (bit_box, pos, 16); pos += 16;
-      bias = bit_unpack (bit_box, pos, 16); pos += 16;
-      num_bits = bit_unpack (bit_box, pos, 4); pos += 4;
+      bit_reader_init (&br, bit_box, bsize, 0);
+      start_val = bit_reader_get (&br, 16);
+      bias = bit_reader_get (&br, 16);
+      num_bits = bit_reader_get (&br, 4);
+      pos = bit_reader_position (&br);
       null_val = NINT (pow (2.0L, (double) num_bits)) - 1;
 
 
@@ -579,16 +582,27 @@ int32_t read_srtm2_topo_one_degree (int32_t lat, int32_t lon, int16_t **array)
         }
 
 
-      /*  Uncompress the data (delta coded snake dance).  */
+      /*  Uncompress the data (delta coded snake dance).  Each row is a run of num_bits wide deltas so we
+          unpack a whole row at a time.  */
+
+      row = (uint32_t *) malloc (wsize * sizeof (uint32_t));
+      if (row == NULL)
+        {
+          perror ("Allocating row memory in read_srtm2_topo");
+          exit (-1);
+        }
 
       last_val = start_val;
       for (i = 0 ; i < hsize ; i++)
         {
+          bit_unpack_array (bit_box, pos, num_bits, wsize, row);
+          pos += wsize * num_bits;
+
           if (!(i % 2))
             {
               for (j = 0 ; j < wsize ; j++)
                 {
-                  temp = bit_unpack (bit_box, pos, num_bits); pos += num_bits;
+                  temp = row[j];
 
                   if (temp < null_val)
                     {
@@ -605,7 +619,7 @@ int32_t read_srtm2_topo_one_degree (int32_t lat, int32_t lon, int16_t **array)
             {
               for (j = wsize - 1 ; j >= 0 ; j--)
                 {
-                  temp = bit_unpack (bit_box, pos, num_bits); pos += num_bits;
+                  temp = row[wsize - 1 - j];
 
                   if (temp < null_val)
                     {
@@ -621,6 +635,7 @@ int32_t read_srtm2_topo_one_degree (int32_t lat, int32_t lon, int16_t **array)
         }
 
 
+      free (row);
       free (bit_box);
 
       prev_size = wsize;
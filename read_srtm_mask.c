@@ -258,6 +258,7 @@ int32_t read_srtm_mask_one_degree (int32_t lat, int32_t lon, uint8_t **array, in
   int32_t                i, j, address, shift_lat, shift_lon, resolution, pos, wsize = 0, hsize = 0, status;
   uLong                  csize;
   uLongf                 bsize;
+  BIT_READER             br;
 
 
   /*  First time through, open the file and read the header.    */
@@ -472,13 +473,12 @@ int32_t read_srtm_mask_one_degree (int32_t lat, int32_t lon, uint8_t **array, in
 
       /*  Unpack the cell.  */
 
-      pos = 0;
+      bit_reader_init (&br, bit_box, bsize, 0);
       for (i = 0 ; i < hsize ; i++)
         {
           for (j = 0 ; j < wsize ; j++)
             {
-              box[i * wsize + j] = (uint8_t) bit_unpack (bit_box, pos, 1);
-              pos++;
+              box[i * wsize + j] = (uint8_t) bit_reader_get (&br, 1);
             }
         }
 
@@ -386,9 +386,10 @@ int32_t read_swbd_mask_one_degree (int32_t latdeg, int32_t londeg, uint8_t **arr
   static FILE            *fp;
   char                   dir[512], file[512], version[128], created[128], zversion[128], varin[1024], info[1024];
   uint8_t                add[7], *buf, *bit_box = NULL;
-  int32_t                i, j, address, shift_latdeg, shift_londeg, pos, dim = 0, status;
+  int32_t                i, j, address, shift_latdeg, shift_londeg, dim = 0, status;
   uLong                  csize;
   uLongf                 bsize;
+  BIT_READER             br;
 
 
   /*  If the caller changed resolutions we want to close the old file and open a new one.  */
@@ -541,8 +542,6 @@ int32_t read_swbd_mask_one_degree (int32_t latdeg, int32_t londeg, uint8_t **arr
 
       fseek (fp, address, SEEK_SET);
 
-      pos = 0;
-
 
       /*  We have to set an approximate size for unpacking (see the ZLIB documentation).  */
 
@@ -592,13 +591,12 @@ int32_t read_swbd_mask_one_degree (int32_t latdeg, int32_t londeg, uint8_t **arr
       
       /*  Unpack the cell.  */
 
-      pos = 0;
+      bit_reader_init (&br, bit_box, bsize, 0);
       for (i = 0 ; i < dim ; i++)
         {
           for (j = 0 ; j < dim ; j++)
             {
-              array[i][j] = (uint8_t) bit_unpack (bit_box, pos, 1);
-              pos++;
+              array[i][j] = (uint8_t) bit_reader_get (&br, 1);
             }
         }
 
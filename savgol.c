@@ -35,9 +35,40 @@
 *****************************************  IMPORTANT NOTE  **********************************/
 
 
+#include <string.h>
+#include <pthread.h>
+
+#include "nvdef.h"
 #include "savgol.h"
 
 
+/*  Runtime selected AVX2/FMA kernel for savgol_apply.  This is only built with GCC compatible compilers on x86
+    since it relies on the target attribute and __builtin_cpu_supports.  */
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+  #define SAVGOL_SIMD
+  #include <immintrin.h>
+#endif
+
+
+/*  Coefficient cache.  Every (nl, nr, ld, m) combination that we've been asked for is kept (there usually
+    aren't many of them) so the pointers returned by savgol_coefficients stay good until clear_savgol_cache.  */
+
+#define SAVGOL_CACHE_BUCKETS    256
+
+
+typedef struct SAVGOL_CACHE
+{
+  int32_t       nl, nr, ld, m;
+  float         *coef;
+  struct SAVGOL_CACHE *next;
+} SAVGOL_CACHE;
+
+
+static SAVGOL_CACHE *savgol_cache[SAVGOL_CACHE_BUCKETS];
+static pthread_mutex_t savgol_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+
 /*  Note: index 0 not used here.  */
 
 typedef float MAT[SAVGOL_MMAX+2][SAVGOL_MMAX+2];
@@ -184,44 +215,17 @@ static void lubksb(MAT a, int32_t n, int32_t np __attribute__ ((unused)), int32_
 }
 
 
-/***************************************************************************/
-/*!
-
-   - Module :        savgol
-
-   - Programmer :    Jan Depner, based on code by J-P Moreau
-
-   - Date :          08/17/12
-
-   - Purpose :       Returns in c(np), in wrap-around order (see reference)
-                     consistent with the argument respns in routine convlv, a
-                     set of Savitzky-Golay filter coefficients. nl is the number
-                     of leftward (past) data points used, while nr is the number
-                     of rightward (future) data points, making the total number
-                     of data points used nl + nr + 1. ld is the order of the
-                     derivative desired (e.g., ld = 0 for smoothed function).
-                     m is the order of the smoothing polynomial, also equal to
-                     the highest conserved moment; usual values are m = 2 or m = 4. 
-
-   - Reference:      Numerical Recipes By W.H. Press, B. P. Flannery, S.A. Teukolsky
-                     and W.T. Vetterling, Cambridge University Press, 1986 - 1992
-
-****************************************************************************/
+/*  Compute the Savitzky-Golay coefficients for data points -nl through nr (coef[0] through coef[nl + nr]).  This
+    is the original savgol computation (see savgol) without the wrap-around storage.  */
 
-int32_t savgol (float *c, int32_t np, int32_t nl, int32_t nr, int32_t ld, int32_t m)
+static void savgol_compute (float *coef, int32_t nl, int32_t nr, int32_t ld, int32_t m)
 {
-  int32_t d, icode, imj, ipj, i, j, k, kk, mm;
+  int32_t d, icode, imj, ipj, i, j, k, mm;
   int32_t indx[SAVGOL_MMAX+2];
   float fac, sum;
   MAT a;
   float b[SAVGOL_MMAX+2];
 
-  if (np < nl + nr + 1 || nl < 0 || nr < 0 || ld > m || m > SAVGOL_MMAX || nl + nr < m)
-    {
-      fprintf (stderr, "\n Bad args in savgol.\n");
-      return (-1);
-    }
-
   for (i = 1 ; i <= SAVGOL_MMAX + 1 ; i++)
     {
       for (j = 1 ; j <= SAVGOL_MMAX + 1 ; j++) a[i][j] = 0.0;
@@ -256,11 +260,6 @@ int32_t savgol (float *c, int32_t np, int32_t nl, int32_t nr, int32_t ld, int32_
   b[ld + 1] = 1.0;    /*  Right-hand side vector is unit vector, depending on which derivative we want.  */
 
   lubksb (a, m + 1, SAVGOL_MMAX + 1, indx, b);      /*  Backsubstitute, giving one row of the inverse matrix.  */
-  
-
-  /*  Zero the output array (it may be bigger than the number of coefficients.  */
-
-  for (kk = 1 ; kk <= np ; kk++) c[kk] = 0.0;
 
 
   /*  Each Savitzky-Golay coefficient is the dot product of powers of an integer with the inverse matrix row.  */
@@ -275,11 +274,451 @@ int32_t savgol (float *c, int32_t np, int32_t nl, int32_t nr, int32_t ld, int32_
           sum += b[mm + 1] * fac;
         } 
 
-      /*  Store in wrap-around order  */
+      coef[k + nl] = sum;
+    }
+}
+
+
+
+/***************************************************************************/
+/*!
+
+   - Module :        savgol_coefficients
 
+   - Date :          10/18/26
+
+   - Purpose :       Returns the Savitzky-Golay coefficients for data
+                     points -nl through nr in natural order (i.e.
+                     smoothed[i] is the sum of coef[k + nl] * data[i + k]
+                     for k = -nl through nr).  See savgol for the meaning
+                     of the arguments.  The coefficients are computed the
+                     first time a given (nl, nr, ld, m) is asked for and
+                     cached after that so this is cheap enough to call
+                     for every point.  The returned array belongs to the
+                     cache and is good until clear_savgol_cache is
+                     called.
+
+   - Return :        Coefficients or NULL on bad arguments or memory
+                     allocation error
+
+****************************************************************************/
+
+const float *savgol_coefficients (int32_t nl, int32_t nr, int32_t ld, int32_t m)
+{
+  SAVGOL_CACHE *entry;
+  uint32_t bucket;
+
+  if (nl < 0 || nr < 0 || ld < 0 || m < 0 || ld > m || m > SAVGOL_MMAX || nl + nr < m)
+    {
+      fprintf (stderr, "\n Bad args in savgol.\n");
+      return (NULL);
+    }
+
+  bucket = ((uint32_t) nl * 73856093u ^ (uint32_t) nr * 19349663u ^ (uint32_t) ld * 83492791u ^ (uint32_t) m * 2654435761u) % SAVGOL_CACHE_BUCKETS;
+
+  pthread_mutex_lock (&savgol_mutex);
+
+  for (entry = savgol_cache[bucket] ; entry != NULL ; entry = entry->next)
+    {
+      if (entry->nl == nl && entry->nr == nr && entry->ld == ld && entry->m == m)
+        {
+          pthread_mutex_unlock (&savgol_mutex);
+          return (entry->coef);
+        }
+    }
+
+  if ((entry = (SAVGOL_CACHE *) malloc (sizeof (SAVGOL_CACHE))) == NULL ||
+      (entry->coef = (float *) malloc ((nl + nr + 1) * sizeof (float))) == NULL)
+    {
+      perror ("Allocating savgol coefficient cache");
+      free (entry);
+      pthread_mutex_unlock (&savgol_mutex);
+      return (NULL);
+    }
+
+  entry->nl = nl;
+  entry->nr = nr;
+  entry->ld = ld;
+  entry->m = m;
+
+  savgol_compute (entry->coef, nl, nr, ld, m);
+
+  entry->next = savgol_cache[bucket];
+  savgol_cache[bucket] = entry;
+
+  pthread_mutex_unlock (&savgol_mutex);
+
+  return (entry->coef);
+}
+
+
+
+/*!  Free all of the cached savgol coefficients.  Any pointers returned by savgol_coefficients (and any
+     SAVGOL_STATE) are no good after this.  */
+
+void clear_savgol_cache ()
+{
+  SAVGOL_CACHE *entry, *next;
+  int32_t i;
+
+  pthread_mutex_lock (&savgol_mutex);
+
+  for (i = 0 ; i < SAVGOL_CACHE_BUCKETS ; i++)
+    {
+      for (entry = savgol_cache[i] ; entry != NULL ; entry = next)
+        {
+          next = entry->next;
+          free (entry->coef);
+          free (entry);
+        }
+
+      savgol_cache[i] = NULL;
+    }
+
+  pthread_mutex_unlock (&savgol_mutex);
+}
+
+
+
+/***************************************************************************/
+/*!
+
+   - Module :        savgol
+
+   - Programmer :    Jan Depner, based on code by J-P Moreau
+
+   - Date :          08/17/12
+
+   - Purpose :       Returns in c(np), in wrap-around order (see reference)
+                     consistent with the argument respns in routine convlv, a
+                     set of Savitzky-Golay filter coefficients. nl is the number
+                     of leftward (past) data points used, while nr is the number
+                     of rightward (future) data points, making the total number
+                     of data points used nl + nr + 1. ld is the order of the
+                     derivative desired (e.g., ld = 0 for smoothed function).
+                     m is the order of the smoothing polynomial, also equal to
+                     the highest conserved moment; usual values are m = 2 or m = 4. 
+                     The coefficients come from the savgol_coefficients cache.
+
+   - Reference:      Numerical Recipes By W.H. Press, B. P. Flannery, S.A. Teukolsky
+                     and W.T. Vetterling, Cambridge University Press, 1986 - 1992
+
+****************************************************************************/
+
+int32_t savgol (float *c, int32_t np, int32_t nl, int32_t nr, int32_t ld, int32_t m)
+{
+  int32_t k, kk;
+  const float *coef;
+
+  if (np < nl + nr + 1 || nl < 0 || nr < 0 || ld > m || m > SAVGOL_MMAX || nl + nr < m)
+    {
+      fprintf (stderr, "\n Bad args in savgol.\n");
+      return (-1);
+    }
+
+  if ((coef = savgol_coefficients (nl, nr, ld, m)) == NULL) return (-1);
+
+
+  /*  Zero the output array (it may be bigger than the number of coefficients.  */
+
+  for (kk = 1 ; kk <= np ; kk++) c[kk] = 0.0;
+
+
+  /*  Store in wrap-around order  */
+
+  for (k = -nl ; k <= nr ; k++)
+    {
       kk = ((np - k) % np) + 1;
-      c[kk] = sum;
+      c[kk] = coef[k + nl];
     }
 
   return (0);
 }
+
+
+
+/*  Smoothed (or derivative) value for sample o of a series of total samples using the samples in x (x[0] is
+    sample number base).  Near the ends of the series the window shrinks to what we have (dropping the order of
+    the polynomial if we have to).  */
+
+static float savgol_edge (SAVGOL_STATE *state, const float *x, int64_t base, int64_t o, int64_t total)
+{
+  int32_t nl, nr, m, k;
+  const float *coef;
+  float sum;
+
+  nl = (int32_t) MIN ((int64_t) state->nl, o);
+  nr = (int32_t) MIN ((int64_t) state->nr, total - 1 - o);
+  m = MIN (state->m, nl + nr);
+
+  if (state->ld > m || (coef = savgol_coefficients (nl, nr, state->ld, m)) == NULL) return (0.0);
+
+  sum = 0.0;
+  for (k = -nl ; k <= nr ; k++) sum += coef[k + nl] * x[o + k - base];
+
+  return (sum);
+}
+
+
+
+/*  Full window outputs start through end - 1 (x[j] is the first sample for output j).  */
+
+static void savgol_interior (SAVGOL_STATE *state, const float *x, float *out, int32_t start, int32_t end)
+{
+  int32_t j, k, np = state->nl + state->nr + 1;
+  float sum;
+
+  for (j = start ; j < end ; j++)
+    {
+      sum = 0.0;
+      for (k = 0 ; k < np ; k++) sum += state->coef[k] * x[j + k];
+      out[j] = sum;
+    }
+}
+
+
+
+#ifdef SAVGOL_SIMD
+
+/*  savgol_interior 32 (then 8) outputs at a time.  Returns the index of the first output that wasn't done.  */
+
+__attribute__ ((target ("avx2,fma")))
+static int32_t savgol_interior_avx2 (SAVGOL_STATE *state, const float *x, float *out, int32_t start, int32_t end)
+{
+  int32_t j, k, np = state->nl + state->nr + 1;
+  __m256 f, acc0, acc1, acc2, acc3;
+
+  for (j = start ; j + 32 <= end ; j += 32)
+    {
+      acc0 = acc1 = acc2 = acc3 = _mm256_setzero_ps ();
+
+      for (k = 0 ; k < np ; k++)
+        {
+          f = _mm256_broadcast_ss (&state->coef[k]);
+          acc0 = _mm256_fmadd_ps (f, _mm256_loadu_ps (&x[j + k]), acc0);
+          acc1 = _mm256_fmadd_ps (f, _mm256_loadu_ps (&x[j + k + 8]), acc1);
+          acc2 = _mm256_fmadd_ps (f, _mm256_loadu_ps (&x[j + k + 16]), acc2);
+          acc3 = _mm256_fmadd_ps (f, _mm256_loadu_ps (&x[j + k + 24]), acc3);
+        }
+
+      _mm256_storeu_ps (&out[j], acc0);
+      _mm256_storeu_ps (&out[j + 8], acc1);
+      _mm256_storeu_ps (&out[j + 16], acc2);
+      _mm256_storeu_ps (&out[j + 24], acc3);
+    }
+
+  for ( ; j + 8 <= end ; j += 8)
+    {
+      acc0 = _mm256_setzero_ps ();
+
+      for (k = 0 ; k < np ; k++) acc0 = _mm256_fmadd_ps (_mm256_broadcast_ss (&state->coef[k]), _mm256_loadu_ps (&x[j + k]), acc0);
+
+      _mm256_storeu_ps (&out[j], acc0);
+    }
+
+  return (j);
+}
+
+#endif
+
+
+
+/***************************************************************************/
+/*!
+
+   - Module :        create_savgol_state
+
+   - Date :          10/18/26
+
+   - Purpose :       Sets up a streaming Savitzky-Golay filter for
+                     savgol_apply and savgol_flush.  See savgol for the
+                     meaning of the arguments.
+
+   - Return :        State (free with free_savgol_state) or NULL on bad
+                     arguments or memory allocation error
+
+****************************************************************************/
+
+SAVGOL_STATE *create_savgol_state (int32_t nl, int32_t nr, int32_t ld, int32_t m)
+{
+  SAVGOL_STATE *state;
+  const float *coef;
+
+  if ((coef = savgol_coefficients (nl, nr, ld, m)) == NULL) return (NULL);
+
+  if ((state = (SAVGOL_STATE *) calloc (1, sizeof (SAVGOL_STATE))) == NULL)
+    {
+      perror ("Allocating SAVGOL_STATE in create_savgol_state");
+      return (NULL);
+    }
+
+  state->nl = nl;
+  state->nr = nr;
+  state->ld = ld;
+  state->m = m;
+  state->coef = coef;
+
+  return (state);
+}
+
+
+
+/***************************************************************************/
+/*!
+
+   - Module :        savgol_apply
+
+   - Date :          10/18/26
+
+   - Purpose :       Feeds the next n samples of a series to a streaming
+                     Savitzky-Golay filter and returns the filtered values
+                     that are ready.  An output needs nr samples after it
+                     so the outputs lag the inputs by nr samples (the last
+                     nr come from savgol_flush).  The first nl outputs use
+                     shrinking windows (nl, nl - 1, ... leftward points).
+                     The full window outputs are done with AVX2/FMA if the
+                     CPU supports it.
+
+   - Arguments :
+                     - state       =   from create_savgol_state
+                     - in          =   next n samples
+                     - out         =   returned filtered values (room for
+                                       n values)
+                     - n           =   number of samples
+
+   - Return :        Number of values put in out or -1 on memory allocation
+                     error
+
+****************************************************************************/
+
+int32_t savgol_apply (SAVGOL_STATE *state, const float *in, float *out, int32_t n)
+{
+  int64_t base, o, avail, keep;
+  int32_t size, start, end, count = 0;
+  float *buffer, *x;
+
+  if (n <= 0) return (0);
+
+
+  /*  Add the new samples to the ones we're holding on to.  */
+
+  if (state->count + n > state->size)
+    {
+      size = MAX (state->count + n, 2 * state->size);
+      if ((buffer = (float *) realloc (state->buffer, size * sizeof (float))) == NULL)
+        {
+          perror ("Allocating buffer in savgol_apply");
+          return (-1);
+        }
+
+      state->buffer = buffer;
+      state->size = size;
+    }
+
+  memcpy (&state->buffer[state->count], in, n * sizeof (float));
+  state->count += n;
+  state->total += n;
+
+  base = state->total - state->count;
+
+
+  /*  Outputs that have all nr of their rightward points.  */
+
+  avail = state->total - state->nr;
+
+
+  /*  Left edge (shrinking windows).  */
+
+  for (o = state->emitted ; o < MIN (avail, (int64_t) state->nl) ; o++) out[count++] = savgol_edge (state, state->buffer, base, o, state->total);
+
+
+  /*  Full windows.  Output o uses buffer[o - nl - base] through buffer[o + nr - base].  */
+
+  if (o < avail)
+    {
+      start = 0;
+      end = (int32_t) (avail - o);
+      x = &state->buffer[o - base - state->nl];
+
+#ifdef SAVGOL_SIMD
+      if (__builtin_cpu_supports ("avx2") && __builtin_cpu_supports ("fma"))
+        start = savgol_interior_avx2 (state, x, &out[count], start, end);
+#endif
+
+      savgol_interior (state, x, &out[count], start, end);
+
+      count += end;
+      o = avail;
+    }
+
+  state->emitted = o;
+
+
+  /*  Drop the samples that no output needs anymore (we need nl before the next output).  */
+
+  keep = MAX (state->emitted - state->nl, base);
+  if (keep > base)
+    {
+      state->count -= (int32_t) (keep - base);
+      memmove (state->buffer, &state->buffer[keep - base], state->count * sizeof (float));
+    }
+
+  return (count);
+}
+
+
+
+/***************************************************************************/
+/*!
+
+   - Module :        savgol_flush
+
+   - Date :          10/18/26
+
+   - Purpose :       Returns the last (up to nr) filtered values of the
+                     series fed to savgol_apply, using shrinking windows,
+                     and resets the state for a new series.
+
+   - Arguments :
+                     - state       =   from create_savgol_state
+                     - out         =   returned filtered values (room for
+                                       nr values)
+
+   - Return :        Number of values put in out
+
+****************************************************************************/
+
+int32_t savgol_flush (SAVGOL_STATE *state, float *out)
+{
+  int64_t base = state->total - state->count, o;
+  int32_t count = 0;
+
+  for (o = state->emitted ; o < state->total ; o++) out[count++] = savgol_edge (state, state->buffer, base, o, state->total);
+
+  reset_savgol_state (state);
+
+  return (count);
+}
+
+
+
+/*!  Start a new series (anything not flushed is thrown away).  */
+
+void reset_savgol_state (SAVGOL_STATE *state)
+{
+  state->count = 0;
+  state->total = 0;
+  state->emitted = 0;
+}
+
+
+
+/*!  Free a SAVGOL_STATE from create_savgol_state.  */
+
+void free_savgol_state (SAVGOL_STATE *state)
+{
+  if (state == NULL) return;
+
+  free (state->buffer);
+  free (state);
+}
@@ -46,13 +46,38 @@ extern "C" {
 
 #include <math.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include "pfm_nvtypes.h"
 
 
 #define  SAVGOL_MMAX     6    /*  Maximum order of smoothing polynomial  */
 
 
+  /*!  Streaming Savitzky-Golay smoother/differentiator (see create_savgol_state).  */
+
+  typedef struct
+  {
+    int32_t       nl;                      /*!<  Number of leftward (past) points  */
+    int32_t       nr;                      /*!<  Number of rightward (future) points  */
+    int32_t       ld;                      /*!<  Order of the derivative  */
+    int32_t       m;                       /*!<  Order of the smoothing polynomial  */
+    const float   *coef;                   /*!<  Coefficients for the full window (from savgol_coefficients)  */
+    float         *buffer;                 /*!<  Samples we still need (starting with sample number total - count)  */
+    int32_t       size;                    /*!<  Size of buffer  */
+    int32_t       count;                   /*!<  Number of samples in buffer  */
+    int64_t       total;                   /*!<  Number of samples received  */
+    int64_t       emitted;                 /*!<  Number of samples output  */
+  } SAVGOL_STATE;
+
+
   int32_t savgol(float *c, int32_t np, int32_t nl, int32_t nr, int32_t ld, int32_t m);
+  const float *savgol_coefficients (int32_t nl, int32_t nr, int32_t ld, int32_t m);
+  void clear_savgol_cache ();
+  SAVGOL_STATE *create_savgol_state (int32_t nl, int32_t nr, int32_t ld, int32_t m);
+  int32_t savgol_apply (SAVGOL_STATE *state, const float *in, float *out, int32_t n);
+  int32_t savgol_flush (SAVGOL_STATE *state, float *out);
+  void reset_savgol_state (SAVGOL_STATE *state);
+  void free_savgol_state (SAVGOL_STATE *state);
 
 
 #ifdef  __cplusplus
@@ -38,6 +38,15 @@
 
 #include "swap_bytes.h"
 
+
+/*  Runtime selected AVX2 and SSSE3 kernels for the array swaps.  These are only built with GCC compatible
+    compilers on x86 since they rely on the target attribute and __builtin_cpu_supports.  */
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+  #define SWAP_BYTES_SIMD
+  #include <immintrin.h>
+#endif
+
 /***************************************************************************/
 /*!
 
@@ -184,3 +193,203 @@ void swap_short (int16_t *word)
 
     return;
 }
+
+
+
+/*  Byte shuffles that reverse each 2, 4, or 8 byte element in a 16 byte lane.  */
+
+static const int8_t swap_shuffle[3][16] =
+  {{1, 0, 3, 2, 5, 4, 7, 6, 9, 8, 11, 10, 13, 12, 15, 14},
+   {3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12},
+   {7, 6, 5, 4, 3, 2, 1, 0, 15, 14, 13, 12, 11, 10, 9, 8}};
+
+
+#ifdef SWAP_BYTES_SIMD
+
+__attribute__ ((target ("avx2")))
+static int64_t swap_array_avx2 (uint8_t *bytes, int64_t size, int32_t type)
+{
+    int64_t             i;
+    __m128i             lane;
+    __m256i             shuf, v;
+
+
+    lane = _mm_loadu_si128 ((const __m128i *) swap_shuffle[type]);
+    shuf = _mm256_inserti128_si256 (_mm256_castsi128_si256 (lane), lane, 1);
+
+    for (i = 0 ; i + 32 <= size ; i += 32)
+    {
+        v = _mm256_loadu_si256 ((const __m256i *) (bytes + i));
+        _mm256_storeu_si256 ((__m256i *) (bytes + i), _mm256_shuffle_epi8 (v, shuf));
+    }
+
+    return (i);
+}
+
+
+
+__attribute__ ((target ("ssse3")))
+static int64_t swap_array_ssse3 (uint8_t *bytes, int64_t size, int32_t type)
+{
+    int64_t             i;
+    __m128i             shuf, v;
+
+
+    shuf = _mm_loadu_si128 ((const __m128i *) swap_shuffle[type]);
+
+    for (i = 0 ; i + 16 <= size ; i += 16)
+    {
+        v = _mm_loadu_si128 ((const __m128i *) (bytes + i));
+        _mm_storeu_si128 ((__m128i *) (bytes + i), _mm_shuffle_epi8 (v, shuf));
+    }
+
+    return (i);
+}
+
+#endif
+
+
+
+/*  Swaps "count" elements of 2 (type 0), 4 (type 1), or 8 (type 2) bytes in place.  The vector kernels handle
+    whole 16 or 32 byte chunks and the remainder is swapped one element at a time.  */
+
+static void swap_array (void *array, int64_t count, int32_t type)
+{
+    uint8_t             *bytes = (uint8_t *) array;
+    int64_t             i = 0, size;
+    int32_t             width;
+    uint16_t            w16;
+    uint32_t            w32;
+    uint64_t            w64;
+
+
+    width = 2 << type;
+    size = count * width;
+
+#ifdef SWAP_BYTES_SIMD
+    if (__builtin_cpu_supports ("avx2"))
+    {
+        i = swap_array_avx2 (bytes, size, type);
+    }
+    else if (__builtin_cpu_supports ("ssse3"))
+    {
+        i = swap_array_ssse3 (bytes, size, type);
+    }
+#endif
+
+    for ( ; i < size ; i += width)
+    {
+        switch (type)
+        {
+        case 0:
+            memcpy (&w16, bytes + i, 2);
+            w16 = (uint16_t) ((w16 << 8) | (w16 >> 8));
+            memcpy (bytes + i, &w16, 2);
+            break;
+
+        case 1:
+            memcpy (&w32, bytes + i, 4);
+            w32 = (w32 << 24) | ((w32 & 0x0000ff00) << 8) | ((w32 & 0x00ff0000) >> 8) | (w32 >> 24);
+            memcpy (bytes + i, &w32, 4);
+            break;
+
+        case 2:
+            memcpy (&w64, bytes + i, 8);
+            w64 = ((w64 & 0x00000000ffffffffULL) << 32) | (w64 >> 32);
+            w64 = ((w64 & 0x0000ffff0000ffffULL) << 16) | ((w64 >> 16) & 0x0000ffff0000ffffULL);
+            w64 = ((w64 & 0x00ff00ff00ff00ffULL) << 8) | ((w64 >> 8) & 0x00ff00ff00ff00ffULL);
+            memcpy (bytes + i, &w64, 8);
+            break;
+        }
+    }
+}
+
+
+
+/***************************************************************************/
+/*!
+
+  - Module Name:        swap_int32_array
+
+  - Date Written:       October 2026
+
+  - Purpose:            This function swaps bytes in an array of four byte
+                        ints.  On x86 processors with AVX2 or SSSE3 (checked
+                        at run time) the bytes are swapped 32 or 16 bytes at
+                        a time.
+
+  - Arguments:          words               -   pointer to the array
+                        count               -   number of elements
+
+****************************************************************************/
+
+void swap_int32_array (int32_t *words, int64_t count)
+{
+    swap_array (words, count, 1);
+}
+
+
+
+/***************************************************************************/
+/*!
+
+  - Module Name:        swap_float_array
+
+  - Date Written:       October 2026
+
+  - Purpose:            This function swaps bytes in an array of four byte
+                        floats.  See swap_int32_array.
+
+  - Arguments:          words               -   pointer to the array
+                        count               -   number of elements
+
+****************************************************************************/
+
+void swap_float_array (float *words, int64_t count)
+{
+    swap_array (words, count, 1);
+}
+
+
+
+/***************************************************************************/
+/*!
+
+  - Module Name:        swap_double_array
+
+  - Date Written:       October 2026
+
+  - Purpose:            This function swaps bytes in an array of eight byte
+                        doubles.  See swap_int32_array.
+
+  - Arguments:          words               -   pointer to the array
+                        count               -   number of elements
+
+****************************************************************************/
+
+void swap_double_array (double *words, int64_t count)
+{
+    swap_array (words, count, 2);
+}
+
+
+
+/***************************************************************************/
+/*!
+
+  - Module Name:        swap_int16_array
+
+  - Date Written:       October 2026
+
+  - Purpose:            This function swaps bytes in an array of two byte
+                        ints.  See swap_int32_array.
+
+  - Arguments:          words               -   pointer to the array
+                        count               -   number of elements
+
+****************************************************************************/
+
+void swap_int16_array (int16_t *words, int64_t count)
+{
+    swap_array (words, count, 0);
+}
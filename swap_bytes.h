@@ -55,6 +55,10 @@ extern "C" {
   void swap_float (float *word);
   void swap_double (double *word);
   void swap_short (int16_t *word);
+  void swap_int32_array (int32_t *words, int64_t count);
+  void swap_float_array (float *words, int64_t count);
+  void swap_double_array (double *words, int64_t count);
+  void swap_int16_array (int16_t *words, int64_t count);
 
 
 #ifdef  __cplusplus
@@ -0,0 +1,143 @@
+
+/*********************************************************************************************
+
+    This is public domain software that was developed by or for the U.S. Naval Oceanographic
+    Office and/or the U.S. Army Corps of Engineers.
+
+    This is a work of the U.S. Government. In accordance with 17 USC 105, copyright protection
+    is not available for any work of the U.S. Government.
+
+    Neither the United States Government, nor any employees of the United States Government,
+    nor the author, makes any warranty, express or implied, without even the implied warranty
+    of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE, or assumes any liability or
+    responsibility for the accuracy, completeness, or usefulness of any information,
+    apparatus, product, or process disclosed, or represents that its use would not infringe
+    privately-owned rights. Reference herein to any specific commercial products, process,
+    or service by trade name, trademark, manufacturer, or otherwise, does not necessarily
+    constitute or imply its endorsement, recommendation, or favoring by the United States
+    Government. The views and opinions of authors expressed herein do not necessarily state
+    or reflect those of the United States Government, and shall not be used for advertising
+    or product endorsement purposes.
+*********************************************************************************************/
+
+
+/*  Checks that the get_area_mbr.c area file cache notices an area file that is rewritten with the same size in
+    the same second (so the size and modification time don't change).  Build and run from the utility directory
+    with:
+
+        gcc -DNVLinux -I$PFM_INCLUDE -I. tests/test_area_cache.c get_area_mbr.c \
+            -L$PFM_LIB -lshp -lpthread -lm -o test_area_cache && ./test_area_cache
+
+    Prints any failures and exits with a non-zero status if there were any.  */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <utime.h>
+
+#include "get_area_mbr.h"
+
+
+static int32_t failures = 0;
+
+
+static void write_area (const char *path, double x0)
+{
+  FILE                *fp;
+
+
+  if ((fp = fopen (path, "w")) == NULL)
+    {
+      perror (path);
+      exit (-1);
+    }
+
+  fprintf (fp, "%.1f, 2.0\n3.0, 2.0\n3.0, 4.0\n", x0);
+  fclose (fp);
+}
+
+
+
+static void check_x0 (const char *path, double x0, const char *what)
+{
+  double              *x = NULL, *y = NULL;
+  int32_t             count;
+  NV_F64_XYMBR        mbr;
+
+
+  if (!get_area_polygon (path, &count, &x, &y, &mbr))
+    {
+      fprintf (stderr, "FAILED: %s (couldn't read %s)\n", what, path);
+      failures++;
+      return;
+    }
+
+  if (count != 3 || x[0] != x0)
+    {
+      fprintf (stderr, "FAILED: %s (got %d points, x0 %f, expected x0 %f)\n", what, count, count ? x[0] : 0.0, x0);
+      failures++;
+    }
+
+  free (x);
+  free (y);
+}
+
+
+
+int32_t main (int32_t argc __attribute__ ((unused)), char **argv __attribute__ ((unused)))
+{
+  char                path[64];
+  struct utimbuf      times;
+  time_t              start;
+  int32_t             i;
+
+
+  sprintf (path, "/tmp/test_area_cache_%d.afs", (int32_t) getpid ());
+
+
+  /*  Rewrite the file with the same size right after reading it.  Retry if we happen to cross a second
+      boundary so that we really test the same second case.  */
+
+  for (i = 0 ; i < 5 ; i++)
+    {
+      clear_area_cache ();
+
+      start = time (NULL);
+
+      write_area (path, 1.0);
+      check_x0 (path, 1.0, "first read");
+      write_area (path, 7.0);
+      check_x0 (path, 7.0, "rewritten in the same second");
+
+      if (time (NULL) == start) break;
+    }
+
+
+  /*  Older files are cached but a rewrite with the same size still changes the modification time.  */
+
+  write_area (path, 1.0);
+  times.actime = times.modtime = time (NULL) - 100;
+  utime (path, &times);
+  check_x0 (path, 1.0, "old file");
+  check_x0 (path, 1.0, "old file from the cache");
+
+  write_area (path, 7.0);
+  times.actime = times.modtime = time (NULL) - 50;
+  utime (path, &times);
+  check_x0 (path, 7.0, "old file rewritten");
+
+  clear_area_cache ();
+  unlink (path);
+
+  if (failures)
+    {
+      fprintf (stderr, "%d failures\n", failures);
+      return (-1);
+    }
+
+  printf ("test_area_cache passed\n");
+
+  return (0);
+}
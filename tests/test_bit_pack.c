@@ -0,0 +1,152 @@
+
+/*********************************************************************************************
+
+    This is public domain software that was developed by or for the U.S. Naval Oceanographic
+    Office and/or the U.S. Army Corps of Engineers.
+
+    This is a work of the U.S. Government. In accordance with 17 USC 105, copyright protection
+    is not available for any work of the U.S. Government.
+
+    Neither the United States Government, nor any employees of the United States Government,
+    nor the author, makes any warranty, express or implied, without even the implied warranty
+    of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE, or assumes any liability or
+    responsibility for the accuracy, completeness, or usefulness of any information,
+    apparatus, product, or process disclosed, or represents that its use would not infringe
+    privately-owned rights. Reference herein to any specific commercial products, process,
+    or service by trade name, trademark, manufacturer, or otherwise, does not necessarily
+    constitute or imply its endorsement, recommendation, or favoring by the United States
+    Government. The views and opinions of authors expressed herein do not necessarily state
+    or reflect those of the United States Government, and shall not be used for advertising
+    or product endorsement purposes.
+*********************************************************************************************/
+
+
+/*  Checks the bit_pack array and bit-stream functions against bit_pack/bit_unpack, including zero bit fields
+    (the SRTM readers get the field width from the file so 0 is valid input).  Build and run from the utility
+    directory with:
+
+        gcc -DNVLinux -I$PFM_INCLUDE -I. tests/test_bit_pack.c bit_pack.c -o test_bit_pack && ./test_bit_pack
+
+    Prints any failures and exits with a non-zero status if there were any.  */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "bit_pack.h"
+
+
+#define BUF_SIZE 4096
+
+
+static int32_t failures = 0;
+
+
+static void check (int32_t ok, const char *what, uint32_t numbits, uint32_t start)
+{
+  if (!ok)
+    {
+      fprintf (stderr, "FAILED: %s (numbits %u, start %u)\n", what, numbits, start);
+      failures++;
+    }
+}
+
+
+
+/*  Zero bit fields read as zero and writing them doesn't touch the buffer.  */
+
+static void test_zero_bits ()
+{
+  uint8_t             buffer[BUF_SIZE], copy[BUF_SIZE];
+  uint32_t            out[64], values[64], start;
+  int32_t             i, ok;
+  BIT_READER          br;
+  BIT_WRITER          bw;
+
+
+  for (i = 0 ; i < BUF_SIZE ; i++) buffer[i] = (uint8_t) (rand () & 0xff);
+  for (i = 0 ; i < 64 ; i++) values[i] = (uint32_t) rand ();
+  memcpy (copy, buffer, BUF_SIZE);
+
+  for (start = 0 ; start < 24 ; start += 5)
+    {
+      memset (out, 0xff, sizeof (out));
+      bit_unpack_array (buffer, start, 0, 16, out);
+      for (i = 0, ok = NVTrue ; i < 16 ; i++) if (out[i] || bit_unpack (buffer, start, 0)) ok = NVFalse;
+      check (ok && out[16] == 0xffffffff, "bit_unpack_array with zero bit fields", 0, start);
+
+      bit_reader_init (&br, buffer, BUF_SIZE, start);
+      check (bit_reader_get (&br, 0) == 0, "bit_reader_get with zero bits", 0, start);
+      check (bit_reader_get (&br, 8) == bit_unpack (buffer, start, 8), "bit_reader_get after a zero bit field", 8, start);
+
+      memset (out, 0xff, sizeof (out));
+      bit_reader_get_array (&br, 0, 16, out);
+      for (i = 0, ok = NVTrue ; i < 16 ; i++) if (out[i]) ok = NVFalse;
+      check (ok, "bit_reader_get_array with zero bit fields", 0, start);
+
+      bit_pack_array (buffer, start, 0, 16, values);
+      check (!memcmp (buffer, copy, BUF_SIZE), "bit_pack_array with zero bit fields", 0, start);
+
+      bit_writer_init (&bw, buffer, BUF_SIZE, start);
+      bit_writer_put (&bw, 0, -1);
+      bit_writer_put (&bw, 8, copy[0]);
+      bit_writer_flush (&bw);
+      check (bit_unpack (buffer, start, 8) == copy[0], "bit_writer_put after a zero bit field", 8, start);
+
+      memcpy (buffer, copy, BUF_SIZE);
+    }
+}
+
+
+
+/*  The array functions give the same results as count calls to bit_pack/bit_unpack for every width.  */
+
+static void test_arrays ()
+{
+  uint8_t             buffer[BUF_SIZE], packed[BUF_SIZE];
+  uint32_t            numbits, start, out[512], values[512], mask;
+  int32_t             i, count, ok;
+
+
+  for (numbits = 1 ; numbits <= 32 ; numbits++)
+    {
+      mask = numbits == 32 ? 0xffffffff : (1u << numbits) - 1;
+
+      for (start = 0 ; start < 16 ; start += 3)
+        {
+          count = 1 + rand () % 500;
+
+          for (i = 0 ; i < BUF_SIZE ; i++) buffer[i] = (uint8_t) (rand () & 0xff);
+          for (i = 0 ; i < count ; i++) values[i] = (uint32_t) rand () & mask;
+
+          bit_unpack_array (buffer, start, numbits, count, out);
+          for (i = 0, ok = NVTrue ; i < count ; i++) if (out[i] != bit_unpack (buffer, start + i * numbits, numbits)) ok = NVFalse;
+          check (ok, "bit_unpack_array", numbits, start);
+
+          memcpy (packed, buffer, BUF_SIZE);
+          bit_pack_array (packed, start, numbits, count, values);
+          for (i = 0 ; i < count ; i++) bit_pack (buffer, start + i * numbits, numbits, (int32_t) values[i]);
+          check (!memcmp (buffer, packed, BUF_SIZE), "bit_pack_array", numbits, start);
+        }
+    }
+}
+
+
+
+int32_t main (int32_t argc __attribute__ ((unused)), char **argv __attribute__ ((unused)))
+{
+  srand (1);
+
+  test_zero_bits ();
+  test_arrays ();
+
+  if (failures)
+    {
+      fprintf (stderr, "%d failures\n", failures);
+      return (-1);
+    }
+
+  printf ("test_bit_pack passed\n");
+
+  return (0);
+}